@@ -104,6 +104,7 @@ void yield(void);
 #define clockCyclesPerMicrosecond() ( F_CPU / 1000000L )
 #define clockCyclesToMicroseconds(a) ( (a) / clockCyclesPerMicrosecond() )
 #define microsecondsToClockCycles(a) ( (a) * clockCyclesPerMicrosecond() )
+#define ticksToMicroseconds(a) ( (a) / (clockCyclesPerMicrosecond() / 8) )
 
 #define lowByte(w) ((uint8_t) ((w) & 0xff))
 #define highByte(w) ((uint8_t) ((w) >> 8))
@@ -140,6 +141,11 @@ void analogWrite(uint8_t pin, int val);
 
 unsigned long millis(void);
 unsigned long micros(void);
+void creditTimer0Overflows(unsigned int count);
+void creditTimer0Ticks(unsigned char start, unsigned char pending, unsigned long streamTicks);
+void beginTicks(void);
+unsigned long ticks(void);
+unsigned long long ticks64(void);
 void delay(unsigned long ms);
 void delayMicroseconds(unsigned int us);
 unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout);
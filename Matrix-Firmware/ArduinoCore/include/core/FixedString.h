@@ -0,0 +1,111 @@
+/*
+  FixedString.h - strings in fixed, inline storage
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef FixedString_h
+#define FixedString_h
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "Print.h"
+
+// A StringView refers to characters owned by someone else (a literal, a
+// String, a FixedString, a buffer) without copying them. It stays valid
+// only as long as they do, and needn't be null terminated.
+class StringView
+{
+  private:
+    const char *_str;
+    size_t _len;
+  public:
+    StringView() : _str(""), _len(0) {}
+    StringView(const char *str) : _str(str ? str : ""), _len(str ? strlen(str) : 0) {}
+    StringView(const char *str, size_t len) : _str(str), _len(len) {}
+    StringView(const String &str) : _str(str.c_str()), _len(str.length()) {}
+
+    const char *data() const { return _str; }
+    size_t length() const { return _len; }
+    char operator [] (size_t index) const { return index < _len ? _str[index] : 0; }
+
+    bool equals(const StringView &other) const;
+    bool operator == (const StringView &other) const { return equals(other); }
+    bool operator != (const StringView &other) const { return !equals(other); }
+    bool startsWith(const StringView &prefix) const;
+    int indexOf(char c, size_t from = 0) const;
+    StringView substring(size_t begin, size_t end = (size_t)-1) const;
+};
+
+// A FixedString holds up to N characters in storage of its own, so it
+// never touches the heap and can't fragment it, unlike String. It is a
+// Print: numbers are formatted straight into it with print(), and text
+// that doesn't fit is cut off and flagged with getWriteError().
+class FixedStringBase : public Print
+{
+  private:
+    char *_buffer;
+    size_t _capacity;
+    size_t _len;
+  protected:
+    FixedStringBase(char *buffer, size_t capacity) : _buffer(buffer), _capacity(capacity), _len(0) { _buffer[0] = 0; }
+    // a copy would share the other string's storage
+    FixedStringBase(const FixedStringBase &) = delete;
+  public:
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write; // write(str), write(buf, len)
+    virtual int availableForWrite() { return _capacity - _len; }
+
+    const char *c_str() const { return _buffer; }
+    size_t length() const { return _len; }
+    size_t capacity() const { return _capacity; }
+    operator StringView() const { return StringView(_buffer, _len); }
+
+    void clear() { _len = 0; _buffer[0] = 0; clearWriteError(); }
+    FixedStringBase & operator = (const StringView &str);
+    FixedStringBase & operator = (const FixedStringBase &str) { return *this = StringView(str); }
+    FixedStringBase & operator = (const char *cstr) { return *this = StringView(cstr); }
+    FixedStringBase & operator = (const __FlashStringHelper *str);
+    // appends anything print() takes, e.g. s += F("bpm "); s += bpm;
+    template <typename T> FixedStringBase & operator += (T value) { print(value); return *this; }
+
+    bool equals(const StringView &other) const { return StringView(*this).equals(other); }
+    bool operator == (const StringView &other) const { return equals(other); }
+    bool operator != (const StringView &other) const { return !equals(other); }
+
+    friend class Stream;
+};
+
+template <size_t N>
+class FixedString : public FixedStringBase
+{
+  private:
+    char _storage[N + 1];
+  public:
+    FixedString() : FixedStringBase(_storage, N) {}
+    FixedString(const char *cstr) : FixedStringBase(_storage, N) { print(cstr); }
+    FixedString(const __FlashStringHelper *str) : FixedStringBase(_storage, N) { print(str); }
+    FixedString(const StringView &str) : FixedStringBase(_storage, N) { print(str); }
+    FixedString(const FixedString &str) : FixedStringBase(_storage, N) { print(StringView(str)); }
+    FixedString(const FixedStringBase &str) : FixedStringBase(_storage, N) { print(StringView(str)); }
+
+    using FixedStringBase::operator =;
+    FixedString & operator = (const FixedString &str) { FixedStringBase::operator = (StringView(str)); return *this; }
+};
+
+#endif
@@ -32,8 +32,9 @@
 // using a ring buffer (I think), in which head is the index of the location
 // to which to write the next incoming character and tail is the index of the
 // location from which to read.
-// NOTE: a "power of 2" buffer size is reccomended to dramatically
-//       optimize all the modulo operations for ring buffers.
+// Buffer sizes must be powers of 2, so indices wrap with a mask. Each port
+// can be given its own sizes (e.g. -DSERIAL0_RX_BUFFER_SIZE=256), the
+// others default to SERIAL_RX_BUFFER_SIZE / SERIAL_TX_BUFFER_SIZE.
 // WARNING: When buffer sizes are increased to > 256, the buffer index
 // variables are automatically increased in size, but the extra
 // atomicity guards needed for that are not implemented. This will
@@ -53,12 +54,38 @@
 #define SERIAL_RX_BUFFER_SIZE 64
 #endif
 #endif
-#if (SERIAL_TX_BUFFER_SIZE>256)
+#if !defined(SERIAL0_TX_BUFFER_SIZE)
+#define SERIAL0_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL0_RX_BUFFER_SIZE)
+#define SERIAL0_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_TX_BUFFER_SIZE)
+#define SERIAL1_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_RX_BUFFER_SIZE)
+#define SERIAL1_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_TX_BUFFER_SIZE)
+#define SERIAL2_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_RX_BUFFER_SIZE)
+#define SERIAL2_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_TX_BUFFER_SIZE)
+#define SERIAL3_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_RX_BUFFER_SIZE)
+#define SERIAL3_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if (SERIAL0_TX_BUFFER_SIZE>256) || (SERIAL1_TX_BUFFER_SIZE>256) || \
+    (SERIAL2_TX_BUFFER_SIZE>256) || (SERIAL3_TX_BUFFER_SIZE>256)
 typedef uint16_t tx_buffer_index_t;
 #else
 typedef uint8_t tx_buffer_index_t;
 #endif
-#if  (SERIAL_RX_BUFFER_SIZE>256)
+#if (SERIAL0_RX_BUFFER_SIZE>256) || (SERIAL1_RX_BUFFER_SIZE>256) || \
+    (SERIAL2_RX_BUFFER_SIZE>256) || (SERIAL3_RX_BUFFER_SIZE>256)
 typedef uint16_t rx_buffer_index_t;
 #else
 typedef uint8_t rx_buffer_index_t;
@@ -106,33 +133,46 @@ class HardwareSerial : public Stream
     volatile rx_buffer_index_t _rx_buffer_tail;
     volatile tx_buffer_index_t _tx_buffer_head;
     volatile tx_buffer_index_t _tx_buffer_tail;
+    // Called with each received byte instead of buffering it, if set
+    void (* volatile _rx_handler)(unsigned char);
 
-    // Don't put any members after these buffers, since only the first
-    // 32 bytes of this struct can be accessed quickly using the ldd
-    // instruction.
-    unsigned char _rx_buffer[SERIAL_RX_BUFFER_SIZE];
-    unsigned char _tx_buffer[SERIAL_TX_BUFFER_SIZE];
+    // Ring buffers, allocated per port with SERIALn_RX/TX_BUFFER_SIZE bytes,
+    // and their sizes - 1 to mask indices with
+    unsigned char * const _rx_buffer;
+    unsigned char * const _tx_buffer;
+    const rx_buffer_index_t _rx_mask;
+    const tx_buffer_index_t _tx_mask;
 
   public:
     inline HardwareSerial(
       volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
       volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
-      volatile uint8_t *ucsrc, volatile uint8_t *udr);
+      volatile uint8_t *ucsrc, volatile uint8_t *udr,
+      unsigned char *rx_buffer, rx_buffer_index_t rx_mask,
+      unsigned char *tx_buffer, tx_buffer_index_t tx_mask);
     void begin(unsigned long baud) { begin(baud, SERIAL_8N1); }
     void begin(unsigned long, uint8_t);
     void end();
     virtual int available(void);
     virtual int peek(void);
     virtual int read(void);
+    size_t read(uint8_t *buffer, size_t size);
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
     virtual int availableForWrite(void);
     virtual void flush(void);
     virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buffer, size_t size);
     inline size_t write(unsigned long n) { return write((uint8_t)n); }
     inline size_t write(long n) { return write((uint8_t)n); }
     inline size_t write(unsigned int n) { return write((uint8_t)n); }
     inline size_t write(int n) { return write((uint8_t)n); }
     using Print::write; // pull in write(str) and write(buf, size) from Print
     operator bool() { return true; }
+    // Hand received bytes to handler, straight from the RX interrupt,
+    // instead of buffering them for read(). Bytes still in the buffer are
+    // discarded. NULL goes back to buffering.
+    void attachRxHandler(void (*handler)(unsigned char));
 
     // Interrupt handlers - Not intended to be called externally
     inline void _rx_complete_irq(void);
@@ -87,12 +87,17 @@
 HardwareSerial::HardwareSerial(
   volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
   volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
-  volatile uint8_t *ucsrc, volatile uint8_t *udr) :
+  volatile uint8_t *ucsrc, volatile uint8_t *udr,
+  unsigned char *rx_buffer, rx_buffer_index_t rx_mask,
+  unsigned char *tx_buffer, tx_buffer_index_t tx_mask) :
     _ubrrh(ubrrh), _ubrrl(ubrrl),
     _ucsra(ucsra), _ucsrb(ucsrb), _ucsrc(ucsrc),
     _udr(udr),
     _rx_buffer_head(0), _rx_buffer_tail(0),
-    _tx_buffer_head(0), _tx_buffer_tail(0)
+    _tx_buffer_head(0), _tx_buffer_tail(0),
+    _rx_handler(NULL),
+    _rx_buffer(rx_buffer), _tx_buffer(tx_buffer),
+    _rx_mask(rx_mask), _tx_mask(tx_mask)
 {
 }
 
@@ -104,7 +109,12 @@ void HardwareSerial::_rx_complete_irq(void)
     // No Parity error, read byte and store it in the buffer if there is
     // room
     unsigned char c = *_udr;
-    rx_buffer_index_t i = (unsigned int)(_rx_buffer_head + 1) % SERIAL_RX_BUFFER_SIZE;
+    void (*handler)(unsigned char) = _rx_handler;
+    if (handler) {
+      handler(c);
+      return;
+    }
+    rx_buffer_index_t i = (_rx_buffer_head + 1) & _rx_mask;
 
     // if we should be storing the received character into the location
     // just before the tail (meaning that the head would advance to the
@@ -0,0 +1,47 @@
+/*
+  MemoryStats.h - heap and stack high-water marks
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef MemoryStats_h
+#define MemoryStats_h
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Heap use is counted by wrappers around malloc, calloc, realloc and free,
+// which also catch new and String. The sketch must link with
+//   -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+// or getMemoryStats() won't link. On AVR the RAM between the heap and
+// the stack is painted with STACK_PAINT at reset, so the deepest the
+// stack has ever been is whatever is no longer painted.
+#define STACK_PAINT 0xC5
+
+// all sizes in bytes; the counters wrap around
+typedef struct {
+  size_t heapUsed;   // in blocks allocated now, malloc's headers included
+  size_t heapPeak;   // most heapUsed has been
+  size_t stackPeak;  // deepest the stack has been, 0 where unknown
+  size_t untouched;  // RAM neither heap nor stack ever reached, 0 where unknown
+  uint16_t allocs;
+  uint16_t frees;
+  uint16_t failed;   // allocations that returned NULL
+} memoryStats_t;
+
+void getMemoryStats(memoryStats_t *stats);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+  NeoArena.h - fixed memory arena for library buffers
+
+  Instead of each strip, effect and sprite layer getting its memory from
+  the heap at run time, the application declares one statically sized
+  arena, so all of it shows up in the build's RAM usage and a layout that
+  doesn't fit fails to compile rather than failing at run time. Shared by
+  the NeoPixel, NeoMatrix, GFX and WS2812FX libraries.
+
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef NEOARENA_H
+#define NEOARENA_H
+
+#include "Arduino.h"
+
+#ifdef __AVR__
+#define NEO_ARENA_ALIGN 1 ///< Block alignment, AVR has no alignment needs
+#else
+#define NEO_ARENA_ALIGN __BIGGEST_ALIGNMENT__ ///< Block alignment
+#endif
+
+#ifndef NEO_RAM_BUDGET
+#if defined(RAMEND) && defined(RAMSTART)
+/// Most RAM that NEO_ARENA() may take, half the device's by default
+#define NEO_RAM_BUDGET ((RAMEND - RAMSTART + 1) / 2)
+#else
+#define NEO_RAM_BUDGET ((size_t)-1) ///< No limit where RAM size is unknown
+#endif
+#endif
+
+/*!
+  @brief   Declare an arena with size bytes of static storage, and fail the
+           build if that is more than NEO_RAM_BUDGET. It takes over from
+           its constructor on, so declare it before the strips, matrices
+           and effects in the same file that should allocate from it.
+  @param   name  Variable name.
+  @param   size  Bytes, the sum of the arenaSize() of everything using it.
+*/
+#define NEO_ARENA(name, size)                                                  \
+  static_assert((size) <= NEO_RAM_BUDGET,                                      \
+                "NeoArena " #name " is over NEO_RAM_BUDGET");                  \
+  NeoArenaBuffer<(size)> name
+
+/**
+ * @brief Stack-like allocator over a fixed buffer.
+ *
+ * Blocks are handed out from the bottom up. Freeing the topmost block
+ * gives its space back at once; a block below it is marked free and its
+ * space comes back as soon as every block above it is gone too. That
+ * suits these libraries, which allocate their buffers up front and only
+ * replace the odd one (a transition or blend layer) later.
+ *
+ * While an arena is current, neoAlloc() and neoFree() use it. It never
+ * falls back to the heap: when it is full, allocations fail just like a
+ * failed malloc(), which the libraries already handle.
+ */
+class NeoArena {
+
+public:
+  NeoArena(uint8_t *buffer, size_t size);
+  ~NeoArena();
+
+  void *alloc(size_t size);
+  void free(void *ptr);
+  bool owns(const void *ptr) const;
+  /*!
+    @brief   Size of the arena.
+    @return  Bytes.
+  */
+  size_t size(void) const { return end - buffer; }
+  /*!
+    @brief   Space taken now, including blocks waiting to be reclaimed.
+    @return  Bytes.
+  */
+  size_t used(void) const { return top - buffer; }
+  /*!
+    @brief   Most space ever taken, to tune the arena size with.
+    @return  Bytes.
+  */
+  size_t peak(void) const { return high - buffer; }
+
+  /*!
+    @brief   Space a block of a given size takes in an arena.
+    @param   bytes  Size requested from alloc().
+    @return  Bytes, including the block header and padding.
+  */
+  static constexpr size_t blockSize(size_t bytes) {
+    return bytes ? roundUp(sizeof(header_t)) + roundUp(bytes) : 0;
+  }
+
+  static NeoArena *current; ///< Arena neoAlloc() uses, NULL for the heap
+  friend void neoFree(void *ptr);
+
+private:
+  /// Precedes every block
+  typedef struct header {
+    struct header *prev; ///< Block below, NULL for the first
+    bool free;           ///< Freed, waiting for the blocks above to go
+  } header_t;
+
+  static constexpr size_t roundUp(size_t bytes) {
+    return (bytes + NEO_ARENA_ALIGN - 1) & ~(size_t)(NEO_ARENA_ALIGN - 1);
+  }
+
+  uint8_t *buffer;  ///< Start of the arena
+  uint8_t *end;     ///< End of the arena
+  uint8_t *top;     ///< Start of the free space
+  uint8_t *high;    ///< Highest top so far
+  header_t *last;   ///< Topmost block, NULL if empty
+  NeoArena *outer;  ///< Arena that was current before this one
+};
+
+/**
+ * @brief A NeoArena with its own storage, normally declared with
+ * NEO_ARENA().
+ */
+template <size_t SIZE> class NeoArenaBuffer : public NeoArena {
+public:
+  NeoArenaBuffer() : NeoArena(storage, SIZE) {}
+
+private:
+  uint8_t storage[SIZE] __attribute__((aligned(NEO_ARENA_ALIGN)));
+};
+
+void *neoAlloc(size_t size);
+void neoFree(void *ptr);
+
+#endif // NEOARENA_H
@@ -34,11 +34,14 @@
 #endif
 #define BIN 2
 
+class StringView;
+
 class Print
 {
   private:
     int write_error;
     size_t printNumber(unsigned long, uint8_t);
+    size_t printDecimal(unsigned long, uint8_t);
     size_t printFloat(double, uint8_t);
   protected:
     void setWriteError(int err = 1) { write_error = err; }
@@ -64,6 +67,7 @@ class Print
 
     size_t print(const __FlashStringHelper *);
     size_t print(const String &);
+    size_t print(const StringView &);
     size_t print(const char[]);
     size_t print(char);
     size_t print(unsigned char, int = DEC);
@@ -72,10 +76,12 @@ class Print
     size_t print(long, int = DEC);
     size_t print(unsigned long, int = DEC);
     size_t print(double, int = 2);
+    size_t printFixed(long, uint8_t, uint8_t = 2);
     size_t print(const Printable&);
 
     size_t println(const __FlashStringHelper *);
     size_t println(const String &s);
+    size_t println(const StringView &s);
     size_t println(const char[]);
     size_t println(char);
     size_t println(unsigned char, int = DEC);
@@ -25,6 +25,8 @@
 #include <inttypes.h>
 #include "Print.h"
 
+class FixedStringBase;
+
 // compatability macros for testing
 /*
 #define   getInt()            parseInt()
@@ -106,6 +108,10 @@ class Stream : public Print
   // Arduino String functions to be added here
   String readString();
   String readStringUntil(char terminator);
+  // as above into a FixedString, without the heap. stop once it's full and
+  // return the number of characters read
+  size_t readString(FixedStringBase &str);
+  size_t readStringUntil(char terminator, FixedStringBase &str);
 
   protected:
   long parseInt(char ignore) { return parseInt(SKIP_ALL, ignore); }
@@ -0,0 +1,51 @@
+/*
+  Telemetry.h - COBS framed binary packets over a Print
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <inttypes.h>
+
+#include "Print.h"
+
+// A packet is type, sequence number, payload and a CRC-8 (poly 0x07) over
+// all of them, COBS encoded and framed by 0 bytes. The receiver can
+// resync on any 0, and spot dropped packets by gaps in the sequence.
+#if !defined(TELEMETRY_MAX_PAYLOAD)
+#define TELEMETRY_MAX_PAYLOAD 32
+#endif
+#if TELEMETRY_MAX_PAYLOAD > 250
+#error "TELEMETRY_MAX_PAYLOAD must fit one COBS block (250 bytes at most)"
+#endif
+
+class Telemetry
+{
+  private:
+    Print &_out;
+    uint8_t _seq;
+    uint16_t _dropped;
+  public:
+    Telemetry(Print &out) : _out(out), _seq(0), _dropped(0) {}
+
+    // queues a whole packet or nothing, never waits for the output
+    bool send(uint8_t type, const void *data, uint8_t size);
+    uint16_t getDropped() { return _dropped; }
+};
+
+#endif
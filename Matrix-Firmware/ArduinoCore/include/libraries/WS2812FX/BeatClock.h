@@ -0,0 +1,92 @@
+/*
+  BeatClock.h - Tempo tracking clock for WS2812FX.
+
+  FEATURES
+    * Phase locks to detected beats (onsets) with an integer PI loop
+    * Tempo (BPM) estimate and a lock confidence
+    * update() divides once per beat, not per sample, and getPhase() adds
+      only a multiply and a shift, so both can run every sample
+
+  NOTES
+    * Feed it with beat() whenever an onset is detected, e.g. from a
+      sound-to-light input. Onsets that land near the predicted beat pull
+      the clock's phase and period towards them, onsets that don't lower
+      the confidence. An unlocked clock restarts from the onset spacing.
+    * Phase is in 1/256 beats, periods are in ms.
+
+  LICENSE
+
+  The MIT License (MIT)
+
+  Copyright (c) 2016  Harm Aldick
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+
+  CHANGELOG
+
+  2026-10-19   Initial version
+*/
+
+#ifndef BeatClock_h
+#define BeatClock_h
+
+#include <Arduino.h>
+
+#define BEAT_PERIOD_MIN     (uint16_t)250  /* ms, 240 BPM */
+#define BEAT_PERIOD_MAX     (uint16_t)1500 /* ms,  40 BPM */
+#define BEAT_PERIOD_DEFAULT (uint16_t)500  /* ms, 120 BPM */
+#define BEAT_LOCKED         (uint8_t)160   /* confidence needed to count as locked */
+
+class BeatClock {
+
+  public:
+    BeatClock(uint16_t period=BEAT_PERIOD_DEFAULT) {
+      reset(period);
+    };
+
+    void
+      reset(uint16_t period),
+      beat(unsigned long now),
+      update(unsigned long now);
+
+    bool
+      isLocked(void);
+
+    uint8_t
+      getPhase(unsigned long now),
+      getConfidence(void);
+
+    uint16_t
+      getPeriod(void),
+      getBPM(void),
+      getBeatCount(void);
+
+  private:
+    void _setPeriod(uint16_t period_q4);
+
+    unsigned long _beat_time;  // time of the last beat of the clock (phase 0)
+    unsigned long _last_onset; // time of the last beat() call
+    uint32_t _rate;            // phase units per ms, Q16 (saves the division in getPhase())
+    uint16_t _period_q4;       // beat period in 1/16 ms
+    uint16_t _interval;        // time between the last two onsets
+    uint16_t _beat_count;      // number of clock beats so far (wraps)
+    uint8_t  _confidence;      // 0 = free running, 255 = firmly locked
+};
+
+#endif
@@ -41,6 +41,7 @@
 #define MAX_MILLIS (0UL - 1UL) /* ULONG_MAX */
 
 #include <Adafruit_NeoMatrix.h>
+#include "BeatClock.h"
 
 #define DEFAULT_BRIGHTNESS (uint8_t)50
 #define DEFAULT_MODE       (uint8_t)0
@@ -57,6 +58,7 @@
   #define SPEED_MIN (uint16_t)10
 #endif
 #define SPEED_MAX (uint16_t)65535
+#define TRANSITION_FRAME_TIME (uint16_t)20 /* ms between crossfade frames (50 fps) */
 
 #define BRIGHTNESS_MIN (uint8_t)0
 #define BRIGHTNESS_MAX (uint8_t)255
@@ -91,7 +93,7 @@
 // bits 4-6: fade rate (0-7)
 // bit    3: gamma correction
 // bits 1-2: size
-// bits   0: TBD
+// bits   0: 2D segment (start/stop hold the packed x/y of two corners)
 #define NO_OPTIONS   (uint8_t)0b00000000
 #define REVERSE      (uint8_t)0b10000000
 #define IS_REVERSE   ((_seg->options & REVERSE) == REVERSE)
@@ -110,6 +112,24 @@
 #define SIZE_LARGE   (uint8_t)0b00000100
 #define SIZE_XLARGE  (uint8_t)0b00000110
 #define SIZE_OPTION  ((_seg->options >> 1) & 3)
+#define MATRIX_2D    (uint8_t)0b00000001
+#define IS_2D        ((_seg->options & MATRIX_2D) == MATRIX_2D)
+
+// 2D segments store their top-left and bottom-right corners in start/stop
+#define XY_PACK(x, y) (uint16_t)(((uint16_t)(y) << 8) | (uint8_t)(x))
+#define XY_X(p)       (uint8_t)((p) & 0xFF)
+#define XY_Y(p)       (uint8_t)((p) >> 8)
+
+// segment blend modes, i.e. how a segment is composited over the segments
+// that come before it in the active segments list. Anything other than
+// BLEND_OVERWRITE renders the segment into its own layer buffer, which costs
+// 2 x (segment length) x (bytes per pixel) of RAM. In palette mode every
+// segment is drawn as BLEND_OVERWRITE.
+#define BLEND_OVERWRITE (uint8_t)0 // plain overwrite, no layer buffer (default)
+#define BLEND_ADD       (uint8_t)1 // saturating add, e.g. a beat flash
+#define BLEND_MAX       (uint8_t)2 // lighten, per color channel
+#define BLEND_ALPHA     (uint8_t)3 // crossfade by the segment's alpha value
+#define BLEND_MULTIPLY  (uint8_t)4 // darken/mask, white leaves the backdrop unchanged
 
 // segment runtime options (aux_param2)
 #define FRAME           (uint8_t)0b10000000
@@ -126,13 +146,16 @@ class WS2812FX : public Adafruit_NeoMatrix {
     typedef uint16_t (WS2812FX::*mode_ptr)(void);
 
     // segment parameters
-    typedef struct Segment { // 20 bytes
+    typedef struct Segment { // 23 bytes
       uint16_t start;
       uint16_t stop;
       uint16_t speed;
       uint8_t  mode;
       uint8_t  options;
       uint32_t colors[MAX_NUM_COLORS];
+      uint8_t  blend_mode; // one of the BLEND_* values
+      uint8_t  alpha;      // layer opacity for BLEND_ALPHA
+      uint8_t  beats;      // beats per effect cycle when synced to the beat clock, 0 = use speed
     } segment;
 
     // segment runtime parameters
@@ -145,7 +168,23 @@ class WS2812FX : public Adafruit_NeoMatrix {
       uint16_t aux_param3;  // auxilary param (usually stores a segment index)
       uint8_t* extDataSrc = NULL; // external data array
       uint16_t extDataCnt = 0;    // number of elements in the external data array
+      uint8_t* layer = NULL;      // layer + backdrop buffers of a blended segment
+      uint16_t layer_start = 0;   // first pixel index covered by the layer
+      uint16_t layer_len = 0;     // number of pixels covered by the layer
     } segment_runtime;
+
+    // NEO_ARENA() space for the pixels and segment arrays. Blend layers and
+    // transitions each need NeoArena::blockSize() of 2 x (segment span)
+    // x (bytes per pixel) on top, if they're used.
+    static constexpr size_t arenaSize(uint16_t num_leds,
+      neoPixelType type=NEO_GRB + NEO_KHZ800,
+      uint8_t max_num_segments=MAX_NUM_SEGMENTS,
+      uint8_t max_num_active_segments=MAX_NUM_ACTIVE_SEGMENTS) {
+      return Adafruit_NeoPixel::arenaSize(num_leds, type) +
+        NeoArena::blockSize(max_num_segments * sizeof(segment)) +
+        NeoArena::blockSize(max_num_active_segments) +
+        NeoArena::blockSize(max_num_active_segments * sizeof(segment_runtime));
+    }
 	
 	// Simple stripe constructor
     WS2812FX(uint16_t num_leds, uint8_t pin, neoPixelType type,
@@ -160,9 +199,7 @@ class WS2812FX : public Adafruit_NeoMatrix {
       _active_segments_len = max_num_active_segments;
 
       // create all the segment arrays and init to zeros
-      _segments = new segment[_segments_len]();
-      _active_segments = new uint8_t[_active_segments_len]();
-      _segment_runtimes = new segment_runtime[_active_segments_len]();
+      _allocSegments();
 
       // init segment pointers
       _seg     = _segments;
@@ -185,9 +222,7 @@ class WS2812FX : public Adafruit_NeoMatrix {
 		  _active_segments_len = MAX_NUM_ACTIVE_SEGMENTS;
 
 		  // create all the segment arrays and init to zeros
-		  _segments = new segment[_segments_len]();
-		  _active_segments = new uint8_t[_active_segments_len]();
-		  _segment_runtimes = new segment_runtime[_active_segments_len]();
+		  _allocSegments();
 
 		  // init segment pointers
 		  _seg     = _segments;
@@ -211,9 +246,7 @@ class WS2812FX : public Adafruit_NeoMatrix {
 		  _active_segments_len = MAX_NUM_ACTIVE_SEGMENTS;
 
 		  // create all the segment arrays and init to zeros
-		  _segments = new segment[_segments_len]();
-		  _active_segments = new uint8_t[_active_segments_len]();
-		  _segment_runtimes = new segment_runtime[_active_segments_len]();
+		  _allocSegments();
 
 		  // init segment pointers
 		  _seg     = _segments;
@@ -236,6 +269,10 @@ class WS2812FX : public Adafruit_NeoMatrix {
       setMode(uint8_t m),
       setMode(uint8_t seg, uint8_t m),
       setOptions(uint8_t seg, uint8_t o),
+      setBlendMode(uint8_t seg, uint8_t b, uint8_t alpha=255),
+      setTransitionTime(uint16_t t),
+      setBeatClock(BeatClock* c),
+      setBeatSync(uint8_t seg, uint8_t beats),
       setCustomMode(uint16_t (*p)()),
       setCustomShow(void (*p)()),
       setSpeed(uint16_t s),
@@ -272,6 +309,9 @@ class WS2812FX : public Adafruit_NeoMatrix {
       setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, const uint32_t colors[], uint16_t speed, bool reverse),
       setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, const uint32_t colors[], uint16_t speed, uint8_t options),
 
+      setSegment2D(uint8_t n, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t mode, uint32_t color,          uint16_t speed, uint8_t options=NO_OPTIONS),
+      setSegment2D(uint8_t n, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t mode, const uint32_t colors[], uint16_t speed, uint8_t options=NO_OPTIONS),
+
       setIdleSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, uint32_t color,          uint16_t speed),
       setIdleSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, uint32_t color,          uint16_t speed, uint8_t options),
       setIdleSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, const uint32_t colors[], uint16_t speed, uint8_t options),
@@ -286,6 +326,7 @@ class WS2812FX : public Adafruit_NeoMatrix {
       setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b),
       setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w),
       setRawPixelColor(uint16_t n, uint32_t c),
+      setPixelColorXY(uint16_t x, uint16_t y, uint32_t c),
       copyPixels(uint16_t d, uint16_t s, uint16_t c),
       setPixels(uint16_t, uint8_t*),
       setRandomSeed(uint16_t),
@@ -300,7 +341,8 @@ class WS2812FX : public Adafruit_NeoMatrix {
       isFrame(uint8_t),
       isCycle(void),
       isCycle(uint8_t),
-      isActiveSegment(uint8_t seg);
+      isActiveSegment(uint8_t seg),
+      isTransitioning(void);
 
     uint8_t
       random8(void),
@@ -313,6 +355,8 @@ class WS2812FX : public Adafruit_NeoMatrix {
       getNumSegments(void),
       get_random_wheel_index(uint8_t),
       getOptions(uint8_t),
+      getBlendMode(uint8_t),
+      getBeatSync(uint8_t),
       getNumBytesPerPixel(void);
 
     uint16_t
@@ -320,6 +364,8 @@ class WS2812FX : public Adafruit_NeoMatrix {
       random16(uint16_t),
       getSpeed(void),
       getSpeed(uint8_t),
+      getTransitionTime(void),
+      getIndexXY(uint16_t x, uint16_t y),
       getLength(void),
       getNumBytes(void);
 
@@ -333,9 +379,12 @@ class WS2812FX : public Adafruit_NeoMatrix {
     uint32_t* intensitySums(void);
     uint8_t*  getActiveSegments(void);
     uint8_t*  blend(uint8_t*, uint8_t*, uint8_t*, uint16_t, uint8_t);
+    uint8_t*  composite(uint8_t*, uint8_t*, uint8_t*, uint16_t, uint8_t, uint8_t);
 
     const __FlashStringHelper* getModeName(uint8_t m);
 
+    BeatClock* getBeatClock(void);
+
     WS2812FX::Segment* getSegment(void);
 
     WS2812FX::Segment* getSegment(uint8_t);
@@ -365,6 +414,7 @@ class WS2812FX : public Adafruit_NeoMatrix {
 
     uint32_t
       color_blend(uint32_t, uint32_t, uint8_t),
+      heat_color(uint8_t),
       getRawPixelColor(uint16_t n);
 
     // builtin modes
@@ -441,6 +491,10 @@ class WS2812FX : public Adafruit_NeoMatrix {
       mode_flipbook(void),
       mode_popcorn(void),
       mode_oscillator(void),
+      mode_plasma(void),
+      mode_fire_2d(void),
+      mode_matrix_rain(void),
+      mode_ripple(void),
       mode_custom_0(void),
       mode_custom_1(void),
       mode_custom_2(void),
@@ -451,6 +505,23 @@ class WS2812FX : public Adafruit_NeoMatrix {
       mode_custom_7(void);
 
   private:
+    void
+      _allocSegments(void),
+      _selectSegment(uint8_t i),
+      _freeLayer(uint8_t i),
+      _swapSpan(uint8_t* buf, uint16_t first, uint16_t len),
+      _compositeLayers(bool restore),
+      _compositeRun(uint16_t first, uint16_t cnt, bool restore),
+      _forEachRun(void (WS2812FX::*run)(uint16_t, uint16_t, bool), bool restore),
+      _beginTransition(uint8_t seg),
+      _endTransition(void),
+      _crossfade(bool restore),
+      _crossfadeRun(uint16_t first, uint16_t cnt, bool restore);
+
+    bool _beginLayer(void);
+
+    uint16_t _segmentSpan(uint16_t* first);
+
     uint16_t _rand16seed;
     uint16_t (*customModes[MAX_CUSTOM_MODES])(void) {
       []{ return (uint16_t)1000; },
@@ -480,6 +551,22 @@ class WS2812FX : public Adafruit_NeoMatrix {
     segment_runtime* _seg_rt;           // currently active segment runtime (16 bytes)
 
     uint16_t _seg_len;                  // num LEDs in the currently active segment
+    uint16_t _seg_w;                    // width of the currently active segment (_seg_len for 1D)
+    uint8_t  _seg_h;                    // height of the currently active segment (1 for 1D)
+
+    segment_runtime _trans_rt;          // runtime of the outgoing mode during a transition
+    uint8_t* _trans_buf = NULL;         // pixels of the outgoing mode + saved incoming pixels
+    uint16_t _trans_start = 0;          // first pixel index covered by _trans_buf
+    uint16_t _trans_len = 0;            // number of pixels covered by _trans_buf
+    uint16_t _trans_time = 0;           // crossfade time in ms, 0 = switch modes instantly
+    unsigned long _trans_begin = 0;     // millis() at the start of the transition
+    unsigned long _trans_next_show = 0; // time of the next crossfade frame
+    uint8_t _trans_seg = 0;             // segment that is transitioning
+    uint8_t _trans_mode = 0;            // outgoing mode
+    uint8_t _trans_amt = 0;             // mix of the current frame (0 = outgoing, 255 = incoming)
+
+    BeatClock* _beat_clock = NULL;      // tempo source for beat synced segments
+    uint16_t _beat_count = 0;           // beat count of _beat_clock at the last service()
 };
 
 class WS2812FXT {
@@ -532,7 +619,12 @@ class WS2812FXT {
         memmove(dest_p, vstop_p, numBytes);
       } else {
         uint8_t blendAmt = map(now, transitionStartTime, transitionStartTime + transitionDuration, 0, 255);
-        dest->blend(dest_p, vstart_p, vstop_p, numBytes, blendAmt);
+        if(dest->getPaletteSize()) {
+          // palette indices can't be mixed, cut over halfway instead
+          memmove(dest_p, blendAmt < 128 ? vstart_p : vstop_p, numBytes);
+        } else {
+          dest->blend(dest_p, vstart_p, vstop_p, numBytes, blendAmt);
+        }
       }
 
       dest->Adafruit_NeoMatrix::show();
@@ -95,7 +95,7 @@
 #define FX_MODE_TWINKLEFOX              55
 #define FX_MODE_RAIN                    56
 #define FX_MODE_CUSTOM                  57  // keep this for backward compatiblity
-#define FX_MODE_CUSTOM_0                57  // custom modes need to go at the end
+#define FX_MODE_CUSTOM_0                57  // custom modes keep their numbers, new modes go after them
 #define FX_MODE_CUSTOM_1                58
 #define FX_MODE_CUSTOM_2                59
 #define FX_MODE_CUSTOM_3                60
@@ -103,6 +103,15 @@
 #define FX_MODE_CUSTOM_5                62
 #define FX_MODE_CUSTOM_6                63
 #define FX_MODE_CUSTOM_7                64
+#define FX_MODE_PLASMA                  65
+#define FX_MODE_FIRE_2D                 66
+#define FX_MODE_MATRIX_RAIN             67
+#define FX_MODE_RIPPLE                  68
+
+// modes that address pixels through getIndexXY() and so can run on MATRIX_2D
+// segments; custom modes are trusted to do the same
+#define IS_2D_MODE(m) (((m) >= FX_MODE_PLASMA && (m) <= FX_MODE_RIPPLE) || \
+                       ((m) >= FX_MODE_CUSTOM_0 && (m) <= FX_MODE_CUSTOM_7))
 
 // create GLOBAL names to allow WS2812FX to compile with sketches and other libs
 // that store strings in PROGMEM (get rid of the "section type conflict with __c"
@@ -164,7 +173,7 @@ const char name_53[] PROGMEM = "Bicolor Chase";
 const char name_54[] PROGMEM = "Tricolor Chase";
 const char name_55[] PROGMEM = "TwinkleFOX";
 const char name_56[] PROGMEM = "Rain";
-const char name_57[] PROGMEM = "Custom 0"; // custom modes need to go at the end
+const char name_57[] PROGMEM = "Custom 0"; // custom modes keep their numbers, new modes go after them
 const char name_58[] PROGMEM = "Custom 1";
 const char name_59[] PROGMEM = "Custom 2";
 const char name_60[] PROGMEM = "Custom 3";
@@ -172,6 +181,10 @@ const char name_61[] PROGMEM = "Custom 4";
 const char name_62[] PROGMEM = "Custom 5";
 const char name_63[] PROGMEM = "Custom 6";
 const char name_64[] PROGMEM = "Custom 7";
+const char name_65[] PROGMEM = "Plasma";
+const char name_66[] PROGMEM = "Fire 2D";
+const char name_67[] PROGMEM = "Matrix Rain";
+const char name_68[] PROGMEM = "Ripple";
 
 static const __FlashStringHelper* _names[] = {
   FSH(name_0),
@@ -238,7 +251,11 @@ static const __FlashStringHelper* _names[] = {
   FSH(name_61),
   FSH(name_62),
   FSH(name_63),
-  FSH(name_64)
+  FSH(name_64),
+  FSH(name_65),
+  FSH(name_66),
+  FSH(name_67),
+  FSH(name_68)
 };
 
 // define static array of member function pointers.
@@ -308,6 +325,10 @@ __attribute__ ((unused)) static WS2812FX::mode_ptr _modes[] = {
   &WS2812FX::mode_custom_4,
   &WS2812FX::mode_custom_5,
   &WS2812FX::mode_custom_6,
-  &WS2812FX::mode_custom_7
+  &WS2812FX::mode_custom_7,
+  &WS2812FX::mode_plasma,
+  &WS2812FX::mode_fire_2d,
+  &WS2812FX::mode_matrix_rain,
+  &WS2812FX::mode_ripple
 };
 #endif
@@ -110,7 +110,7 @@
 #define FX_MODE_POPCORN                 70
 #define FX_MODE_OSCILLATOR              71
 #define FX_MODE_CUSTOM                  72  // keep this for backward compatiblity
-#define FX_MODE_CUSTOM_0                72  // custom modes need to go at the end
+#define FX_MODE_CUSTOM_0                72  // custom modes keep their numbers, new modes go after them
 #define FX_MODE_CUSTOM_1                73
 #define FX_MODE_CUSTOM_2                74
 #define FX_MODE_CUSTOM_3                75
@@ -118,6 +118,15 @@
 #define FX_MODE_CUSTOM_5                77
 #define FX_MODE_CUSTOM_6                78
 #define FX_MODE_CUSTOM_7                79
+#define FX_MODE_PLASMA                  80
+#define FX_MODE_FIRE_2D                 81
+#define FX_MODE_MATRIX_RAIN             82
+#define FX_MODE_RIPPLE                  83
+
+// modes that address pixels through getIndexXY() and so can run on MATRIX_2D
+// segments; custom modes are trusted to do the same
+#define IS_2D_MODE(m) (((m) >= FX_MODE_PLASMA && (m) <= FX_MODE_RIPPLE) || \
+                       ((m) >= FX_MODE_CUSTOM_0 && (m) <= FX_MODE_CUSTOM_7))
 
 typedef struct Mode {
   const __FlashStringHelper* name;
@@ -130,6 +139,7 @@ const char cat_simple[]  PROGMEM = "Simple";
 const char cat_wipe[]    PROGMEM = "Wipe";
 const char cat_sweep[]   PROGMEM = "Sweep";
 const char cat_special[] PROGMEM = "Special";
+const char cat_matrix[]  PROGMEM = "Matrix";
 const char cat_custom[]  PROGMEM = "Custom";
 
 // create GLOBAL names to allow WS2812FX to compile with sketches and other libs
@@ -207,7 +217,7 @@ const char name_68[] PROGMEM = "Multi Comet";
 const char name_69[] PROGMEM = "Flipbook";
 const char name_70[] PROGMEM = "Popcorn";
 const char name_71[] PROGMEM = "Oscillator";
-const char name_72[] PROGMEM = "Custom 0"; // custom modes need to go at the end
+const char name_72[] PROGMEM = "Custom 0"; // custom modes keep their numbers, new modes go after them
 const char name_73[] PROGMEM = "Custom 1";
 const char name_74[] PROGMEM = "Custom 2";
 const char name_75[] PROGMEM = "Custom 3";
@@ -215,6 +225,10 @@ const char name_76[] PROGMEM = "Custom 4";
 const char name_77[] PROGMEM = "Custom 5";
 const char name_78[] PROGMEM = "Custom 6";
 const char name_79[] PROGMEM = "Custom 7";
+const char name_80[] PROGMEM = "Plasma";
+const char name_81[] PROGMEM = "Fire 2D";
+const char name_82[] PROGMEM = "Matrix Rain";
+const char name_83[] PROGMEM = "Ripple";
 
 // define static array of member function pointers.
 // make sure the order of the _modes array elements matches the FX_MODE_* values
@@ -298,6 +312,10 @@ __attribute__ ((unused)) static mode _modes[] = {
   { FSH(name_76), FSH(cat_custom),  &WS2812FX::mode_custom_4 },
   { FSH(name_77), FSH(cat_custom),  &WS2812FX::mode_custom_5 },
   { FSH(name_78), FSH(cat_custom),  &WS2812FX::mode_custom_6 },
-  { FSH(name_79), FSH(cat_custom),  &WS2812FX::mode_custom_7 }
+  { FSH(name_79), FSH(cat_custom),  &WS2812FX::mode_custom_7 },
+  { FSH(name_80), FSH(cat_matrix),  &WS2812FX::mode_plasma },
+  { FSH(name_81), FSH(cat_matrix),  &WS2812FX::mode_fire_2d },
+  { FSH(name_82), FSH(cat_matrix),  &WS2812FX::mode_matrix_rain },
+  { FSH(name_83), FSH(cat_matrix),  &WS2812FX::mode_ripple }
 };
 #endif
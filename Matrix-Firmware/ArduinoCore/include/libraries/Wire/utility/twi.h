@@ -39,6 +39,32 @@
   #define TWI_MTX   2
   #define TWI_SRX   3
   #define TWI_STX   4
+
+  // status of a queued transaction, then one of twi_writeTo()'s results
+  #define TWI_PENDING 0xFF
+
+  // TWI_HAS_QUEUE means transactions can be queued with twi_queue()
+  #define TWI_HAS_QUEUE 1
+
+  // A master transaction for twi_queue(): txLength bytes are written, then,
+  // after a repeated start, rxLength bytes are read, then the bus is
+  // stopped. Either part may be empty; with both empty it only checks that
+  // the device acks. The transaction and its buffers belong to the queue
+  // until status is no longer TWI_PENDING, and aren't limited to
+  // TWI_BUFFER_LENGTH.
+  typedef struct twi_transaction_s twi_transaction_t;
+  struct twi_transaction_s {
+    uint8_t address;                         // 7bit device address
+    const uint8_t* txData;
+    uint8_t txLength;
+    uint8_t* rxData;
+    uint8_t rxLength;
+    void (*onComplete)(twi_transaction_t*);  // called from the TWI interrupt, may be NULL
+    void* context;                           // for onComplete
+    volatile uint8_t status;
+    twi_transaction_t* next;                 // used by the queue
+  };
+
   
   void twi_init(void);
   void twi_disable(void);
@@ -55,5 +81,7 @@
   void twi_setTimeoutInMicros(uint32_t, bool);
   void twi_handleTimeout(bool);
   bool twi_manageTimeoutFlag(bool);
+  uint8_t twi_queue(twi_transaction_t*);
+  void twi_pollQueue(void);
 
 #endif
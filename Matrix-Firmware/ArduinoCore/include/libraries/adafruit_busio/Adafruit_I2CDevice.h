@@ -4,6 +4,18 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+#if defined(ARDUINO_ARCH_AVR)
+extern "C" {
+#include <utility/twi.h>
+}
+#endif
+
+#ifdef TWI_HAS_QUEUE
+/// A transfer queued with Adafruit_I2CDevice::queue(). It and its buffers
+/// belong to the bus until it is no longer busy(); start it out zeroed.
+typedef twi_transaction_t Adafruit_I2CTransaction;
+#endif
+
 ///< The class which defines how we will talk to this device over I2C
 class Adafruit_I2CDevice {
 public:
@@ -21,6 +33,29 @@ public:
                        bool stop = false);
   bool setSpeed(uint32_t desiredclk);
 
+#ifdef TWI_HAS_QUEUE
+  bool queue(Adafruit_I2CTransaction *transaction, const uint8_t *write_buffer,
+             size_t write_len, uint8_t *read_buffer = nullptr,
+             size_t read_len = 0,
+             void (*callback)(Adafruit_I2CTransaction *) = nullptr,
+             void *context = nullptr);
+  /*!   @brief  Check whether a queued transfer is still under way
+   *    @param  transaction The transfer
+   *    @return True until it has completed or failed */
+  static bool busy(const Adafruit_I2CTransaction *transaction) {
+    return transaction->status == TWI_PENDING;
+  }
+  /*!   @brief  Check how a queued transfer went
+   *    @param  transaction The transfer, no longer busy()
+   *    @return True if every byte was acked and transferred */
+  static bool succeeded(const Adafruit_I2CTransaction *transaction) {
+    return transaction->status == 0;
+  }
+  /*!   @brief  Start transfers that waited for blocking ones and time out
+   *    stuck ones, call from loop() while any are queued */
+  static void poll(void) { twi_pollQueue(); }
+#endif
+
   /*!   @brief  How many bytes we can read in a transaction
    *    @return The size of the Wire receive/transmit buffer */
   size_t maxBufferSize() { return _maxBufferSize; }
@@ -8,10 +8,29 @@
 #include "WProgram.h"
 #endif
 #include "gfxfont.h"
+#include <NeoArena.h>
 
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_SPIDevice.h>
 
+#ifndef GFX_GLYPH_CACHE_ROWS
+#define GFX_GLYPH_CACHE_ROWS 8 ///< Tallest glyph whose bitmap gets cached
+#endif
+
+/// A custom font glyph decoded into RAM by the optional glyph cache
+typedef struct {
+  uint16_t stamp;        ///< Time of last use, for LRU replacement
+  uint16_t bitmapOffset; ///< Pointer into GFXfont->bitmap
+  uint8_t c;             ///< Character
+  uint8_t width;         ///< Bitmap dimensions in pixels
+  uint8_t height;        ///< Bitmap dimensions in pixels
+  uint8_t xAdvance;      ///< Distance to advance cursor (x axis)
+  int8_t xOffset;        ///< X dist from cursor pos to UL corner
+  int8_t yOffset;        ///< Y dist from cursor pos to UL corner
+  bool hasRows;          ///< Set if rows holds the bitmap (w <= 16, h fits)
+  uint16_t rows[GFX_GLYPH_CACHE_ROWS]; ///< Bitmap rows, MSB = leftmost pixel
+} GFXcachedGlyph;
+
 /// A generic graphics superclass that can handle all sorts of drawing. At a
 /// minimum you can subclass and provide drawPixel(). At a maximum you can do a
 /// ton of overriding to optimize. Used for any/all Adafruit displays!
@@ -19,6 +38,7 @@ class Adafruit_GFX : public Print {
 
 public:
   Adafruit_GFX(int16_t w, int16_t h); // Constructor
+  ~Adafruit_GFX(void);
 
   /**********************************************************************/
   /*!
@@ -36,6 +56,8 @@ public:
   // optimized code.  Otherwise 'generic' versions are used.
   virtual void startWrite(void);
   virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+  virtual void writePixelBlend(int16_t x, int16_t y, uint16_t color,
+                               uint8_t alpha);
   virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
                              uint16_t color);
   virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -73,6 +95,12 @@ public:
   void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
   void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
                         int16_t delta, uint16_t color);
+  void drawPixelQ8(int16_t x, int16_t y, uint16_t color);
+  void drawPixelQ8(int16_t x, int16_t y, uint16_t color, int16_t cx,
+                   int16_t cy, int16_t cw, int16_t ch);
+  void drawLineQ8(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  uint16_t color);
+  void fillRectQ8(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
                     int16_t y2, uint16_t color);
   void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
@@ -120,6 +148,17 @@ public:
   void setTextSize(uint8_t s);
   void setTextSize(uint8_t sx, uint8_t sy);
   void setFont(const GFXfont *f = NULL);
+  bool setGlyphCache(uint8_t slots);
+  /**********************************************************************/
+  /*!
+    @brief    Space setGlyphCache() takes in a NEO_ARENA()
+    @param    slots  Number of cached glyphs
+    @returns  Bytes
+  */
+  /**********************************************************************/
+  static constexpr size_t glyphCacheArenaSize(uint8_t slots) {
+    return NeoArena::blockSize(slots * sizeof(GFXcachedGlyph));
+  }
 
   /**********************************************************************/
   /*!
@@ -232,6 +271,14 @@ public:
 protected:
   void charBounds(unsigned char c, int16_t *x, int16_t *y, int16_t *minx,
                   int16_t *miny, int16_t *maxx, int16_t *maxy);
+  const GFXcachedGlyph *fetchGlyph(uint8_t c, GFXcachedGlyph *tmp);
+  void writeAAGlyph(int16_t x, int16_t y, const GFXcachedGlyph *glyph,
+                    uint16_t color, uint8_t size_x, uint8_t size_y);
+  void writeRLEGlyph(int16_t x, int16_t y, const GFXcachedGlyph *glyph,
+                     uint16_t color, uint8_t size_x, uint8_t size_y);
+  void writeGlyphSpan(int16_t x, int16_t y, int16_t xx, int16_t yy,
+                      uint8_t len, uint16_t color, uint8_t size_x,
+                      uint8_t size_y);
   int16_t WIDTH;        ///< This is the 'raw' display width - never changes
   int16_t HEIGHT;       ///< This is the 'raw' display height - never changes
   int16_t _width;       ///< Display width as modified by current rotation
@@ -246,6 +293,11 @@ protected:
   bool wrap;            ///< If set, 'wrap' text at right edge of display
   bool _cp437;          ///< If set, use correct CP437 charset (default is off)
   GFXfont *gfxFont;     ///< Pointer to special font
+  GFXcachedGlyph *glyphCache; ///< Decoded glyphs, NULL if cache is off
+  uint8_t glyphCacheSlots;    ///< Number of entries in glyphCache
+  uint8_t glyphCacheUsed;     ///< Entries holding a glyph (filled in order)
+  uint8_t glyphCacheLast;     ///< Entry of the most recent lookup
+  uint16_t glyphCacheClock;   ///< Bumped on every lookup, stamps entries
 };
 
 /// A simple drawn button UI element
@@ -311,6 +363,17 @@ class GFXcanvas1 : public Adafruit_GFX {
 public:
   GFXcanvas1(uint16_t w, uint16_t h);
   ~GFXcanvas1(void);
+  /**********************************************************************/
+  /*!
+    @brief    Space the canvas takes in a NEO_ARENA()
+    @param    w   Canvas width, in pixels
+    @param    h   Canvas height, in pixels
+    @returns  Bytes
+  */
+  /**********************************************************************/
+  static constexpr size_t arenaSize(uint16_t w, uint16_t h) {
+    return NeoArena::blockSize(((w + 7) / 8) * h);
+  }
   void drawPixel(int16_t x, int16_t y, uint16_t color);
   void fillScreen(uint16_t color);
   void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -343,6 +406,17 @@ class GFXcanvas8 : public Adafruit_GFX {
 public:
   GFXcanvas8(uint16_t w, uint16_t h);
   ~GFXcanvas8(void);
+  /**********************************************************************/
+  /*!
+    @brief    Space the canvas takes in a NEO_ARENA()
+    @param    w   Canvas width, in pixels
+    @param    h   Canvas height, in pixels
+    @returns  Bytes
+  */
+  /**********************************************************************/
+  static constexpr size_t arenaSize(uint16_t w, uint16_t h) {
+    return NeoArena::blockSize((size_t)w * h);
+  }
   void drawPixel(int16_t x, int16_t y, uint16_t color);
   void fillScreen(uint16_t color);
   void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -370,6 +444,17 @@ class GFXcanvas16 : public Adafruit_GFX {
 public:
   GFXcanvas16(uint16_t w, uint16_t h);
   ~GFXcanvas16(void);
+  /**********************************************************************/
+  /*!
+    @brief    Space the canvas takes in a NEO_ARENA()
+    @param    w   Canvas width, in pixels
+    @param    h   Canvas height, in pixels
+    @returns  Bytes
+  */
+  /**********************************************************************/
+  static constexpr size_t arenaSize(uint16_t w, uint16_t h) {
+    return NeoArena::blockSize((size_t)w * h * 2);
+  }
   void drawPixel(int16_t x, int16_t y, uint16_t color);
   void fillScreen(uint16_t color);
   void byteSwap(void);
@@ -393,4 +478,58 @@ private:
   uint16_t *buffer;
 };
 
+/// A GFX 24-bit canvas context for graphics, laid out like a NeoPixel strip
+class GFXcanvas24 : public Adafruit_GFX {
+public:
+  GFXcanvas24(uint16_t w, uint16_t h, uint8_t order = 0x06);
+  ~GFXcanvas24(void);
+  /**********************************************************************/
+  /*!
+    @brief    Space the canvas takes in a NEO_ARENA()
+    @param    w   Canvas width, in pixels
+    @param    h   Canvas height, in pixels
+    @returns  Bytes
+  */
+  /**********************************************************************/
+  static constexpr size_t arenaSize(uint16_t w, uint16_t h) {
+    return NeoArena::blockSize((size_t)w * h * 3);
+  }
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void fillScreen(uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawPixelRGB(int16_t x, int16_t y, uint32_t color);
+  void fillRectRGB(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
+  void fillScreenRGB(uint32_t color);
+  uint32_t getPixelRGB(int16_t x, int16_t y) const;
+  void setColorExpander(uint32_t (*fn)(uint16_t));
+  /**********************************************************************/
+  /*!
+    @brief    Get a pointer to the internal buffer memory, 3 bytes per
+              pixel in getOrder() order, rows of WIDTH pixels unrotated
+    @returns  A pointer to the allocated buffer
+  */
+  /**********************************************************************/
+  uint8_t *getBuffer(void) const { return buffer; }
+  /**********************************************************************/
+  /*!
+    @brief    Get the byte order of the pixels in the buffer
+    @returns  Color order as in NeoPixel type flags, e.g. NEO_GRB
+  */
+  /**********************************************************************/
+  uint8_t getOrder(void) const { return order; }
+
+protected:
+  uint32_t expand(uint16_t color) const;
+  void fillRawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                   uint32_t color);
+
+private:
+  uint8_t *buffer;
+  uint8_t order;                    ///< NeoPixel-style color order
+  uint8_t rOffset, gOffset, bOffset; ///< Byte of each color in a pixel
+  uint32_t (*expander)(uint16_t);   ///< 565 to 888 conversion, or NULL
+};
+
 #endif // _ADAFRUIT_GFX_H
@@ -24,6 +24,25 @@ typedef struct {
   uint16_t first;   ///< ASCII extents (first char)
   uint16_t last;    ///< ASCII extents (last char)
   uint8_t yAdvance; ///< Newline distance (y axis)
+  uint8_t flags;    ///< Bitmap encoding, GFX_FONT_* (0 = packed 1 bit/pixel)
 } GFXfont;
 
+// GFXfont->flags. Fonts that leave the field out get 0, the classic format.
+#define GFX_FONT_RLE 0x01  ///< Glyph bitmaps are run-length encoded, see below
+#define GFX_FONT_2BPP 0x02 ///< Anti-aliased, 2 bits of coverage per pixel
+#define GFX_FONT_4BPP 0x04 ///< Anti-aliased, 4 bits of coverage per pixel
+#define GFX_FONT_AA 0x06   ///< Mask for the anti-aliased formats
+
+// Run-length encoded glyphs (fontconvert -r) store the bitmap, in the usual
+// left-to-right, top-to-bottom pixel order, as alternating runs of unset
+// and set pixels, starting with an unset run. Each run is a 4-bit value,
+// high nibble first; 15 means "15 more, keep reading" so longer runs take
+// several nibbles. Set runs are stored as length - 1. An unset run of 0
+// anywhere but at the start ends the glyph early (all remaining pixels
+// unset), otherwise decoding stops after width * height pixels.
+
+// Anti-aliased glyphs (fontconvert -a 2 or -a 4) are packed like classic
+// ones, just with 2 or 4 bits per pixel: coverage from 0 (unset) to 3 or 15
+// (fully set), high bits first. Not combined with GFX_FONT_RLE.
+
 #endif // _GFXFONT_H_
@@ -41,6 +41,7 @@
 #endif
 #include <Adafruit_GFX.h>
 #include <Adafruit_NeoPixel.h>
+#include "neosprite.h"
 
 // Matrix layout information is passed in the 'matrixType' parameter for
 // each constructor (the parameter immediately following is the LED type
@@ -118,6 +119,7 @@ public:
                      neoPixelType ledType = NEO_GRB + NEO_KHZ800);
 
   virtual ~Adafruit_NeoMatrix() {
+    freeIndexMap();
   } // Virtual destructor to allow better memory management
 
   /**
@@ -127,12 +129,181 @@ public:
    * @param  color  Pixel color in 16-bit '565' RGB format.
    */
   void drawPixel(int16_t x, int16_t y, uint16_t color);
+  /**
+   * @brief  Blend a color over the pixel already in the NeoPixel buffer,
+   *         used by Adafruit_GFX for anti-aliased fonts. The blend is done
+   *         on the buffer's 8-bit channels (after gamma and brightness),
+   *         so it costs little more than drawPixel(). With a palette
+   *         (setPaletteMode()) pixels can't be mixed and are drawn when at
+   *         least half covered instead.
+   * @param  x      Pixel column (0 = left edge, unless rotation used).
+   * @param  y      Pixel row (0 = top edge, unless rotation used).
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   * @param  alpha  Opacity of color, 0 (none) to 255 (opaque).
+   */
+  void writePixelBlend(int16_t x, int16_t y, uint16_t color, uint8_t alpha);
+  /**
+   * @brief  Start a batch of GFX writes. Until the matching endWrite(),
+   *         writePixel() and the write/draw line and rect functions store
+   *         straight into the NeoPixel buffer: the color is converted
+   *         (gamma, brightness, palette) once and reused while it stays
+   *         the same, instead of once per pixel through drawPixel() and
+   *         setPixelColor(). Calls may nest. Don't change brightness,
+   *         palette or pass-through color inside a batch.
+   */
+  void startWrite(void);
+  /**
+   * @brief  End a batch of GFX writes started with startWrite().
+   */
+  void endWrite(void);
+  /**
+   * @brief  Pixel-writing function for Adafruit_GFX, fast within a
+   *         startWrite()/endWrite() batch, same as drawPixel() outside.
+   * @param  x      Pixel column (0 = left edge, unless rotation used).
+   * @param  y      Pixel row (0 = top edge, unless rotation used).
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void writePixel(int16_t x, int16_t y, uint16_t color);
+  /**
+   * @brief  Write a horizontal line, clipped to the matrix.
+   * @param  x      Left end column.
+   * @param  y      Row.
+   * @param  w      Length in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  /**
+   * @brief  Write a vertical line, clipped to the matrix.
+   * @param  x      Column.
+   * @param  y      Top end row.
+   * @param  h      Length in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  /**
+   * @brief  Write a filled rectangle, clipped to the matrix.
+   * @param  x      Left column.
+   * @param  y      Top row.
+   * @param  w      Width in pixels.
+   * @param  h      Height in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                     uint16_t color);
+  /**
+   * @brief  Draw a horizontal line, as one batch of writes.
+   * @param  x      Left end column.
+   * @param  y      Row.
+   * @param  w      Length in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  /**
+   * @brief  Draw a vertical line, as one batch of writes.
+   * @param  x      Column.
+   * @param  y      Top end row.
+   * @param  h      Length in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  /**
+   * @brief  Draw a filled rectangle, as one batch of writes.
+   * @param  x      Left column.
+   * @param  y      Top row.
+   * @param  w      Width in pixels.
+   * @param  h      Height in pixels.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                 uint16_t color);
+  /**
+   * @brief  Draw an anti-aliased line (Xiaolin Wu's algorithm), blended
+   *         into what's already in the buffer. Costs two blended pixels
+   *         per step; in palette mode it degrades to a plain line.
+   * @param  x0     Start point x coordinate.
+   * @param  y0     Start point y coordinate.
+   * @param  x1     End point x coordinate.
+   * @param  y1     End point y coordinate.
+   * @param  color  16-bit '565' RGB color.
+   */
+  void drawLineAA(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  uint16_t color);
+  /**
+   * @brief  Blit a sprite straight into the NeoPixel buffer.
+   * @param  x       Left edge column.
+   * @param  y       Top edge row.
+   * @param  sprite  Sprite in PROGMEM.
+   * @param  color   Draw color for SPRITE_MASK sprites, in 16-bit '565'
+   *                 RGB format; ignored by other formats.
+   */
+  void drawSprite(int16_t x, int16_t y, const NeoSprite *sprite,
+                  uint16_t color = 0);
+  /**
+   * @brief  Blit the part of a sprite that falls within a clip rectangle.
+   * @param  x       Left edge column.
+   * @param  y       Top edge row.
+   * @param  sprite  Sprite in PROGMEM.
+   * @param  color   Draw color for SPRITE_MASK sprites.
+   * @param  cx      Clip rectangle left column.
+   * @param  cy      Clip rectangle top row.
+   * @param  cw      Clip rectangle width.
+   * @param  ch      Clip rectangle height.
+   */
+  void drawSprite(int16_t x, int16_t y, const NeoSprite *sprite,
+                  uint16_t color, int16_t cx, int16_t cy, int16_t cw,
+                  int16_t ch);
+
+  /**
+   * @brief  Copy a canvas into the NeoPixel buffer. When the canvas has
+   *         the matrix's size and rotation and sits at 0,0 this is one
+   *         pass over the buffer through the index map, copying bytes
+   *         as-is if the color order matches and brightness is off.
+   * @param  canvas  Canvas to copy, pixels taken verbatim (no gamma).
+   * @param  x       Column of the canvas' left edge.
+   * @param  y       Row of the canvas' top edge.
+   */
+  void drawCanvas(const GFXcanvas24 &canvas, int16_t x = 0, int16_t y = 0);
 
   /**
    * @brief  Fill matrix with a single color.
    * @param  color  Pixel color in 16-bit '565' RGB format.
    */
   void fillScreen(uint16_t color);
+  /**
+   * @brief  Incremental redraw: fill the bounding rectangle of everything
+   *         drawn since the previous call, instead of the whole screen.
+   *         Call at the start of a frame in place of fillScreen(). The
+   *         rectangle is kept in screen coordinates, so don't change the
+   *         rotation in between.
+   * @param  color  Background color, in 16-bit '565' RGB format.
+   */
+  void eraseDamage(uint16_t color = 0);
+  /**
+   * @brief  Get the bounding rectangle of everything drawn since the
+   *         previous eraseDamage() or clearDamage().
+   * @param  x  Returns the left edge column.
+   * @param  y  Returns the top edge row.
+   * @param  w  Returns the width, 0 if nothing was drawn.
+   * @param  h  Returns the height, 0 if nothing was drawn.
+   */
+  void getDamage(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const;
+  /**
+   * @brief  Forget what was drawn, e.g. after show()ing a frame that
+   *         should stay up.
+   */
+  void clearDamage(void);
+  /**
+   * @brief  Get the number of pixels written to the buffer since the
+   *         previous resetPixelsWritten(), for profiling. Sprites count
+   *         their whole clipped rectangle.
+   * @return Pixel count, saturating at 65535.
+   */
+  uint16_t getPixelsWritten(void) const { return pixelsWritten; }
+  /**
+   * @brief  Restart the pixel count, typically after every show().
+   */
+  void resetPixelsWritten(void) { pixelsWritten = 0; }
 
   /**
    * @brief  Pass-through is a kludge that lets you override the current
@@ -164,6 +335,48 @@ public:
    */
   void setRemapFunction(uint16_t (*fn)(uint16_t, uint16_t));
 
+  /**
+   * @brief   Map unrotated X/Y coordinates to an absolute pixel index,
+   *          using the NEO_MATRIX_* / NEO_TILE_* layout or the remap
+   *          function. No bounds checking is performed.
+   * @param   x         Pixel column (0 to WIDTH-1).
+   * @param   y         Pixel row (0 to HEIGHT-1).
+   * @return  uint16_t  Pixel index within the NeoPixel strip.
+   */
+  uint16_t pixelIndex(uint16_t x, uint16_t y);
+
+  /**
+   * @brief   Precompute the pixel index of every X/Y position into a
+   *          lookup table (2 bytes per pixel), so drawPixel() and 2D
+   *          effects skip the layout math. Call again after changing the
+   *          layout; setRemapFunction() does this automatically.
+   * @return  true on success, false if the table could not be allocated
+   *          (drawing then falls back to computing each index).
+   */
+  bool buildIndexMap(void);
+
+  /**
+   * @brief   Space buildIndexMap() takes in a NEO_ARENA().
+   * @param   w  Matrix width in pixels.
+   * @param   h  Matrix height in pixels.
+   * @return  Bytes.
+   */
+  static constexpr size_t indexMapArenaSize(uint16_t w, uint16_t h) {
+    return NeoArena::blockSize((size_t)w * h * sizeof(uint16_t));
+  }
+
+  /**
+   * @brief  Release the lookup table allocated by buildIndexMap().
+   */
+  void freeIndexMap(void);
+
+  /**
+   * @brief   Get the lookup table built by buildIndexMap(), stored row by
+   *          row (index of X/Y at [y * WIDTH + x]).
+   * @return  Pointer to the table, or NULL if none was built.
+   */
+  const uint16_t *getIndexMap(void) const { return indexMap; }
+
   /**
    * @brief   Quantize a 24-bit RGB color value to 16-bit '565' format.
    * @param   r         Red component (0 to 255).
@@ -172,6 +385,48 @@ public:
    * @return  uint16_t  Quantized color for GFX drawing functions.
    */
   static uint16_t Color(uint8_t r, uint8_t g, uint8_t b);
+  /**
+   * @brief  Widen a 16-bit '565' color the way drawPixel() does,
+   *         gamma correction included.
+   * @param  color  16-bit '565' RGB color.
+   * @return 24-bit 0xRRGGBB color.
+   */
+  static uint32_t expandColor(uint16_t color);
+
+protected:
+  /**
+   * @brief   Map rotated X/Y coordinates (as passed to drawPixel()) to
+   *          an absolute pixel index.
+   * @param   x         Pixel column (0 = left edge, unless rotation used).
+   * @param   y         Pixel row (0 = top edge, unless rotation used).
+   * @return  uint16_t  Pixel index, or 0xFFFF if X/Y is off the matrix
+   *          or maps past the end of the strip.
+   */
+  uint16_t screenIndex(int16_t x, int16_t y);
+  /**
+   * @brief  Convert a GFX color to the bytes stored in the NeoPixel buffer,
+   *         unless it is the color converted last in this write batch.
+   * @param  color  Pixel color in 16-bit '565' RGB format.
+   */
+  void prepareWrite(uint16_t color);
+  void touch(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t n = 0);
+  int16_t mapOffset(int16_t x, int16_t y, int16_t *dX, int16_t *dY);
+  void blendPixel(uint16_t n, uint8_t alpha);
+  void storeRGB(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+  /**
+   * @brief  Store the color from prepareWrite() at a pixel index.
+   * @param  n  Pixel index from screenIndex() or the index map; 0xFFFF
+   *            is skipped.
+   */
+  inline void putPixel(uint16_t n) {
+    if (n == 0xFFFF)
+      return;
+    uint8_t *p = &pixels[n * writeBytes];
+    for (uint8_t i = 0; i < writeBytes; i++)
+      p[i] = writeValue[i];
+  }
+
+  uint16_t *indexMap = NULL; ///< X/Y to pixel index lookup (or NULL)
 
 private:
   const uint8_t type;
@@ -180,6 +435,15 @@ private:
 
   uint32_t passThruColor;
   boolean passThruFlag = false;
+
+  uint8_t writeDepth = 0;  // startWrite() nesting, 0 = not in a batch
+  uint8_t writeBytes = 0;  // Bytes per pixel in the buffer, 0 = not converted
+  uint16_t writeColor;     // Color converted to writeValue
+  uint8_t writeValue[4];   // writeColor as stored in the buffer
+
+  int16_t damageX0 = 0x7FFF, damageY0 = 0x7FFF; // Drawn since eraseDamage(),
+  int16_t damageX1 = 0, damageY1 = 0;           // X1/Y1 exclusive
+  uint16_t pixelsWritten = 0; // Since resetPixelsWritten()
 };
 
 #endif // _ADAFRUIT_NEOMATRIX_H_
@@ -0,0 +1,99 @@
+/*!
+ * @file NeoMatrixSprites.h
+ *
+ * Sprite layer for Adafruit_NeoMatrix. Keeps a small z-ordered scene of
+ * sprites, filled rectangles and sub-pixel points over a plain background
+ * and, on each update, repaints only the rectangles that items have moved
+ * out of and into, so the rest of the matrix keeps its pixels from the
+ * previous frame.
+ *
+ * This file is part of the Adafruit NeoMatrix library.
+ *
+ * NeoMatrix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * NeoMatrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoMatrix.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _NEOMATRIXSPRITES_H_
+#define _NEOMATRIXSPRITES_H_
+
+#include <Adafruit_NeoMatrix.h>
+
+/**
+ * @brief Class that draws a retained scene of sprites and rectangles on an
+ * Adafruit_NeoMatrix, redrawing only what changed since the previous
+ * update().
+ */
+class NeoMatrixSprites {
+
+public:
+  /**
+   * @brief NeoMatrixSprites constructor.
+   * @param matrix      Matrix to draw on. The layer owns the whole matrix:
+   *                    anything else drawn on it is only cleared where a
+   *                    sprite passes by.
+   * @param count       Number of sprite slots. Slot 0 is drawn first, so
+   *                    higher slots end up on top.
+   * @param background  Color behind the sprites, in 16-bit '565' RGB format.
+   */
+  NeoMatrixSprites(Adafruit_NeoMatrix &matrix, uint8_t count,
+                   uint16_t background = 0);
+  ~NeoMatrixSprites();
+
+  /**
+   * @brief Space begin() takes in a NEO_ARENA().
+   * @param count  Number of sprite slots.
+   * @return Bytes.
+   */
+  static constexpr size_t arenaSize(uint8_t count) {
+    return NeoArena::blockSize(count * sizeof(entry_t));
+  }
+
+  bool begin(void);
+  void set(uint8_t i, const NeoSprite *sprite, int16_t x = 0, int16_t y = 0);
+  void setRect(uint8_t i, int16_t x, int16_t y, uint8_t w, uint8_t h,
+               uint16_t color);
+  void setPoint(uint8_t i, int16_t x, int16_t y, uint16_t color);
+  void moveTo(uint8_t i, int16_t x, int16_t y);
+  void setColor(uint8_t i, uint16_t color);
+  void show(uint8_t i, bool visible);
+  void setBackground(uint16_t color);
+  void invalidate(void);
+  bool update(void);
+
+private:
+  /// One slot, a sprite, a filled rectangle or a point
+  typedef struct {
+    const NeoSprite *sprite; ///< Image (PROGMEM), NULL for a rectangle
+    int16_t x, y;            ///< Position to draw at on the next update
+    uint8_t w, h;            ///< Size, 0 if the slot is unused
+    int16_t drawnX, drawnY;  ///< Position it was last drawn at
+    uint8_t drawnW, drawnH;  ///< Size it was last drawn at, 0 if not drawn
+    uint16_t color;          ///< Rectangle, point or SPRITE_MASK color
+    bool point;              ///< Point at x + fx / 256, y + fy / 256
+    uint8_t fx, fy;          ///< Fractional part of a point's position
+    bool visible;            ///< Draw on the next update
+    bool dirty;              ///< Changed since the last update
+  } entry_t;
+
+  void repaint(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  Adafruit_NeoMatrix &matrix;
+  entry_t *entries;    ///< count slots, allocated by begin()
+  uint8_t count;       ///< Number of slots
+  uint16_t background; ///< Background color
+  bool full;           ///< Repaint the whole matrix on the next update
+};
+
+#endif // _NEOMATRIXSPRITES_H_
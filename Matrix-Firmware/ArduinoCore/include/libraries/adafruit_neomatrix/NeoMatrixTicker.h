@@ -0,0 +1,107 @@
+/*!
+ * @file NeoMatrixTicker.h
+ *
+ * Scrolling text ticker for Adafruit_GFX displays, made for NeoPixel
+ * matrices. Text is rasterized into a small ring buffer of pixel columns
+ * as it scrolls in, so each glyph column is decoded from PROGMEM exactly
+ * once, and scrolls at sub-pixel speeds by blending neighbouring columns.
+ *
+ * This file is part of the Adafruit NeoMatrix library.
+ *
+ * NeoMatrix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * NeoMatrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoMatrix.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _NEOMATRIXTICKER_H_
+#define _NEOMATRIXTICKER_H_
+
+#if ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+#include <Adafruit_GFX.h>
+#include <NeoArena.h>
+
+#define TICKER_MAX_ROWS 16 ///< Tallest text band a ticker can draw
+
+/**
+ * @brief Class for scrolling a string of text across part of a GFX display
+ * in a custom (GFXfont) font.
+ */
+class NeoMatrixTicker {
+
+public:
+  /**
+   * @brief NeoMatrixTicker constructor.
+   * @param gfx   Display to draw on, e.g. an Adafruit_NeoMatrix.
+   * @param font  Custom font to render the text in. Must use the classic
+   *              packed 1 bit per pixel format; begin() fails for RLE
+   *              and anti-aliased fonts.
+   */
+  NeoMatrixTicker(Adafruit_GFX &gfx, const GFXfont *font);
+  ~NeoMatrixTicker();
+
+  /**
+   * @brief Space begin() takes in a NEO_ARENA().
+   * @param w  Width of the ticker window.
+   * @return Bytes.
+   */
+  static constexpr size_t arenaSize(uint8_t w) {
+    return NeoArena::blockSize((w + 2) * sizeof(uint16_t));
+  }
+
+  bool begin(int16_t x, int16_t baseline, uint8_t w);
+  void setText(const char *text);
+  void setText(const __FlashStringHelper *text);
+  void setColor(uint32_t color);
+  void setSpeed(uint16_t speed);
+  void setLoop(bool loop);
+  void restart(void);
+  bool update(unsigned long now);
+  void draw(void);
+  bool isDone(void) const;
+
+private:
+  uint16_t column(uint16_t t);
+  uint16_t rasterize(void);
+  uint8_t readChar(uint16_t i) const;
+  GFXglyph *glyphFor(uint8_t c) const;
+
+  Adafruit_GFX &gfx;
+  const GFXfont *font;
+  const char *text;     ///< Text being shown (not copied)
+  bool textInFlash;     ///< true if text points to PROGMEM
+  bool loop;            ///< Start over once the text has scrolled out
+  uint16_t textLen;     ///< Number of characters in text
+  uint16_t textCols;    ///< Width of the rendered text in columns
+  int16_t x;            ///< Left edge of the ticker window
+  int16_t baseline;     ///< Text baseline
+  int16_t top;          ///< Top row of the text band
+  uint8_t w;            ///< Width of the ticker window
+  uint8_t h;            ///< Height of the text band (max TICKER_MAX_ROWS)
+  uint16_t *ring;       ///< Rasterized columns, bit k = row top + k
+  uint8_t ringLen;      ///< Number of columns in ring (w + 2)
+  uint16_t nextCol;     ///< Next text column to rasterize
+  uint16_t nextChar;    ///< Character the next column belongs to
+  uint8_t glyphCol;     ///< Column of the next column within its character
+  uint8_t r, g, b;      ///< Text color
+  uint16_t speed;       ///< Scroll speed in pixels per second
+  uint16_t frac;        ///< Sub-step remainder of the scroll position
+  uint32_t pos;         ///< Scroll position in 1/256 pixels
+  unsigned long last;   ///< Time of the previous update()
+};
+
+#endif // _NEOMATRIXTICKER_H_
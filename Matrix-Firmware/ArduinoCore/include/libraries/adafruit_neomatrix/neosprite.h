@@ -0,0 +1,35 @@
+// Sprite structures for Adafruit_NeoMatrix::drawSprite() and
+// NeoMatrixSprites. Like GFXfont, a NeoSprite and the data it points to
+// normally live in PROGMEM.
+
+#ifndef _NEOSPRITE_H_
+#define _NEOSPRITE_H_
+
+// NeoSprite->flags: one pixel format...
+#define SPRITE_RGB565 0x00  ///< 16-bit '565' colors (uint16_t per pixel)
+#define SPRITE_INDEXED 0x01 ///< 8-bit indices into a '565' palette
+#define SPRITE_MASK 0x02    ///< 1 bit per pixel, set pixels in the draw color
+#define SPRITE_FORMAT 0x03  ///< Mask for the pixel format
+// ...plus any of these
+#define SPRITE_RLE 0x10   ///< Pixel data is run-length encoded, see below
+#define SPRITE_KEYED 0x20 ///< Pixels equal to key are transparent
+
+/// Sprite image, all data row by row from the top left corner
+typedef struct {
+  const uint8_t *data;     ///< Pixel data
+  const uint16_t *palette; ///< '565' colors for SPRITE_INDEXED, else NULL
+  uint8_t width;           ///< Width in pixels
+  uint8_t height;          ///< Height in pixels
+  uint8_t flags;           ///< Format, SPRITE_* values
+  uint16_t key;            ///< Transparent color (or index) with SPRITE_KEYED
+} NeoSprite;
+
+// SPRITE_MASK rows start on a byte boundary, MSB = leftmost pixel, like
+// Adafruit_GFX::drawBitmap(). Clear pixels are always transparent.
+//
+// SPRITE_RLE (RGB565 and INDEXED only) data is a series of packets, each a
+// control byte c followed by pixels: c < 128 means c + 1 literal pixels,
+// c >= 128 one pixel repeated (c & 127) + 1 times. Packets may run over
+// row ends. Pixels take 1 byte (INDEXED) or 2 (RGB565, low byte first).
+
+#endif // _NEOSPRITE_H_
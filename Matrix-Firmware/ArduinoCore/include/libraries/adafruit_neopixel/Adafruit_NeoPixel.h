@@ -61,6 +61,8 @@
 #include "rp2040_pio.h"
 #endif
 
+#include <NeoArena.h>
+
 // The order of primary colors in the NeoPixel data stream can vary among
 // device types, manufacturers and even different revisions of the same
 // item.  The third parameter to the Adafruit_NeoPixel constructor encodes
@@ -232,6 +234,16 @@ public:
   void clear(void);
   void updateLength(uint16_t n);
   void updateType(neoPixelType t);
+  bool setPaletteMode(uint16_t size);
+  void setPaletteColor(uint8_t i, uint32_t c);
+  uint32_t getPaletteColor(uint8_t i) const;
+  void setPixelIndex(uint16_t n, uint8_t i);
+  uint8_t getPixelIndex(uint16_t n) const;
+  /*!
+    @brief   Return the number of palette entries.
+    @return  Palette size, 0 if the strip is not in palette mode.
+  */
+  uint16_t getPaletteSize(void) const { return paletteSize; }
   /*!
     @brief   Check whether a call to show() will start sending data
              immediately or will 'block' for a required interval. NeoPixels
@@ -337,6 +349,17 @@ public:
   static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
     return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
   }
+  /*!
+    @brief   Arena space the pixel buffer of a strip takes, for sizing a
+             NEO_ARENA() at compile time.
+    @param   n  Number of pixels.
+    @param   t  Pixel type, as passed to the constructor.
+    @return  Bytes.
+  */
+  static constexpr size_t arenaSize(uint16_t n,
+                                    neoPixelType t = NEO_GRB + NEO_KHZ800) {
+    return NeoArena::blockSize(n * ((((t >> 6) & 3) == ((t >> 4) & 3)) ? 3 : 4));
+  }
   /*!
     @brief   Convert separate red, green, blue and white values into a
              single "packed" 32-bit WRGB color.
@@ -378,6 +401,10 @@ private:
 #endif
 
 protected:
+  friend class NeoPixelReceiver; // Streams frames right into pixels
+  uint32_t unpackColor(const uint8_t *p) const;
+  uint8_t closestPaletteIndex(uint8_t r, uint8_t g, uint8_t b, uint8_t w) const;
+
 #ifdef NEO_KHZ400 // If 400 KHz NeoPixel support enabled...
   bool is800KHz; ///< true if 800 KHz pixels
 #endif
@@ -387,6 +414,9 @@ protected:
   int16_t pin;        ///< Output pin number (-1 if not yet set)
   uint8_t brightness; ///< Strip brightness 0-255 (stored as +1)
   uint8_t *pixels;    ///< Holds LED color values (3 or 4 bytes each)
+                      ///< or palette indices (1 byte each)
+  uint8_t *palette;   ///< Palette colors (3 or 4 bytes each), NULL if unused
+  uint16_t paletteSize; ///< Number of palette entries
   uint8_t rOffset;    ///< Red index within each 3- or 4-byte pixel
   uint8_t gOffset;    ///< Index of green byte
   uint8_t bOffset;    ///< Index of blue byte
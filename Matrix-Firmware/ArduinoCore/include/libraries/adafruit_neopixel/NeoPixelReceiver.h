@@ -0,0 +1,132 @@
+/*!
+ * @file NeoPixelReceiver.h
+ *
+ * Receives frames streamed from a PC over a hardware serial port, in the
+ * Adalight or TPM2 format, and shows them on an Adafruit_NeoPixel strip.
+ * Bytes are parsed in the serial RX interrupt and land directly in the
+ * strip's pixel buffer, so a full frame costs no buffering and no read()
+ * calls.
+ *
+ * This file is part of the Adafruit_NeoPixel library.
+ *
+ * Adafruit_NeoPixel is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Adafruit_NeoPixel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoPixel.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEOPIXELRECEIVER_H
+#define NEOPIXELRECEIVER_H
+
+#include <Adafruit_NeoPixel.h>
+#include <HardwareSerial.h>
+
+#define NEO_RX_ACK 0xAC   ///< Sent once a frame is shown, as in TPM2
+#define NEO_RX_TIMEOUT 50 ///< ms without data before a frame is dropped
+#define NEO_RX_HOLD 1000  ///< ms without a frame before the strip is let go
+
+/**
+ * @brief Class that shows frames streamed over a HardwareSerial port on a
+ * NeoPixel strip.
+ *
+ * Two framings are understood, both carrying 8-bit RGB pixels in strip
+ * order:
+ *   - Adalight: 'A' 'd' 'a', (pixels - 1) high and low byte, then the
+ *     header checksum high ^ low ^ 0x55, then the pixels.
+ *   - TPM2: 0xC9 0xDA, data length high and low byte, the pixels, 0x36.
+ *
+ * The strip's pixel buffer is shared with the sketch, so the receiver
+ * only writes to it while it holds the strip. The first frame of a stream
+ * is parsed and acknowledged but its pixels are dropped; the next update()
+ * takes the strip, and from then on isStreaming() is true and the sketch
+ * must neither draw on the strip nor show() it. The strip is let go once
+ * no frame has arrived for NEO_RX_HOLD ms.
+ *
+ * While a frame is being shown the interrupts are off and incoming bytes
+ * would be lost, so for full rate streaming the sender should wait for
+ * the NEO_RX_ACK byte that follows each frame before sending the next.
+ * Senders that don't, like classic Adalight, still work as long as they
+ * leave a gap for show() between frames; a frame that runs into one is
+ * dropped. For the same reason the sketch must not show() the strip while
+ * isReceiving() is true. Nothing keeps a stream from starting while the
+ * sketch is in show(), though: then the first header is lost and with it
+ * the first frame, or a TPM2 one is garbled and dropped, and a sender
+ * waiting for its ACK has to give up on it and send the next. Pixels
+ * beyond the strip length are ignored, pixels a short frame leaves out
+ * keep their color.
+ */
+class NeoPixelReceiver {
+
+public:
+  /**
+   * @brief NeoPixelReceiver constructor.
+   * @param strip   Strip to show frames on. Must not be in palette mode.
+   * @param serial  Port the frames arrive on.
+   */
+  NeoPixelReceiver(Adafruit_NeoPixel &strip, HardwareSerial &serial);
+
+  bool begin(unsigned long baud);
+  void end(void);
+  bool update(void);
+  /**
+   * @brief  Check whether the receiver holds the strip. While it does, the
+   *         sketch must not draw on the strip or show() it.
+   * @return true from the update() after a stream starts until NEO_RX_HOLD
+   *         ms after its last frame.
+   */
+  bool isStreaming(void) const { return holding; }
+  bool isReceiving(void) const;
+  /**
+   * @brief  Number of frames shown since begin().
+   * @return Frame count (wraps).
+   */
+  uint16_t getFrameCount(void) const { return frames; }
+  /**
+   * @brief  Number of frames dropped for a bad checksum, a bad end byte or
+   *         a timeout.
+   * @return Error count (wraps).
+   */
+  uint16_t getErrorCount(void) const { return errors; }
+
+private:
+  static void rxHandler(unsigned char c);
+  void receive(uint8_t c);
+  void sync(uint8_t c);
+
+  static NeoPixelReceiver *active; ///< Instance fed by rxHandler()
+
+  Adafruit_NeoPixel &strip;
+  HardwareSerial &serial;
+  volatile uint8_t state;  ///< Parser state, RX_* in the .cpp
+  volatile bool holding;   ///< Strip is ours, the sketch keeps off it
+  volatile bool wanted;    ///< A header arrived while not holding
+  bool writing;            ///< Frame in progress goes to the strip
+  bool tpm2;               ///< Frame in progress is TPM2 (else Adalight)
+  uint8_t lenHi;           ///< First length byte of the header
+  uint8_t lenLo;           ///< Second length byte of the header
+  uint16_t length;         ///< Data bytes in the frame
+  uint16_t count;          ///< Data bytes received so far
+  uint16_t limit;          ///< Data bytes that fit on the strip
+  uint8_t *dst;            ///< Pixel the next data byte goes to
+  uint8_t channel;         ///< Color of the next data byte, 0-2 (R, G, B)
+  uint8_t bytesPerPixel;   ///< 3 or 4 (RGBW, white is turned off)
+  uint8_t offset[4];       ///< Buffer offsets of red, green, blue, white
+  uint16_t scale;          ///< Brightness multiplier, 1-256
+  uint16_t frames;         ///< Frames shown
+  volatile uint16_t errors; ///< Frames dropped
+  unsigned long lastFrame; ///< Time the last frame was complete
+  uint16_t lastCount;      ///< count as of the last update()
+  unsigned long lastByte;  ///< Time count last changed
+};
+
+#endif // NEOPIXELRECEIVER_H
@@ -0,0 +1,99 @@
+/*
+  FixedString.cpp - strings in fixed, inline storage
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+
+#include "FixedString.h"
+
+// StringView //////////////////////////////////////////////////////////////////
+
+bool StringView::equals(const StringView &other) const
+{
+  return (_len == other._len) && !memcmp(_str, other._str, _len);
+}
+
+bool StringView::startsWith(const StringView &prefix) const
+{
+  return (prefix._len <= _len) && !memcmp(_str, prefix._str, prefix._len);
+}
+
+// returns the index of the first c at or after from, or -1
+int StringView::indexOf(char c, size_t from) const
+{
+  if (from >= _len) return -1;
+  const char *found = (const char *)memchr(_str + from, c, _len - from);
+  return found ? found - _str : -1;
+}
+
+// returns characters begin up to (not including) end, clipped to the view
+StringView StringView::substring(size_t begin, size_t end) const
+{
+  if (end > _len) end = _len;
+  if (begin > end) begin = end;
+  return StringView(_str + begin, end - begin);
+}
+
+// FixedStringBase /////////////////////////////////////////////////////////////
+
+size_t FixedStringBase::write(uint8_t c)
+{
+  if (_len >= _capacity) {
+    setWriteError();
+    return 0;
+  }
+  _buffer[_len++] = c;
+  _buffer[_len] = 0;
+  return 1;
+}
+
+size_t FixedStringBase::write(const uint8_t *buffer, size_t size)
+{
+  if (size > _capacity - _len) {
+    size = _capacity - _len;
+    setWriteError();
+  }
+  memmove(_buffer + _len, buffer, size); // may be a view of this string
+  _len += size;
+  _buffer[_len] = 0;
+  return size;
+}
+
+// the source may be (part of) this string, so it isn't cleared first
+FixedStringBase & FixedStringBase::operator = (const StringView &str)
+{
+  _len = 0;
+  clearWriteError();
+  write(str.data(), str.length());
+  return *this;
+}
+
+FixedStringBase & FixedStringBase::operator = (const __FlashStringHelper *str)
+{
+  PGM_P p = reinterpret_cast<PGM_P>(str);
+  size_t len = strnlen_P(p, _capacity + 1);
+  clear();
+  if (len > _capacity) {
+    len = _capacity;
+    setWriteError();
+  }
+  memcpy_P(_buffer, p, len);
+  _len = len;
+  _buffer[_len] = 0;
+  return *this;
+}
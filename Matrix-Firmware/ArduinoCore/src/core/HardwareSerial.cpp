@@ -77,12 +77,19 @@ void serialEventRun(void)
 #endif
 }
 
-// macro to guard critical sections when needed for large TX buffer sizes
-#if (SERIAL_TX_BUFFER_SIZE>256)
+// macros to guard critical sections when needed for large buffer sizes
+#if (SERIAL0_TX_BUFFER_SIZE>256) || (SERIAL1_TX_BUFFER_SIZE>256) || \
+    (SERIAL2_TX_BUFFER_SIZE>256) || (SERIAL3_TX_BUFFER_SIZE>256)
 #define TX_BUFFER_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 #else
 #define TX_BUFFER_ATOMIC
 #endif
+#if (SERIAL0_RX_BUFFER_SIZE>256) || (SERIAL1_RX_BUFFER_SIZE>256) || \
+    (SERIAL2_RX_BUFFER_SIZE>256) || (SERIAL3_RX_BUFFER_SIZE>256)
+#define RX_BUFFER_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define RX_BUFFER_ATOMIC
+#endif
 
 // Actual interrupt handlers //////////////////////////////////////////////////////////////
 
@@ -91,7 +98,7 @@ void HardwareSerial::_tx_udr_empty_irq(void)
   // If interrupts are enabled, there must be more data in the output
   // buffer. Send the next byte
   unsigned char c = _tx_buffer[_tx_buffer_tail];
-  _tx_buffer_tail = (_tx_buffer_tail + 1) % SERIAL_TX_BUFFER_SIZE;
+  _tx_buffer_tail = (_tx_buffer_tail + 1) & _tx_mask;
 
   *_udr = c;
 
@@ -163,9 +170,25 @@ void HardwareSerial::end()
   _rx_buffer_head = _rx_buffer_tail;
 }
 
+void HardwareSerial::attachRxHandler(void (*handler)(unsigned char))
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _rx_handler = handler;
+    // bytes buffered so far were meant for read(), not for the handler,
+    // and nobody reads them once it takes over, so they are discarded
+    if (handler)
+      _rx_buffer_head = _rx_buffer_tail;
+  }
+}
+
 int HardwareSerial::available(void)
 {
-  return ((unsigned int)(SERIAL_RX_BUFFER_SIZE + _rx_buffer_head - _rx_buffer_tail)) % SERIAL_RX_BUFFER_SIZE;
+  rx_buffer_index_t head;
+
+  RX_BUFFER_ATOMIC {
+    head = _rx_buffer_head;
+  }
+  return (rx_buffer_index_t)(head - _rx_buffer_tail) & _rx_mask;
 }
 
 int HardwareSerial::peek(void)
@@ -184,11 +207,55 @@ int HardwareSerial::read(void)
     return -1;
   } else {
     unsigned char c = _rx_buffer[_rx_buffer_tail];
-    _rx_buffer_tail = (rx_buffer_index_t)(_rx_buffer_tail + 1) % SERIAL_RX_BUFFER_SIZE;
+    _rx_buffer_tail = (rx_buffer_index_t)(_rx_buffer_tail + 1) & _rx_mask;
     return c;
   }
 }
 
+// Copy out whatever has been received, up to size bytes, without waiting:
+// at most two memcpy()s (the ring may wrap once) and one tail update
+size_t HardwareSerial::read(uint8_t *buffer, size_t size)
+{
+  rx_buffer_index_t head, tail = _rx_buffer_tail;
+  size_t n = 0;
+
+  RX_BUFFER_ATOMIC {
+    head = _rx_buffer_head;
+  }
+  while (n < size && head != tail) {
+    // bytes up to the head, or up to the end of the ring if it wraps
+    size_t chunk = (head > tail ? head : _rx_mask + 1) - tail;
+    if (chunk > size - n)
+      chunk = size - n;
+    memcpy(buffer + n, &_rx_buffer[tail], chunk);
+    n += chunk;
+    tail = (tail + chunk) & _rx_mask;
+  }
+  RX_BUFFER_ATOMIC {
+    _rx_buffer_tail = tail;
+  }
+  return n;
+}
+
+// Same as Stream::readBytes(), waiting up to the timeout for each byte,
+// but taking whatever has arrived in bulk
+size_t HardwareSerial::readBytes(char *buffer, size_t length)
+{
+  size_t n = 0;
+  unsigned long start = millis();
+
+  while (n < length) {
+    size_t got = read((uint8_t *)buffer + n, length - n);
+    if (got) {
+      n += got;
+      start = millis();
+    } else if (millis() - start >= _timeout) {
+      break;
+    }
+  }
+  return n;
+}
+
 int HardwareSerial::availableForWrite(void)
 {
   tx_buffer_index_t head;
@@ -198,8 +265,7 @@ int HardwareSerial::availableForWrite(void)
     head = _tx_buffer_head;
     tail = _tx_buffer_tail;
   }
-  if (head >= tail) return SERIAL_TX_BUFFER_SIZE - 1 - head + tail;
-  return tail - head - 1;
+  return (tx_buffer_index_t)(tail - head - 1) & _tx_mask;
 }
 
 void HardwareSerial::flush()
@@ -248,7 +314,7 @@ size_t HardwareSerial::write(uint8_t c)
     }
     return 1;
   }
-  tx_buffer_index_t i = (_tx_buffer_head + 1) % SERIAL_TX_BUFFER_SIZE;
+  tx_buffer_index_t i = (_tx_buffer_head + 1) & _tx_mask;
 	
   // If the output buffer is full, there's nothing for it other than to 
   // wait for the interrupt handler to empty it a bit
@@ -278,4 +344,42 @@ size_t HardwareSerial::write(uint8_t c)
   return 1;
 }
 
+// Queue a whole buffer, copying as much as fits at a time in one go
+// rather than byte by byte through write(uint8_t)
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = size;
+
+  _written = true;
+  while (n) {
+    tx_buffer_index_t head = _tx_buffer_head, tail;
+    TX_BUFFER_ATOMIC {
+      tail = _tx_buffer_tail;
+    }
+    // free space, keeping one slot empty to tell full from empty
+    size_t space = (tx_buffer_index_t)(tail - head - 1) & _tx_mask;
+    if (!space) {
+      // buffer full, as in write(uint8_t)
+      if (bit_is_clear(SREG, SREG_I) && bit_is_set(*_ucsra, UDRE0))
+	_tx_udr_empty_irq();
+      continue;
+    }
+    size_t chunk = _tx_mask + 1 - head; // contiguous up to the end
+    if (chunk > space)
+      chunk = space;
+    if (chunk > n)
+      chunk = n;
+    memcpy(&_tx_buffer[head], buffer, chunk);
+    buffer += chunk;
+    n -= chunk;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      _tx_buffer_head = (head + chunk) & _tx_mask;
+      sbi(*_ucsrb, UDRIE0);
+    }
+  }
+
+  return size;
+}
+
 #endif // whole file
@@ -64,10 +64,21 @@ ISR(USART_UDRE_vect)
   Serial._tx_udr_empty_irq();
 }
 
+#if (SERIAL0_RX_BUFFER_SIZE & (SERIAL0_RX_BUFFER_SIZE - 1)) || \
+    (SERIAL0_TX_BUFFER_SIZE & (SERIAL0_TX_BUFFER_SIZE - 1))
+#error "SERIAL0_RX_BUFFER_SIZE and SERIAL0_TX_BUFFER_SIZE must be powers of 2"
+#endif
+static unsigned char serial0_rx_buffer[SERIAL0_RX_BUFFER_SIZE];
+static unsigned char serial0_tx_buffer[SERIAL0_TX_BUFFER_SIZE];
+
 #if defined(UBRRH) && defined(UBRRL)
-  HardwareSerial Serial(&UBRRH, &UBRRL, &UCSRA, &UCSRB, &UCSRC, &UDR);
+  HardwareSerial Serial(&UBRRH, &UBRRL, &UCSRA, &UCSRB, &UCSRC, &UDR,
+    serial0_rx_buffer, SERIAL0_RX_BUFFER_SIZE - 1,
+    serial0_tx_buffer, SERIAL0_TX_BUFFER_SIZE - 1);
 #else
-  HardwareSerial Serial(&UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0);
+  HardwareSerial Serial(&UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0,
+    serial0_rx_buffer, SERIAL0_RX_BUFFER_SIZE - 1,
+    serial0_tx_buffer, SERIAL0_TX_BUFFER_SIZE - 1);
 #endif
 
 // Function that can be weakly referenced by serialEventRun to prevent
@@ -58,7 +58,16 @@ ISR(USART1_UDRE_vect)
   Serial1._tx_udr_empty_irq();
 }
 
-HardwareSerial Serial1(&UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1);
+#if (SERIAL1_RX_BUFFER_SIZE & (SERIAL1_RX_BUFFER_SIZE - 1)) || \
+    (SERIAL1_TX_BUFFER_SIZE & (SERIAL1_TX_BUFFER_SIZE - 1))
+#error "SERIAL1_RX_BUFFER_SIZE and SERIAL1_TX_BUFFER_SIZE must be powers of 2"
+#endif
+static unsigned char serial1_rx_buffer[SERIAL1_RX_BUFFER_SIZE];
+static unsigned char serial1_tx_buffer[SERIAL1_TX_BUFFER_SIZE];
+
+HardwareSerial Serial1(&UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1,
+    serial1_rx_buffer, SERIAL1_RX_BUFFER_SIZE - 1,
+    serial1_tx_buffer, SERIAL1_TX_BUFFER_SIZE - 1);
 
 // Function that can be weakly referenced by serialEventRun to prevent
 // pulling in this file if it's not otherwise used.
@@ -46,7 +46,16 @@ ISR(USART2_UDRE_vect)
   Serial2._tx_udr_empty_irq();
 }
 
-HardwareSerial Serial2(&UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2);
+#if (SERIAL2_RX_BUFFER_SIZE & (SERIAL2_RX_BUFFER_SIZE - 1)) || \
+    (SERIAL2_TX_BUFFER_SIZE & (SERIAL2_TX_BUFFER_SIZE - 1))
+#error "SERIAL2_RX_BUFFER_SIZE and SERIAL2_TX_BUFFER_SIZE must be powers of 2"
+#endif
+static unsigned char serial2_rx_buffer[SERIAL2_RX_BUFFER_SIZE];
+static unsigned char serial2_tx_buffer[SERIAL2_TX_BUFFER_SIZE];
+
+HardwareSerial Serial2(&UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2,
+    serial2_rx_buffer, SERIAL2_RX_BUFFER_SIZE - 1,
+    serial2_tx_buffer, SERIAL2_TX_BUFFER_SIZE - 1);
 
 // Function that can be weakly referenced by serialEventRun to prevent
 // pulling in this file if it's not otherwise used.
@@ -46,7 +46,16 @@ ISR(USART3_UDRE_vect)
   Serial3._tx_udr_empty_irq();
 }
 
-HardwareSerial Serial3(&UBRR3H, &UBRR3L, &UCSR3A, &UCSR3B, &UCSR3C, &UDR3);
+#if (SERIAL3_RX_BUFFER_SIZE & (SERIAL3_RX_BUFFER_SIZE - 1)) || \
+    (SERIAL3_TX_BUFFER_SIZE & (SERIAL3_TX_BUFFER_SIZE - 1))
+#error "SERIAL3_RX_BUFFER_SIZE and SERIAL3_TX_BUFFER_SIZE must be powers of 2"
+#endif
+static unsigned char serial3_rx_buffer[SERIAL3_RX_BUFFER_SIZE];
+static unsigned char serial3_tx_buffer[SERIAL3_TX_BUFFER_SIZE];
+
+HardwareSerial Serial3(&UBRR3H, &UBRR3L, &UCSR3A, &UCSR3B, &UCSR3C, &UDR3,
+    serial3_rx_buffer, SERIAL3_RX_BUFFER_SIZE - 1,
+    serial3_tx_buffer, SERIAL3_TX_BUFFER_SIZE - 1);
 
 // Function that can be weakly referenced by serialEventRun to prevent
 // pulling in this file if it's not otherwise used.
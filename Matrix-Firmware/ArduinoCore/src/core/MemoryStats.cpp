@@ -0,0 +1,186 @@
+/*
+  MemoryStats.cpp - heap and stack high-water marks
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdlib.h>
+#include "Arduino.h"
+
+#include "MemoryStats.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+extern "C" {
+  void *__real_malloc(size_t size);
+  void *__real_calloc(size_t count, size_t size);
+  void __real_free(void *ptr);
+  void *__real_realloc(void *ptr, size_t size);
+  void *__wrap_malloc(size_t size);
+  void *__wrap_calloc(size_t count, size_t size);
+  void __wrap_free(void *ptr);
+  void *__wrap_realloc(void *ptr, size_t size);
+}
+
+static size_t heapUsed;
+static size_t heapPeak;
+static uint16_t allocs;
+static uint16_t frees;
+static uint16_t failed;
+// avr-libc's calloc and realloc call malloc and free themselves, which
+// mustn't count twice
+static uint8_t nested;
+
+#if defined(__AVR__)
+
+extern char __heap_start;
+extern char *__brkval;
+static char *heapEnd = &__heap_start;
+
+// runs from .init3, after the stack pointer is set up and before .data
+// and .bss are filled in; naked and in a section of its own, so it is
+// reached by falling through from .init2 and can't use the stack it paints
+static void paintStack(void) __attribute__((naked, used, section(".init3")));
+static void paintStack(void)
+{
+  __asm__ __volatile__ (
+    "ldi r30, lo8(__heap_start)\n\t"
+    "ldi r31, hi8(__heap_start)\n\t"
+    "ldi r24, %[paint]\n\t"
+    "ldi r25, hi8(%[end])\n"
+    "1:\n\t"
+    "st Z+, r24\n\t"
+    "cpi r30, lo8(%[end])\n\t"
+    "cpc r31, r25\n\t"
+    "brlo 1b\n\t"
+    :: [paint] "M" (STACK_PAINT), [end] "i" (RAMEND + 1)
+  );
+}
+
+// malloc keeps each block's size in the size_t in front of it
+static inline size_t blockSize(void *ptr)
+{
+  return ((size_t *)ptr)[-1] + sizeof(size_t);
+}
+
+#elif defined(__GLIBC__)
+
+static inline size_t blockSize(void *ptr)
+{
+  return malloc_usable_size(ptr);
+}
+
+#else
+
+static inline size_t blockSize(void *ptr)
+{
+  (void)ptr;
+  return 0;
+}
+
+#endif
+
+static void added(void *ptr)
+{
+  heapUsed += blockSize(ptr);
+  if (heapUsed > heapPeak) heapPeak = heapUsed;
+#if defined(__AVR__)
+  if (__brkval > heapEnd) heapEnd = __brkval;
+#endif
+}
+
+void *__wrap_malloc(size_t size)
+{
+  void *ptr = __real_malloc(size);
+  if (nested) return ptr;
+  if (ptr) {
+    added(ptr);
+    allocs++;
+  } else if (size) {
+    failed++;
+  }
+  return ptr;
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+  nested++;
+  void *ptr = __real_calloc(count, size);
+  nested--;
+  if (ptr) {
+    added(ptr);
+    allocs++;
+  } else if (count && size) {
+    failed++;
+  }
+  return ptr;
+}
+
+void __wrap_free(void *ptr)
+{
+  if (!ptr || nested) {
+    __real_free(ptr);
+    return;
+  }
+  heapUsed -= blockSize(ptr);
+  frees++;
+  __real_free(ptr);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  size_t before = ptr ? blockSize(ptr) : 0;
+  nested++;
+  void *moved = __real_realloc(ptr, size);
+  nested--;
+  if (moved) {
+    heapUsed -= before;
+    added(moved);
+    if (!ptr) allocs++;
+  } else if (size) {
+    failed++;
+  } else if (ptr) {
+    // realloc(ptr, 0) freed it
+    heapUsed -= before;
+    frees++;
+  }
+  return moved;
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+// the stack is measured from the highest the heap has reached, since
+// blocks freed since then no longer hold the paint
+void getMemoryStats(memoryStats_t *stats)
+{
+  stats->heapUsed = heapUsed;
+  stats->heapPeak = heapPeak;
+  stats->allocs = allocs;
+  stats->frees = frees;
+  stats->failed = failed;
+
+#if defined(__AVR__)
+  const uint8_t *p = (const uint8_t *)heapEnd;
+  while ((p <= (const uint8_t *)RAMEND) && (*p == STACK_PAINT)) p++;
+  stats->stackPeak = RAMEND + 1 - (size_t)p;
+  stats->untouched = p - (const uint8_t *)heapEnd;
+#else
+  stats->stackPeak = 0;
+  stats->untouched = 0;
+#endif
+}
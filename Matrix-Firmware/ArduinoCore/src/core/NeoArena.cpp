@@ -0,0 +1,121 @@
+/*
+  NeoArena.cpp - fixed memory arena for library buffers
+
+  Each block is a small header followed by the data. The headers link
+  every block to the one below, so freeing the topmost block can walk
+  down past any blocks that were freed earlier and hand all of them back
+  in one go. There is no search and no splitting, so alloc() and free()
+  take constant time apart from clearing the block.
+
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "NeoArena.h"
+
+NeoArena *NeoArena::current = NULL;
+
+/*!
+  @brief   NeoArena constructor, makes the new arena the current one.
+  @param   buffer  Memory to allocate from, NEO_ARENA_ALIGN aligned.
+  @param   size    Size of buffer in bytes.
+*/
+NeoArena::NeoArena(uint8_t *buffer, size_t size)
+    : buffer(buffer), end(buffer + size), top(buffer), high(buffer),
+      last(NULL), outer(current) {
+  current = this;
+}
+
+/*!
+  @brief   NeoArena destructor, the arena that was current before this
+           one becomes current again.
+*/
+NeoArena::~NeoArena() {
+  if (current == this)
+    current = outer;
+}
+
+/*!
+  @brief   Allocate a block, cleared to 0.
+  @param   size  Bytes.
+  @return  The block, or NULL if it doesn't fit or size is 0.
+*/
+void *NeoArena::alloc(size_t size) {
+  size_t n = blockSize(size);
+  if (!n || (n > (size_t)(end - top)))
+    return NULL;
+  header_t *h = (header_t *)top;
+  h->prev = last;
+  h->free = false;
+  last = h;
+  uint8_t *ptr = top + roundUp(sizeof(header_t));
+  top += n;
+  if (top > high)
+    high = top;
+  memset(ptr, 0, roundUp(size));
+  return ptr;
+}
+
+/*!
+  @brief   Free a block from alloc(). Its space is reused once it and all
+           blocks allocated after it are free.
+  @param   ptr  The block, or NULL to do nothing.
+*/
+void NeoArena::free(void *ptr) {
+  if (!ptr)
+    return;
+  ((header_t *)((uint8_t *)ptr - roundUp(sizeof(header_t))))->free = true;
+  while (last && last->free) {
+    top = (uint8_t *)last;
+    last = last->prev;
+  }
+}
+
+/*!
+  @brief   Check whether a block came from this arena.
+  @param   ptr  Any pointer.
+  @return  true if ptr points into the arena.
+*/
+bool NeoArena::owns(const void *ptr) const {
+  return ((const uint8_t *)ptr >= buffer) && ((const uint8_t *)ptr < end);
+}
+
+/*!
+  @brief   Allocate library memory, cleared to 0, from the current arena or,
+           without one, from the heap.
+  @param   size  Bytes.
+  @return  The memory, or NULL if there isn't enough.
+*/
+void *neoAlloc(size_t size) {
+  if (NeoArena::current)
+    return NeoArena::current->alloc(size);
+  return calloc(size, 1);
+}
+
+/*!
+  @brief   Free memory from neoAlloc(), whether it came from an arena or
+           the heap.
+  @param   ptr  Memory to free, or NULL to do nothing.
+*/
+void neoFree(void *ptr) {
+  for (NeoArena *a = NeoArena::current; a; a = a->outer) {
+    if (a->owns(ptr)) {
+      a->free(ptr);
+      return;
+    }
+  }
+  free(ptr);
+}
@@ -27,6 +27,19 @@
 #include "Arduino.h"
 
 #include "Print.h"
+#include "FixedString.h"
+
+// "00" to "99", so decimal numbers are built two digits per lookup
+static const char digitPairs[201] PROGMEM =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const unsigned long powersOf10[10] PROGMEM = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
 
 // Public Methods //////////////////////////////////////////////////////////////
 
@@ -59,6 +72,11 @@ size_t Print::print(const String &s)
   return write(s.c_str(), s.length());
 }
 
+size_t Print::print(const StringView &s)
+{
+  return write(s.data(), s.length());
+}
+
 size_t Print::print(const char str[])
 {
   return write(str);
@@ -111,6 +129,42 @@ size_t Print::print(double n, int digits)
   return printFloat(n, digits);
 }
 
+// prints a fixed point number, number / 2^fracBits (fracBits < 32), rounded
+// to digits (at most 4) decimals. unlike print(double) this needs no
+// floating point at all: one multiply and shift for the decimals.
+size_t Print::printFixed(long number, uint8_t fracBits, uint8_t digits)
+{
+  size_t n = 0;
+  unsigned long magnitude = number;
+
+  if (number < 0) {
+    n += print('-');
+    magnitude = 0UL - magnitude;
+  }
+  if (digits > 4) digits = 4;
+
+  unsigned long int_part = magnitude >> fracBits;
+  unsigned long fraction = magnitude - (int_part << fracBits);
+  if (fracBits > 16) {
+    // 16 bits are plenty for 4 decimals, and keep the multiply in range
+    fraction >>= fracBits - 16;
+    fracBits = 16;
+  }
+  unsigned long scale = pgm_read_dword(&powersOf10[digits]);
+  fraction = (fraction * scale + ((1UL << fracBits) >> 1)) >> fracBits;
+  if (fraction >= scale) {
+    int_part++;
+    fraction -= scale;
+  }
+
+  n += printDecimal(int_part, 1);
+  if (digits > 0) {
+    n += print('.');
+    n += printDecimal(fraction, digits);
+  }
+  return n;
+}
+
 size_t Print::println(const __FlashStringHelper *ifsh)
 {
   size_t n = print(ifsh);
@@ -135,6 +189,13 @@ size_t Print::println(const String &s)
   return n;
 }
 
+size_t Print::println(const StringView &s)
+{
+  size_t n = print(s);
+  n += println();
+  return n;
+}
+
 size_t Print::println(const char c[])
 {
   size_t n = print(c);
@@ -210,6 +271,23 @@ size_t Print::printNumber(unsigned long n, uint8_t base)
   // prevent crash if called with base == 1
   if (base < 2) base = 10;
 
+  if (base == 10) return printDecimal(n, 1);
+
+  if ((base & (base - 1)) == 0) {
+    // powers of two (HEX, OCT, BIN) take a digit per shift, no division
+    uint8_t shift = 1;
+    while ((1 << shift) != base) shift++;
+    uint8_t mask = base - 1;
+    do {
+      char c = n & mask;
+      n >>= shift;
+
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+
+    return write(str);
+  }
+
   do {
     char c = n % base;
     n /= base;
@@ -220,6 +298,42 @@ size_t Print::printNumber(unsigned long n, uint8_t base)
   return write(str);
 }
 
+// prints n in decimal, padded with zeros to at least width (< 11) digits.
+// a division by 10000 splits off four digits at a time, 16 bit wide once
+// the rest fits; those are split in two pairs with a multiply (n * 5243
+// >> 19 is n / 100 for n < 10000) and copied from digitPairs.
+size_t Print::printDecimal(unsigned long n, uint8_t width)
+{
+  char buf[13];
+  char *end = &buf[sizeof(buf) - 1];
+  char *str = end;
+
+  *str = '\0';
+
+  while (1) {
+    unsigned long q;
+    if (n > 0xFFFF) q = n / 10000;
+    else if (n >= 10000) q = (unsigned int)n / 10000;
+    else q = 0;
+    unsigned int group = n - q * 10000;
+    unsigned int hi = ((unsigned long)group * 5243) >> 19;
+    unsigned int lo = group - hi * 100;
+
+    str -= 4;
+    memcpy_P(str, &digitPairs[hi * 2], 2);
+    memcpy_P(str + 2, &digitPairs[lo * 2], 2);
+    n = q;
+    if (!n) break;
+  }
+
+  // only the leading group can start with zeros
+  if (width < 1) width = 1;
+  while ((*str == '0') && (end - str > width)) str++;
+  while (end - str < width) *--str = '0';
+
+  return write(str);
+}
+
 size_t Print::printFloat(double number, uint8_t digits) 
 { 
   size_t n = 0;
@@ -251,9 +365,20 @@ size_t Print::printFloat(double number, uint8_t digits)
   // Print the decimal point, but only if there are digits beyond
   if (digits > 0) {
     n += print('.'); 
+
+    // Up to 9 digits are scaled up in one multiply and printed as one
+    // zero padded number
+    uint8_t head = min(digits, 9);
+    unsigned long scale = pgm_read_dword(&powersOf10[head]);
+    remainder *= scale;
+    unsigned long toPrint = (unsigned long)(remainder);
+    if (toPrint >= scale) toPrint = scale - 1;
+    n += printDecimal(toPrint, head);
+    remainder -= toPrint;
+    digits -= head;
   }
 
-  // Extract digits from the remainder one at a time
+  // Extract any further digits from the remainder one at a time
   while (digits-- > 0)
   {
     remainder *= 10.0;
@@ -24,6 +24,7 @@
 
 #include "Arduino.h"
 #include "Stream.h"
+#include "FixedString.h"
 
 #define PARSE_TIMEOUT 1000  // default number of milli-seconds to wait
 
@@ -252,6 +253,22 @@ String Stream::readStringUntil(char terminator)
   return ret;
 }
 
+size_t Stream::readString(FixedStringBase &str)
+{
+  str.clear();
+  str._len = readBytes(str._buffer, str._capacity);
+  str._buffer[str._len] = 0;
+  return str._len;
+}
+
+size_t Stream::readStringUntil(char terminator, FixedStringBase &str)
+{
+  str.clear();
+  str._len = readBytesUntil(terminator, str._buffer, str._capacity);
+  str._buffer[str._len] = 0;
+  return str._len;
+}
+
 int Stream::findMulti( struct Stream::MultiTarget *targets, int tCount) {
   // any zero length target string automatically matches and would make
   // a mess of the rest of the algorithm.
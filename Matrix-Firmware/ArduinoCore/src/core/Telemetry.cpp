@@ -0,0 +1,69 @@
+/*
+  Telemetry.cpp - COBS framed binary packets over a Print
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include "Arduino.h"
+
+#include "Telemetry.h"
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+// the packet is built behind a spare byte and COBS encoded in place: every
+// 0 is replaced by the length of the run that follows it, and the spare
+// byte gets the length of the first run. it is only written if the output
+// has room for all of it, so a full TX buffer costs a dropped packet
+// instead of a stalled loop. the output must report availableForWrite(),
+// as HardwareSerial does. a 0 goes out first, so whatever else was written
+// to the port since the last packet ends up in a frame of its own.
+bool Telemetry::send(uint8_t type, const void *data, uint8_t size)
+{
+  uint8_t buffer[TELEMETRY_MAX_PAYLOAD + 6];
+  if (size > TELEMETRY_MAX_PAYLOAD) return false;
+
+  buffer[0] = 0;
+  buffer[2] = type;
+  buffer[3] = _seq++;
+  memcpy(buffer + 4, data, size);
+  // a 250 byte payload ends the packet at 256, past what a uint8_t holds
+  uint16_t end = size + 4;
+  uint8_t crc = 0;
+  for (uint16_t i = 2; i < end; i++) {
+    crc ^= buffer[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  buffer[end++] = crc;
+
+  uint16_t code = 1;
+  for (uint16_t i = 2; i < end; i++) {
+    if (buffer[i] == 0) {
+      buffer[code] = i - code;
+      code = i;
+    }
+  }
+  buffer[code] = end - code;
+  buffer[end++] = 0;
+
+  if (_out.availableForWrite() < end) {
+    _dropped++;
+    return false;
+  }
+  _out.write(buffer, end);
+  return true;
+}
@@ -62,6 +62,39 @@ ISR(TIMER0_OVF_vect)
 	timer0_overflow_count++;
 }
 
+// credit timer0 overflows whose interrupt never ran because interrupts were
+// disabled for longer than an overflow period (the hardware remembers only
+// one pending overflow). call with interrupts disabled.
+void creditTimer0Overflows(unsigned int count)
+{
+	unsigned long m = timer0_millis;
+	unsigned int f = timer0_fract + count * FRACT_INC;
+
+	m += (unsigned long)count * MILLIS_INC + f / FRACT_MAX;
+
+	timer0_fract = f % FRACT_MAX;
+	timer0_millis = m;
+	timer0_overflow_count += count;
+}
+
+#if defined(TCNT0) && defined(TIFR0)
+// credit the overflows missed while interrupts were off for a stretch of
+// about streamTicks timer0 ticks, which began with TCNT0 at start and an
+// overflow already pending if pending is set. the odd cycles the estimate
+// leaves out are taken from TCNT0 now, as long as they add up to less than
+// half an overflow period. call with interrupts still disabled.
+void creditTimer0Ticks(unsigned char start, unsigned char pending, unsigned long streamTicks)
+{
+	unsigned int missed;
+
+	streamTicks += (signed char)(unsigned char)(TCNT0 - start - (unsigned char)streamTicks);
+	missed = (start + streamTicks) >> 8;
+	if (missed && !pending)
+		missed--; // the hardware kept this one pending
+	creditTimer0Overflows(missed);
+}
+#endif
+
 unsigned long millis()
 {
 	unsigned long m;
@@ -0,0 +1,97 @@
+/*
+  wiring_ticks.c - high resolution clock on timer 1
+  Part of Arduino - http://www.arduino.cc/
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#include "wiring_private.h"
+
+// timer 1 counts up freely every 8 clock cycles (0.5 us at 16 MHz) and its
+// overflows, every 65536 ticks, are counted here to extend it to 48 bits.
+// at 32 ms per overflow, even the few milliseconds NeoPixel show() keeps
+// interrupts off never cost an overflow. this is opt-in, as it takes
+// timer 1 away from analogWrite() on its pins (9 and 10 on the Uno) and
+// from libraries such as Servo.
+
+#if defined(TCNT1) && defined(TOV1)
+
+#if defined(TIFR1)
+#define TICKS_TIFR TIFR1
+#define TICKS_TIMSK TIMSK1
+#else
+#define TICKS_TIFR TIFR
+#define TICKS_TIMSK TIMSK
+#endif
+
+static volatile unsigned long timer1_overflow_count = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+	timer1_overflow_count++;
+}
+
+void beginTicks()
+{
+	uint8_t oldSREG = SREG;
+
+	cli();
+	TCCR1A = 0; // normal mode, no pwm outputs
+	TCCR1B = _BV(CS11); // clock / 8
+	TCNT1 = 0;
+	TICKS_TIFR = _BV(TOV1); // clear a stale overflow
+	sbi(TICKS_TIMSK, TOIE1);
+	timer1_overflow_count = 0;
+	SREG = oldSREG;
+}
+
+// read both halves without disabling interrupts: the overflow count is
+// read before and after the counter, and if the interrupt ran in between
+// we simply try again. an overflow that's pending because interrupts are
+// off (e.g. when called from an ISR) is accounted for like in micros().
+static unsigned int readTicks(unsigned long *overflows)
+{
+	unsigned long m;
+	unsigned int t;
+
+	do {
+		m = timer1_overflow_count;
+		t = TCNT1;
+		*overflows = m;
+		if ((TICKS_TIFR & _BV(TOV1)) && (t < 0x8000))
+			(*overflows)++;
+	} while (m != timer1_overflow_count);
+
+	return t;
+}
+
+unsigned long ticks()
+{
+	unsigned long m;
+	unsigned int t = readTicks(&m);
+
+	return (m << 16) | t;
+}
+
+unsigned long long ticks64()
+{
+	unsigned long m;
+	unsigned int t = readTicks(&m);
+
+	return ((unsigned long long)m << 16) | t;
+}
+
+#endif
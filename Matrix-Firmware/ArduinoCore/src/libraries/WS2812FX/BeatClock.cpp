@@ -0,0 +1,123 @@
+/*
+  BeatClock.cpp - Tempo tracking clock for WS2812FX.
+
+  LICENSE
+
+  The MIT License (MIT)
+
+  Copyright (c) 2016  Harm Aldick
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+
+  CHANGELOG
+
+  2026-10-19   Initial version
+*/
+
+#include "BeatClock.h"
+
+void BeatClock::reset(uint16_t period) {
+  _beat_time = millis();
+  _last_onset = 0;
+  _interval = 0;
+  _beat_count = 0;
+  _confidence = 0;
+  _setPeriod(period << 4);
+}
+
+/*
+ * Feed a detected onset. Onsets within 1/8 beat of the clock's beat are
+ * in step: the phase moves 1/4 and the period 1/16 of the way towards
+ * them (a PI loop). Anything else costs confidence, and while the clock
+ * is not locked it restarts from the onset spacing as soon as two
+ * intervals in a row agree.
+ */
+void BeatClock::beat(unsigned long now) {
+  update(now);
+  uint16_t period = _period_q4 >> 4;
+  uint16_t interval = min(now - _last_onset, 0xFFFFUL);
+  uint16_t lastInterval = _interval;
+  _last_onset = now;
+  _interval = interval;
+
+  // phase error against the nearest beat, negative if the onset is early
+  int16_t err = (int16_t)(now - _beat_time);
+  if(err > (int16_t)(period >> 1)) err -= period;
+
+  if(abs(err) <= (int16_t)(period >> 3)) {
+    _beat_time += err / 4;
+    _setPeriod(_period_q4 + err); // err ms is err/16 ms in Q4
+    _confidence += (255 - _confidence) >> 2;
+  } else {
+    _confidence -= _confidence >> 3;
+    uint16_t diff = interval > lastInterval ? interval - lastInterval : lastInterval - interval;
+    if(_confidence < BEAT_LOCKED && interval >= BEAT_PERIOD_MIN && interval <= BEAT_PERIOD_MAX && diff <= (interval >> 3)) {
+      _setPeriod(interval << 4);
+      _beat_time = now;
+    }
+  }
+}
+
+/*
+ * Advance the clock to now. Returns right away between beats, so this is
+ * cheap enough to call on every sample.
+ */
+void BeatClock::update(unsigned long now) {
+  uint16_t period = _period_q4 >> 4;
+  unsigned long elapsed = now - _beat_time;
+  if(elapsed < period) return;
+
+  uint16_t beats = elapsed / period; // usually 1
+  _beat_time += (unsigned long)beats * period;
+  _beat_count += beats;
+  // beats without onsets slowly unlock the clock
+  if(now - _last_onset > 2UL * period) _confidence -= _confidence >> 3;
+}
+
+bool BeatClock::isLocked(void) {
+  return _confidence >= BEAT_LOCKED;
+}
+
+// position within the current beat, 0-255
+uint8_t BeatClock::getPhase(unsigned long now) {
+  update(now);
+  uint32_t phase = ((now - _beat_time) * _rate) >> 16;
+  return phase > 255 ? 255 : phase;
+}
+
+uint8_t BeatClock::getConfidence(void) {
+  return _confidence;
+}
+
+uint16_t BeatClock::getPeriod(void) {
+  return _period_q4 >> 4;
+}
+
+uint16_t BeatClock::getBPM(void) {
+  return 960000UL / _period_q4; // 60000 ms in Q4
+}
+
+uint16_t BeatClock::getBeatCount(void) {
+  return _beat_count;
+}
+
+void BeatClock::_setPeriod(uint16_t period_q4) {
+  _period_q4 = constrain(period_q4, BEAT_PERIOD_MIN << 4, BEAT_PERIOD_MAX << 4);
+  _rate = (256UL << 16) / (_period_q4 >> 4);
+}
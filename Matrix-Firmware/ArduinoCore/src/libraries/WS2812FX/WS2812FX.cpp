@@ -50,6 +50,11 @@
   2017-09-26   implemented segment and reverse features
   2017-11-16   changed speed calc, reduced memory footprint
   2018-02-24   added hooks for user created custom effects
+  2026-10-19   added 2D segments and matrix effects
+  2026-10-19   added per-segment blend modes (layer compositing)
+  2026-10-19   added crossfade transitions between modes
+  2026-10-19   added beat sync to a BeatClock tempo source
+  2026-10-19   support for palette mode (1 byte per pixel) strips
 */
 
 #include "WS2812FX.h"
@@ -69,21 +74,56 @@ bool WS2812FX::service() {
   bool doShow = false;
   if(_running || _triggered) {
     unsigned long now = millis(); // Be aware, millis() rolls over every 49 days
+    if(_trans_buf != NULL && (palette || now - _trans_begin >= _trans_time)) _endTransition();
+    bool onBeat = false;
+    if(_beat_clock != NULL) {
+      _beat_clock->update(now);
+      onBeat = _beat_clock->getBeatCount() != _beat_count;
+      _beat_count = _beat_clock->getBeatCount();
+    }
+    bool triggered = _triggered;
     for(uint8_t i=0; i < _active_segments_len; i++) {
       if(_active_segments[i] != INACTIVE_SEGMENT) {
-        _seg     = &_segments[_active_segments[i]];
-        _seg_len = (uint16_t)(_seg->stop - _seg->start + 1);
-        _seg_rt  = &_segment_runtimes[i];
+        _selectSegment(i);
         CLR_FRAME_CYCLE;
+        // a locked beat clock paces synced segments: every beat is a trigger
+        // and one effect cycle takes _seg->beats beats instead of _seg->speed ms
+        bool synced = _seg->beats != 0 && _beat_clock != NULL && _beat_clock->isLocked();
+        _triggered = triggered || (synced && onBeat);
         if(now > _seg_rt->next_time || _triggered) {
           SET_FRAME;
           doShow = true;
+          // blended segments render into their own layer, not the strip
+          bool layered = _beginLayer();
+          if(layered) _swapSpan(_seg_rt->layer, _seg_rt->layer_start, _seg_rt->layer_len);
+          uint16_t speed = _seg->speed;
+          if(synced) _seg->speed = constrain((uint32_t)_beat_clock->getPeriod() * _seg->beats, SPEED_MIN, SPEED_MAX);
           uint16_t delay = (MODE_PTR(_seg->mode))();
+          _seg->speed = speed;
+          if(layered) _swapSpan(_seg_rt->layer, _seg_rt->layer_start, _seg_rt->layer_len);
           _seg_rt->next_time = now + max(delay, SPEED_MIN);
           _seg_rt->counter_mode_call++;
         }
+        // during a transition the outgoing mode keeps running in its own buffer
+        if(_trans_buf != NULL && _active_segments[i] == _trans_seg && (now > _trans_rt.next_time || _triggered)) {
+          doShow = true;
+          segment_runtime* seg_rt = _seg_rt;
+          _swapSpan(_trans_buf, _trans_start, _trans_len);
+          _seg_rt = &_trans_rt;
+          uint16_t delay = (MODE_PTR(_trans_mode))();
+          _seg_rt = seg_rt;
+          _swapSpan(_trans_buf, _trans_start, _trans_len);
+          _trans_rt.next_time = now + max(delay, SPEED_MIN);
+          _trans_rt.counter_mode_call++;
+        }
       }
     }
+    // keep the crossfade moving, even if neither mode has a new frame
+    if(_trans_buf != NULL && now >= _trans_next_show) {
+      _trans_next_show = now + TRANSITION_FRAME_TIME;
+      doShow = true;
+    }
+    _triggered = triggered;
     if(doShow) {
       delay(1); // for ESP32 (see https://forums.adafruit.com/viewtopic.php?f=47&t=117327)
       show();
@@ -93,6 +133,240 @@ bool WS2812FX::service() {
   return doShow;
 }
 
+// the segment arrays come from neoAlloc(), i.e. from the NEO_ARENA() if
+// there is one, zeroed, which is also what the runtimes' initializers set.
+// if any of them doesn't fit there are no segments at all.
+void WS2812FX::_allocSegments(void) {
+  _segments = (segment*)neoAlloc(_segments_len * sizeof(segment));
+  _active_segments = (uint8_t*)neoAlloc(_active_segments_len);
+  _segment_runtimes = (segment_runtime*)neoAlloc(_active_segments_len * sizeof(segment_runtime));
+  if(_segments == NULL || _active_segments == NULL || _segment_runtimes == NULL) {
+    neoFree(_segment_runtimes);
+    neoFree(_active_segments);
+    neoFree(_segments);
+    _segments = NULL;
+    _active_segments = NULL;
+    _segment_runtimes = NULL;
+    _segments_len = 0;
+    _active_segments_len = 0;
+  }
+}
+
+// point _seg, _seg_rt and the segment dimensions at active segment slot i
+void WS2812FX::_selectSegment(uint8_t i) {
+  _seg    = &_segments[_active_segments[i]];
+  _seg_rt = &_segment_runtimes[i];
+  if(IS_2D) {
+    _seg_w = XY_X(_seg->stop) - XY_X(_seg->start) + 1;
+    _seg_h = XY_Y(_seg->stop) - XY_Y(_seg->start) + 1;
+    _seg_len = _seg_w * _seg_h;
+  } else {
+    _seg_len = (uint16_t)(_seg->stop - _seg->start + 1);
+    _seg_w = _seg_len;
+    _seg_h = 1;
+  }
+}
+
+/*
+ * Make sure the current segment's layer buffer matches its blend mode.
+ * Returns true if the segment should be rendered into its layer.
+ * Palette indices can't be blended, so in palette mode every segment
+ * overwrites the ones before it.
+ */
+bool WS2812FX::_beginLayer() {
+  if(_seg->blend_mode == BLEND_OVERWRITE || palette) {
+    if(_seg_rt->layer != NULL) _freeLayer(_seg_rt - _segment_runtimes);
+    return false;
+  }
+  if(_seg_rt->layer != NULL) return true;
+
+  uint16_t first;
+  uint16_t len = _segmentSpan(&first);
+
+  // one allocation holds the layer followed by the saved backdrop
+  _seg_rt->layer = (uint8_t*)neoAlloc(2 * len * getNumBytesPerPixel());
+  if(_seg_rt->layer == NULL) return false; // out of memory, render unblended
+  _seg_rt->layer_start = first;
+  _seg_rt->layer_len = len;
+  return true;
+}
+
+/*
+ * Exchange len pixels of buf with the strip's pixels from index first on.
+ * A mode renders into a layer or transition buffer by swapping it into
+ * the strip around the mode call, so effects keep addressing the strip
+ * by absolute index and pixels never points outside its own allocation.
+ */
+void WS2812FX::_swapSpan(uint8_t* buf, uint16_t first, uint16_t len) {
+  uint8_t *strip = pixels + (first * getNumBytesPerPixel());
+  uint16_t n = len * getNumBytesPerPixel();
+  for(uint16_t i=0; i<n; i++) {
+    uint8_t c = strip[i];
+    strip[i] = buf[i];
+    buf[i] = c;
+  }
+}
+
+/*
+ * Range of pixel indices covered by the current segment. Returns the
+ * number of pixels in the range, first receives the lowest index.
+ * A 2D segment covers a span that depends on the matrix layout.
+ */
+uint16_t WS2812FX::_segmentSpan(uint16_t* first) {
+  if(!IS_2D) {
+    *first = _seg->start;
+    return _seg_len;
+  }
+  uint16_t last = 0;
+  *first = numLEDs;
+  for(uint8_t y=0; y < _seg_h; y++) {
+    for(uint16_t x=0; x < _seg_w; x++) {
+      uint16_t index = getIndexXY(x, y);
+      if(index < *first) *first = index;
+      if(index > last)   last = index;
+    }
+  }
+  return last - *first + 1;
+}
+
+/*
+ * Call run() for every run of consecutive pixel indices in the current
+ * segment. A 1D segment is a single run, a 2D segment at least one per row.
+ */
+void WS2812FX::_forEachRun(void (WS2812FX::*run)(uint16_t, uint16_t, bool), bool restore) {
+  if(!IS_2D) {
+    (this->*run)(_seg->start, _seg_len, restore);
+    return;
+  }
+  for(uint8_t y=0; y < _seg_h; y++) {
+    uint16_t x = 0;
+    while(x < _seg_w) {
+      uint16_t first = getIndexXY(x, y);
+      uint16_t cnt = 1;
+      while(x + cnt < _seg_w && getIndexXY(x + cnt, y) == first + cnt) cnt++;
+      (this->*run)(first, cnt, restore);
+      x += cnt;
+    }
+  }
+}
+
+void WS2812FX::_freeLayer(uint8_t i) {
+  neoFree(_segment_runtimes[i].layer);
+  _segment_runtimes[i].layer = NULL;
+  _segment_runtimes[i].layer_len = 0;
+}
+
+/*
+ * Blend all layers over the strip in active segment order, saving the
+ * backdrop under each one (restore == false), or put the saved backdrops
+ * back in reverse order (restore == true). Runs of consecutive pixel
+ * indices are handed to the composite() kernel in one go.
+ */
+void WS2812FX::_compositeLayers(bool restore) {
+  if(palette) return; // layers are freed on the next frame
+  for(uint8_t k=0; k < _active_segments_len; k++) {
+    uint8_t i = restore ? _active_segments_len - 1 - k : k;
+    if(_active_segments[i] == INACTIVE_SEGMENT || _segment_runtimes[i].layer == NULL) continue;
+    _selectSegment(i);
+    _forEachRun(&WS2812FX::_compositeRun, restore);
+  }
+}
+
+void WS2812FX::_compositeRun(uint16_t first, uint16_t cnt, bool restore) {
+  uint8_t bytesPerPixel = getNumBytesPerPixel();
+  uint16_t offset = (first - _seg_rt->layer_start) * bytesPerPixel;
+  uint16_t n = cnt * bytesPerPixel;
+  uint8_t *strip    = pixels + (first * bytesPerPixel);
+  uint8_t *layer    = _seg_rt->layer + offset;
+  uint8_t *backdrop = _seg_rt->layer + (_seg_rt->layer_len * bytesPerPixel) + offset;
+
+  if(restore) {
+    memcpy(strip, backdrop, n);
+  } else {
+    memcpy(backdrop, strip, n);
+    composite(strip, backdrop, layer, n, _seg->blend_mode, _seg->alpha);
+  }
+}
+
+/*
+ * Start crossfading segment seg from its current mode. The outgoing mode
+ * keeps its runtime and renders into a buffer of its own, followed by room
+ * to save the incoming mode's pixels while the mix is shown, i.e. twice the
+ * segment span. Starting a new transition ends the previous one. Palette
+ * indices can't be mixed, so in palette mode modes switch instantly.
+ */
+void WS2812FX::_beginTransition(uint8_t seg) {
+  _endTransition();
+  if(palette) return;
+  uint8_t* ptr = (uint8_t*)memchr(_active_segments, seg, _active_segments_len);
+  if(ptr == NULL) return; // segment not active, nothing to fade from
+  _selectSegment(ptr - _active_segments);
+
+  uint8_t bytesPerPixel = getNumBytesPerPixel();
+  uint16_t first;
+  uint16_t len = _segmentSpan(&first);
+  _trans_buf = (uint8_t*)neoAlloc(2 * len * bytesPerPixel);
+  if(_trans_buf == NULL) return; // out of memory, switch modes instantly
+
+  // the outgoing mode carries on from the frame it last rendered
+  uint8_t* src = (_seg_rt->layer != NULL) ? _seg_rt->layer : pixels + (first * bytesPerPixel);
+  memcpy(_trans_buf, src, len * bytesPerPixel);
+  _trans_rt = *_seg_rt;
+  _trans_rt.layer = NULL; // the layer stays with the incoming mode
+  _trans_start = first;
+  _trans_len = len;
+  _trans_seg = seg;
+  _trans_mode = _seg->mode;
+  _trans_begin = millis();
+  _trans_next_show = 0;
+}
+
+void WS2812FX::_endTransition(void) {
+  neoFree(_trans_buf);
+  _trans_buf = NULL;
+}
+
+/*
+ * Mix the outgoing mode into the incoming one for the duration of a
+ * show() (restore == false), then undo it (restore == true), so neither
+ * mode ever reads the mixed pixels as its own.
+ */
+void WS2812FX::_crossfade(bool restore) {
+  if(_trans_buf == NULL || palette) return; // ended on the next frame
+  uint8_t* ptr = (uint8_t*)memchr(_active_segments, _trans_seg, _active_segments_len);
+  if(ptr == NULL) return;
+  _selectSegment(ptr - _active_segments);
+
+  if(!restore) {
+    unsigned long elapsed = millis() - _trans_begin;
+    _trans_amt = (elapsed >= _trans_time) ? 255 : (uint8_t)((elapsed << 8) / _trans_time);
+  }
+  _forEachRun(&WS2812FX::_crossfadeRun, restore);
+}
+
+/*
+ * Crossfade kernel. Saves the incoming pixels in the second half of the
+ * transition buffer and writes the mix over them, restoring copies them
+ * back. The outgoing mode's frame is only ever read, so effects that build
+ * on their previous frame carry on from their own output, not the mix.
+ */
+void WS2812FX::_crossfadeRun(uint16_t first, uint16_t cnt, bool restore) {
+  uint8_t bytesPerPixel = getNumBytesPerPixel();
+  uint16_t n = cnt * bytesPerPixel;
+  uint8_t *out = _trans_buf + ((first - _trans_start) * bytesPerPixel);
+  uint8_t *saved = out + (_trans_len * bytesPerPixel);
+  uint8_t *in = (_seg_rt->layer != NULL) ?
+    _seg_rt->layer + ((first - _seg_rt->layer_start) * bytesPerPixel) :
+    pixels + (first * bytesPerPixel);
+
+  if(restore) {
+    memcpy(in, saved, n);
+  } else {
+    memcpy(saved, in, n);
+    blend(in, out, saved, n, _trans_amt);
+  }
+}
+
 // overload setPixelColor() functions so we can use gamma correction
 // (see https://learn.adafruit.com/led-tricks-gamma-correction/the-issue)
 void WS2812FX::setPixelColor(uint16_t n, uint32_t c) {
@@ -115,11 +389,30 @@ void WS2812FX::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_
   }
 }
 
+// x/y are relative to the current segment. 1D segments are treated as a
+// single row, so 2D effects still do something sensible on a plain strip.
+uint16_t WS2812FX::getIndexXY(uint16_t x, uint16_t y) {
+  if(IS_2D) {
+    x += XY_X(_seg->start);
+    y += XY_Y(_seg->start);
+    return indexMap ? indexMap[y * WIDTH + x] : pixelIndex(x, y);
+  }
+  return _seg->start + y * _seg_w + x;
+}
+
+void WS2812FX::setPixelColorXY(uint16_t x, uint16_t y, uint32_t c) {
+  setPixelColor(getIndexXY(x, y), c);
+}
+
 // custom setPixelColor() function that bypasses the Adafruit_Neopixel global brightness rigmarole
 void WS2812FX::setRawPixelColor(uint16_t n, uint32_t c) {
   if (n < numLEDs) {
-    uint8_t *p = (wOffset == rOffset) ? &pixels[n * 3] : &pixels[n * 4]; 
     uint8_t w = (uint8_t)(c >> 24), r = (uint8_t)(c >> 16), g = (uint8_t)(c >> 8), b = (uint8_t)c;
+    if(palette) { // palette mode, store the closest entry
+      pixels[n] = closestPaletteIndex(r, g, b, w);
+      return;
+    }
+    uint8_t *p = (wOffset == rOffset) ? &pixels[n * 3] : &pixels[n * 4]; 
 
     p[wOffset] = w;
     p[rOffset] = r;
@@ -133,10 +426,10 @@ uint32_t WS2812FX::getRawPixelColor(uint16_t n) {
   if (n >= numLEDs) return 0; // Out of bounds, return no color.
 
   if(wOffset == rOffset) { // RGB
-    uint8_t *p = &pixels[n * 3]; 
+    uint8_t *p = palette ? &palette[pixels[n] * 3] : &pixels[n * 3];
     return ((uint32_t)p[rOffset] << 16) | ((uint32_t)p[gOffset] << 8) | (uint32_t)p[bOffset];
   } else { // RGBW
-    uint8_t *p = &pixels[n * 4];
+    uint8_t *p = palette ? &palette[pixels[n] * 4] : &pixels[n * 4];
     return ((uint32_t)p[wOffset] << 24) | ((uint32_t)p[rOffset] << 16) | ((uint32_t)p[gOffset] << 8) | (uint32_t)p[bOffset];
   }
 }
@@ -150,15 +443,21 @@ void WS2812FX::copyPixels(uint16_t dest, uint16_t src, uint16_t count) {
 
 // change the underlying Adafruit_NeoPixel pixels pointer (use with care)
 void WS2812FX::setPixels(uint16_t num_leds, uint8_t* ptr) {
-  free(Adafruit_NeoMatrix::pixels); // free existing data (if any)
+  neoFree(Adafruit_NeoMatrix::pixels); // free existing data (if any)
   Adafruit_NeoMatrix::pixels = ptr;
   Adafruit_NeoMatrix::numLEDs = num_leds;
-  Adafruit_NeoMatrix::numBytes = num_leds * ((wOffset == rOffset) ? 3 : 4);
+  Adafruit_NeoMatrix::numBytes = num_leds * getNumBytesPerPixel();
 }
 
 // overload show() functions so we can use custom show()
+// blended segment layers and a running transition are mixed in for the
+// duration of the show only, so effects never see each other's output
 void WS2812FX::show(void) {
+  _crossfade(false);
+  _compositeLayers(false);
   customShow == NULL ? Adafruit_NeoMatrix::show() : customShow();
+  _compositeLayers(true);
+  _crossfade(true);
 }
 
 void WS2812FX::start() {
@@ -188,14 +487,40 @@ void WS2812FX::setMode(uint8_t m) {
 }
 
 void WS2812FX::setMode(uint8_t seg, uint8_t m) {
+  m = constrain(m, 0, MODE_COUNT - 1);
+  if((_segments[seg].options & MATRIX_2D) && !IS_2D_MODE(m)) return; // 1D modes would write outside the rectangle
+  if(_trans_time > 0 && m != _segments[seg].mode) _beginTransition(seg);
   resetSegmentRuntime(seg);
-  _segments[seg].mode = constrain(m, 0, MODE_COUNT - 1);
+  _segments[seg].mode = m;
+}
+
+// crossfade time used by setMode(), 0 switches modes instantly (as does
+// palette mode)
+void WS2812FX::setTransitionTime(uint16_t t) {
+  _trans_time = t;
+  if(t == 0) _endTransition();
+}
+
+void WS2812FX::setBeatClock(BeatClock* c) {
+  _beat_clock = c;
+  if(c != NULL) _beat_count = c->getBeatCount();
+}
+
+// 0 runs the segment at its own speed again
+void WS2812FX::setBeatSync(uint8_t seg, uint8_t beats) {
+  _segments[seg].beats = beats;
 }
 
 void WS2812FX::setOptions(uint8_t seg, uint8_t o) {
   _segments[seg].options = o;
 }
 
+// the layer buffer is (de)allocated on the segment's next frame
+void WS2812FX::setBlendMode(uint8_t seg, uint8_t b, uint8_t alpha) {
+  _segments[seg].blend_mode = b;
+  _segments[seg].alpha = alpha;
+}
+
 void WS2812FX::setSpeed(uint16_t s) {
   setSpeed(0, s);
 }
@@ -327,10 +652,26 @@ uint16_t WS2812FX::getSpeed(uint8_t seg) {
   return _segments[seg].speed;
 }
 
+uint16_t WS2812FX::getTransitionTime(void) {
+  return _trans_time;
+}
+
 uint8_t WS2812FX::getOptions(uint8_t seg) {
   return _segments[seg].options;
 }
 
+uint8_t WS2812FX::getBlendMode(uint8_t seg) {
+  return _segments[seg].blend_mode;
+}
+
+uint8_t WS2812FX::getBeatSync(uint8_t seg) {
+  return _segments[seg].beats;
+}
+
+BeatClock* WS2812FX::getBeatClock(void) {
+  return _beat_clock;
+}
+
 uint16_t WS2812FX::getLength(void) {
   return numPixels();
 }
@@ -339,7 +680,11 @@ uint16_t WS2812FX::getNumBytes(void) {
   return numBytes;
 }
 
+// in palette mode the pixel buffer holds palette indices, one byte each.
+// copyPixels() moves them around fine, but they can't be mixed, so there
+// are no blend layers or crossfades in palette mode.
 uint8_t WS2812FX::getNumBytesPerPixel(void) {
+  if(palette) return 1;
   return (wOffset == rOffset) ? 3 : 4; // 3=RGB, 4=RGBW
 }
 
@@ -454,7 +799,10 @@ void WS2812FX::setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode
   setSegment(n, start, stop, mode, colors, speed, (uint8_t)(reverse ? REVERSE : NO_OPTIONS));
 }
 
+// 1D modes index pixels from start to stop, which on a MATRIX_2D segment
+// are packed corners, so a 2D segment only takes IS_2D_MODE() modes
 void WS2812FX::setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, const uint32_t colors[], uint16_t speed, uint8_t options) {
+  if((options & MATRIX_2D) && !IS_2D_MODE(mode)) return;
   if(n < _segments_len) {
     if(n + 1 > _num_segments) _num_segments = n + 1;
     _segments[n].start = start;
@@ -465,10 +813,27 @@ void WS2812FX::setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode
 
     setColors(n, (uint32_t*)colors);
 
+    // the segment's geometry may have changed, so reallocate its layer on the next frame
+    uint8_t* ptr = (uint8_t*)memchr(_active_segments, n, _active_segments_len);
+    if(ptr != NULL) _freeLayer(ptr - _active_segments);
+    if(_trans_buf != NULL && _trans_seg == n) _endTransition();
+
     if(n < _active_segments_len) addActiveSegment(n);
   }
 }
 
+void WS2812FX::setSegment2D(uint8_t n, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t mode, uint32_t color, uint16_t speed, uint8_t options) {
+  uint32_t colors[] = {color, 0, 0};
+  setSegment2D(n, x, y, w, h, mode, colors, speed, options);
+}
+
+// x/y/w/h are in unrotated matrix coordinates
+void WS2812FX::setSegment2D(uint8_t n, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t mode, const uint32_t colors[], uint16_t speed, uint8_t options) {
+  if(w == 0 || h == 0 || x + w > WIDTH || y + h > HEIGHT || !IS_2D_MODE(mode)) return;
+  if(!indexMap) buildIndexMap(); // if this fails, indices are computed on the fly
+  setSegment(n, XY_PACK(x, y), XY_PACK(x + w - 1, y + h - 1), mode, colors, speed, (uint8_t)(options | MATRIX_2D));
+}
+
 void WS2812FX::setIdleSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t mode, uint32_t color, uint16_t speed) {
   setIdleSegment(n, start, stop, mode, color, speed, NO_OPTIONS);
 }
@@ -499,6 +864,8 @@ void WS2812FX::removeActiveSegment(uint8_t seg) {
   for(uint8_t i=0; i<_active_segments_len; i++) {
     if(_active_segments[i] == seg) {
       _active_segments[i] = INACTIVE_SEGMENT;
+      _freeLayer(i);
+      if(_trans_buf != NULL && _trans_seg == seg) _endTransition();
     }
   }
 }
@@ -509,6 +876,8 @@ void WS2812FX::swapActiveSegment(uint8_t oldSeg, uint8_t newSeg) {
   for(uint8_t i=0; i<_active_segments_len; i++) {
     if(_active_segments[i] == oldSeg) {
       _active_segments[i] = newSeg;
+      _freeLayer(i); // the new segment may cover a different span
+      if(_trans_buf != NULL && _trans_seg == oldSeg) _endTransition();
 
       // reset all runtime parameters EXCEPT next_time,
       // allowing the current animation frame to complete
@@ -529,7 +898,15 @@ bool WS2812FX::isActiveSegment(uint8_t seg) {
   return false;
 }
 
+bool WS2812FX::isTransitioning(void) {
+  return _trans_buf != NULL;
+}
+
 void WS2812FX::resetSegments() {
+  for(uint8_t i=0; i<_active_segments_len; i++) {
+    _freeLayer(i);
+  }
+  _endTransition();
   resetSegmentRuntimes();
   memset(_segments, 0, _segments_len * sizeof(Segment));
   memset(_active_segments, INACTIVE_SEGMENT, _active_segments_len);
@@ -545,12 +922,13 @@ void WS2812FX::resetSegmentRuntimes() {
 void WS2812FX::resetSegmentRuntime(uint8_t seg) {
   uint8_t* ptr = (uint8_t*)memchr(_active_segments, seg, _active_segments_len);
   if(ptr == NULL) return; // segment not active
-  _segment_runtimes[seg].next_time = 0;
-  _segment_runtimes[seg].counter_mode_step = 0;
-  _segment_runtimes[seg].counter_mode_call = 0;
-  _segment_runtimes[seg].aux_param = 0;
-  _segment_runtimes[seg].aux_param2 = 0;
-  _segment_runtimes[seg].aux_param3 = 0;
+  segment_runtime* seg_rt = &_segment_runtimes[ptr - _active_segments];
+  seg_rt->next_time = 0;
+  seg_rt->counter_mode_step = 0;
+  seg_rt->counter_mode_call = 0;
+  seg_rt->aux_param = 0;
+  seg_rt->aux_param2 = 0;
+  seg_rt->aux_param3 = 0;
   // don't reset any external data source
 }
 
@@ -630,29 +1008,23 @@ uint16_t WS2812FX::random16(uint16_t lim) {
 // Return the sum of all LED intensities (can be used for
 // rudimentary power calculations)
 uint32_t WS2812FX::intensitySum() {
-  uint8_t *pixels = getPixels();
-  uint32_t sum = 0;
-  for(uint16_t i=0; i <numBytes; i++) {
-    sum+= pixels[i];
-  }
-  return sum;
+  uint32_t *sums = intensitySums();
+  return sums[0] + sums[1] + sums[2] + sums[3];
 }
 
 // Return the sum of each color's intensity. Note, the order of
 // intensities in the returned array depends on the type of WS2812
 // LEDs you have. NEO_GRB LEDs will return an array with entries
-// in a different order then NEO_RGB LEDs.
+// in a different order then NEO_RGB LEDs. In palette mode the
+// colors of the pixels' palette entries are summed.
 uint32_t* WS2812FX::intensitySums() {
   static uint32_t intensities[] = { 0, 0, 0, 0 };
   memset(intensities, 0, sizeof(intensities));
 
-  uint8_t *pixels = getPixels();
-  uint8_t bytesPerPixel = getNumBytesPerPixel(); // 3=RGB, 4=RGBW
-  for(uint16_t i=0; i <numBytes; i += bytesPerPixel) {
-    intensities[0] += pixels[i];
-    intensities[1] += pixels[i + 1];
-    intensities[2] += pixels[i + 2];
-    if(bytesPerPixel == 4) intensities[3] += pixels[i + 3]; // for RGBW LEDs
+  uint8_t colorBytes = (wOffset == rOffset) ? 3 : 4; // 3=RGB, 4=RGBW
+  for(uint16_t n=0; n < numLEDs; n++) {
+    uint8_t *p = palette ? &palette[pixels[n] * colorBytes] : &pixels[n * colorBytes];
+    for(uint8_t i=0; i < colorBytes; i++) intensities[i] += p[i];
   }
   return intensities;
 }
@@ -670,7 +1042,7 @@ uint8_t WS2812FX::setCustomMode(const __FlashStringHelper* name, uint16_t (*p)()
 }
 
 uint8_t WS2812FX::setCustomMode(uint8_t index, const __FlashStringHelper* name, uint16_t (*p)()) {
-  if((uint8_t)(FX_MODE_CUSTOM_0 + index) < MODE_COUNT) {
+  if(index < MAX_CUSTOM_MODES) { // the 2D modes follow the custom ones
     MODE_NAME(FX_MODE_CUSTOM_0 + index) = name;
     customModes[index] = p; // store the custom mode
 
@@ -0,0 +1,175 @@
+/*
+  modes_2d.cpp - WS2812FX effects for 2D (matrix) segments
+
+  LICENSE
+
+  The MIT License (MIT)
+
+  Copyright (c) 2016  Harm Aldick
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+
+
+  CHANGELOG
+
+  2026-10-19   Initial version: plasma, fire, matrix rain and ripple
+
+  NOTES
+    * These effects address pixels by x/y within the segment through
+      getIndexXY(), which reads the NeoMatrix index map. Set up the
+      segment with setSegment2D() so the map is built up front.
+    * All math is 8/16-bit integer, no floats. effects_2d_benchmark in
+      tools/host times each effect per frame, on the host only; it says
+      nothing about AVR cycles.
+*/
+#include "WS2812FX.h"
+
+/*
+ * Map a heat value (0-255) onto a black -> red -> yellow -> white ramp.
+ */
+uint32_t WS2812FX::heat_color(uint8_t temperature) {
+  uint8_t t192 = ((uint16_t)temperature * 191) >> 8; // scale to 0-191
+  uint8_t ramp = (t192 & 0x3F) << 2;                 // 0-252 within each third
+
+  if(t192 & 0x80) {        // hottest third
+    return ((uint32_t)255 << 16) | ((uint32_t)255 << 8) | ramp;
+  } else if(t192 & 0x40) { // middle third
+    return ((uint32_t)255 << 16) | ((uint32_t)ramp << 8);
+  } else {                 // coolest third
+    return ((uint32_t)ramp << 16);
+  }
+}
+
+/*
+ * Plasma. Three interfering sine waves drive the color wheel.
+ */
+uint16_t WS2812FX::mode_plasma(void) {
+  uint8_t t = _seg_rt->counter_mode_step;
+
+  for(uint8_t y=0; y < _seg_h; y++) {
+    uint8_t vy = sine8((y << 4) + t);
+    for(uint16_t x=0; x < _seg_w; x++) {
+      uint16_t sum = sine8((x << 4) - t) + vy + sine8(((x + y) << 3) + (t << 1));
+      uint8_t v = (sum * 85) >> 8; // ~sum/3 without a division
+      setPixelColor(getIndexXY(x, y), color_wheel(v + t));
+    }
+  }
+
+  _seg_rt->counter_mode_step++;
+  if((_seg_rt->counter_mode_step & 0xFF) == 0) SET_CYCLE;
+  return (_seg->speed / 64);
+}
+
+/*
+ * 2D fire. Every row takes a cooled copy of the row below it (with a bit
+ * of sideways jitter), the bottom row is reseeded with random heat.
+ * Pixels are copied raw, so the global brightness is only applied once.
+ */
+uint16_t WS2812FX::mode_fire_2d(void) {
+  uint8_t bottom = _seg_h - 1;
+
+  for(uint8_t y=0; y < bottom; y++) {
+    for(uint16_t x=0; x < _seg_w; x++) {
+      int16_t sx = (int16_t)x + (int16_t)random8(3) - 1;
+      if(sx < 0) sx = 0;
+      if(sx >= (int16_t)_seg_w) sx = _seg_w - 1;
+      uint32_t color = getRawPixelColor(getIndexXY(sx, y + 1));
+      setRawPixelColor(getIndexXY(x, y), color_blend(color, BLACK, 24 + random8(64)));
+    }
+  }
+
+  uint8_t minHeat = _triggered ? 200 : 120;
+  for(uint16_t x=0; x < _seg_w; x++) {
+    setPixelColor(getIndexXY(x, bottom), heat_color(minHeat + random8(256 - minHeat)));
+  }
+
+  SET_CYCLE;
+  return (_seg->speed / 32);
+}
+
+/*
+ * Matrix rain. Columns scroll down one row per frame; the top row either
+ * spawns a new drop in color[0] or fades what was there, which leaves a
+ * trail behind each drop.
+ */
+uint16_t WS2812FX::mode_matrix_rain(void) {
+  for(uint8_t y=_seg_h - 1; y > 0; y--) { // bottom up, so nothing is read after being overwritten
+    for(uint16_t x=0; x < _seg_w; x++) {
+      setRawPixelColor(getIndexXY(x, y), getRawPixelColor(getIndexXY(x, y - 1)));
+    }
+  }
+
+  uint8_t spawn = _triggered ? 96 : 24;
+  for(uint16_t x=0; x < _seg_w; x++) {
+    uint16_t index = getIndexXY(x, 0);
+    if(random8() < spawn) {
+      setPixelColor(index, _seg->colors[0]);
+      SET_CYCLE;
+    } else {
+      setRawPixelColor(index, color_blend(getRawPixelColor(index), BLACK, 80));
+    }
+  }
+
+  return (_seg->speed / 16);
+}
+
+/*
+ * Ripple. A ring expands from a random point (or restarts on trigger).
+ * counter_mode_step holds the radius in quarter pixels, aux_param3 the
+ * packed center and aux_param the color wheel index.
+ */
+uint16_t WS2812FX::mode_ripple(void) {
+  uint16_t maxDim = max(_seg_w, (uint16_t)_seg_h);
+
+  if(_seg_rt->counter_mode_step == 0 || _triggered) {
+    _seg_rt->aux_param3 = XY_PACK(random16(_seg_w), random8(_seg_h));
+    _seg_rt->aux_param = get_random_wheel_index(_seg_rt->aux_param);
+    _seg_rt->counter_mode_step = 1;
+  }
+
+  uint8_t cx = XY_X(_seg_rt->aux_param3);
+  uint8_t cy = XY_Y(_seg_rt->aux_param3);
+  uint16_t radius = _seg_rt->counter_mode_step;
+  uint32_t color = color_wheel(_seg_rt->aux_param);
+  // the ring fades out as it grows
+  uint8_t amp = 255 - (uint8_t)(((uint32_t)radius * 255) / (maxDim * 8));
+
+  for(uint8_t y=0; y < _seg_h; y++) {
+    uint8_t dy = y > cy ? y - cy : cy - y;
+    for(uint16_t x=0; x < _seg_w; x++) {
+      uint8_t dx = x > cx ? x - cx : cx - x;
+      // octagonal distance (max + min/2) in quarter pixels
+      uint16_t dist = (dx > dy) ? (dx << 2) + (dy << 1) : (dy << 2) + (dx << 1);
+      uint16_t diff = dist > radius ? dist - radius : radius - dist;
+      if(diff < 8) {
+        uint8_t level = ((uint16_t)(255 - (diff << 5)) * amp) >> 8;
+        setPixelColor(getIndexXY(x, y), color_blend(BLACK, color, level));
+      } else {
+        setPixelColor(getIndexXY(x, y), BLACK);
+      }
+    }
+  }
+
+  _seg_rt->counter_mode_step++;
+  if(_seg_rt->counter_mode_step >= (uint32_t)maxDim * 8) {
+    _seg_rt->counter_mode_step = 0;
+    SET_CYCLE;
+  }
+  return (_seg->speed / 32);
+}
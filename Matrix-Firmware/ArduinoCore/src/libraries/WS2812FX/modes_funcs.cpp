@@ -217,14 +217,48 @@ uint8_t* WS2812FX::blend(uint8_t *dest, uint8_t *src1, uint8_t *src2, uint16_t c
   } else if(blendAmt == 255) {
     memmove(dest, src2, cnt);
   } else {
+    // unsigned 8x8 multiplies only, no signed division
+    uint16_t inv = 256 - blendAmt;
     for(uint16_t i=0; i<cnt; i++) {
-//    dest[i] = map(blendAmt, 0, 255, src1[i], src2[i]);
-      dest[i] =  blendAmt * ((int)src2[i] - (int)src1[i]) / 256 + src1[i]; // map() function
+      dest[i] = (src1[i] * inv + (uint16_t)src2[i] * blendAmt) >> 8;
     }
   }
   return dest;
 }
 
+/*
+ * Layer composite function. Combines cnt bytes of a backdrop (src1) and a
+ * layer (src2) into dest using one of the BLEND_* modes. The mode is
+ * dispatched once per call, so each loop below is a tight per-byte kernel.
+ */
+uint8_t* WS2812FX::composite(uint8_t *dest, uint8_t *src1, uint8_t *src2, uint16_t cnt, uint8_t blendMode, uint8_t alpha) {
+  switch(blendMode) {
+    case BLEND_ADD:
+      for(uint16_t i=0; i<cnt; i++) {
+        uint16_t sum = src1[i] + src2[i];
+        dest[i] = sum > 255 ? 255 : sum;
+      }
+      break;
+    case BLEND_MAX:
+      for(uint16_t i=0; i<cnt; i++) {
+        dest[i] = src1[i] > src2[i] ? src1[i] : src2[i];
+      }
+      break;
+    case BLEND_MULTIPLY:
+      for(uint16_t i=0; i<cnt; i++) {
+        dest[i] = ((uint16_t)src1[i] * src2[i] + 255) >> 8;
+      }
+      break;
+    case BLEND_ALPHA:
+      blend(dest, src1, src2, cnt, alpha);
+      break;
+    default: // BLEND_OVERWRITE
+      memmove(dest, src2, cnt);
+      break;
+  }
+  return dest;
+}
+
 /*
  * twinkle_fade function
  */
@@ -346,16 +380,28 @@ uint16_t WS2812FX::running(uint32_t color1, uint32_t color2) {
 uint16_t WS2812FX::fireworks(uint32_t color) {
   fade_out();
 
-// for better performance, manipulate the Adafruit_NeoPixels pixels[] array directly
-  uint8_t *pixels = getPixels();
-  uint8_t bytesPerPixel = getNumBytesPerPixel(); // 3=RGB, 4=RGBW
-  uint16_t startPixel = _seg->start * bytesPerPixel + bytesPerPixel;
-  uint16_t stopPixel = _seg->stop * bytesPerPixel;
-  for(uint16_t i=startPixel; i <stopPixel; i++) {
-    uint16_t tmpPixel = (pixels[i - bytesPerPixel] >> 2) +
-      pixels[i] +
-      (pixels[i + bytesPerPixel] >> 2);
-    pixels[i] =  tmpPixel > 255 ? 255 : tmpPixel;
+  if(palette) { // the buffer holds palette indices, blur their colors instead
+    for(uint16_t i=_seg->start + 1; i < _seg->stop; i++) {
+      uint32_t prev = getRawPixelColor(i - 1), cur = getRawPixelColor(i), next = getRawPixelColor(i + 1);
+      uint32_t blurred = 0;
+      for(uint8_t shift=0; shift < 32; shift += 8) {
+        uint16_t c = (((prev >> shift) & 0xFF) >> 2) + ((cur >> shift) & 0xFF) + (((next >> shift) & 0xFF) >> 2);
+        blurred |= (uint32_t)(c > 255 ? 255 : c) << shift;
+      }
+      setRawPixelColor(i, blurred);
+    }
+  } else {
+    // for better performance, manipulate the Adafruit_NeoPixels pixels[] array directly
+    uint8_t *pixels = getPixels();
+    uint8_t bytesPerPixel = getNumBytesPerPixel(); // 3=RGB, 4=RGBW
+    uint16_t startPixel = _seg->start * bytesPerPixel + bytesPerPixel;
+    uint16_t stopPixel = _seg->stop * bytesPerPixel;
+    for(uint16_t i=startPixel; i <stopPixel; i++) {
+      uint16_t tmpPixel = (pixels[i - bytesPerPixel] >> 2) +
+        pixels[i] +
+        (pixels[i + bytesPerPixel] >> 2);
+      pixels[i] =  tmpPixel > 255 ? 255 : tmpPixel;
+    }
   }
 
   uint8_t size = 2 << SIZE_OPTION;
@@ -71,6 +71,19 @@ static volatile uint8_t twi_rxBufferIndex;
 
 static volatile uint8_t twi_error;
 
+// buffer the master states work on, twi_masterBuffer or a queued transaction's
+static uint8_t* volatile twi_masterData;
+
+// queued transactions; twi_current is the one on the bus, if any
+static twi_transaction_t* volatile twi_current;
+static twi_transaction_t* volatile twi_queueHead;
+static twi_transaction_t* volatile twi_queueTail;
+static volatile uint32_t twi_currentMicros;
+
+static void twi_setReady(void);
+static void twi_finish(uint8_t);
+static void twi_startNext(void);
+
 /* 
  * Function twi_init
  * Desc     readys twi pins and sets twi bitrate
@@ -146,6 +159,39 @@ void twi_setFrequency(uint32_t frequency)
   It is 72 for a 16mhz Wiring board with 100kHz TWI */
 }
 
+/* 
+ * Function twi_claim
+ * Desc     becomes bus master in the given state, unless the bus is
+ *          busy (with a queued transaction started by the ISR, say)
+ * Input    state: TWI_MRX or TWI_MTX
+ * Output   true if the bus was claimed
+ */
+static bool twi_claim(uint8_t state)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  bool claimed = (TWI_READY == twi_state);
+  if (claimed) {
+    twi_state = state;
+  }
+  SREG = oldSREG;
+  return claimed;
+}
+
+/* 
+ * Function twi_kick
+ * Desc     starts the next queued transaction if the bus is free
+ * Input    none
+ * Output   none
+ */
+static void twi_kick(void)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  twi_startNext();
+  SREG = oldSREG;
+}
+
 /* 
  * Function twi_readFrom
  * Desc     attempts to become twi bus master and read a
@@ -167,18 +213,18 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
 
   // wait until twi is ready, become master receiver
   uint32_t startMicros = micros();
-  while(TWI_READY != twi_state){
+  while(!twi_claim(TWI_MRX)){
     if((twi_timeout_us > 0ul) && ((micros() - startMicros) > twi_timeout_us)) {
       twi_handleTimeout(twi_do_reset_on_timeout);
       return 0;
     }
   }
-  twi_state = TWI_MRX;
   twi_sendStop = sendStop;
   // reset error state (0xFF.. no error occured)
   twi_error = 0xFF;
 
   // initialize buffer iteration vars
+  twi_masterData = twi_masterBuffer;
   twi_masterBufferIndex = 0;
   twi_masterBufferLength = length-1;  // This is not intuitive, read on...
   // On receive, the previously configured ACK/NACK setting is transmitted in
@@ -231,6 +277,9 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
     data[i] = twi_masterBuffer[i];
   }
 
+  // transactions queued meanwhile waited for this one
+  twi_kick();
+
   return length;
 }
 
@@ -261,18 +310,18 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
 
   // wait until twi is ready, become master transmitter
   uint32_t startMicros = micros();
-  while(TWI_READY != twi_state){
+  while(!twi_claim(TWI_MTX)){
     if((twi_timeout_us > 0ul) && ((micros() - startMicros) > twi_timeout_us)) {
       twi_handleTimeout(twi_do_reset_on_timeout);
       return (5);
     }
   }
-  twi_state = TWI_MTX;
   twi_sendStop = sendStop;
   // reset error state (0xFF.. no error occured)
   twi_error = 0xFF;
 
   // initialize buffer iteration vars
+  twi_masterData = twi_masterBuffer;
   twi_masterBufferIndex = 0;
   twi_masterBufferLength = length;
   
@@ -319,11 +368,18 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
     }
   }
   
-  if (twi_error == 0xFF)
+  uint8_t error = twi_error;
+
+  // transactions queued meanwhile waited for this one
+  if (wait) {
+    twi_kick();
+  }
+
+  if (error == 0xFF)
     return 0;	// success
-  else if (twi_error == TW_MT_SLA_NACK)
+  else if (error == TW_MT_SLA_NACK)
     return 2;	// error: address send, nack received
-  else if (twi_error == TW_MT_DATA_NACK)
+  else if (error == TW_MT_DATA_NACK)
     return 3;	// error: data send, nack received
   else
     return 4;	// other twi error
@@ -429,7 +485,7 @@ void twi_stop(void)
   }
 
   // update twi state
-  twi_state = TWI_READY;
+  twi_setReady();
 }
 
 /* 
@@ -444,7 +500,7 @@ void twi_releaseBus(void)
   TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT);
 
   // update twi state
-  twi_state = TWI_READY;
+  twi_setReady();
 }
 
 /* 
@@ -482,6 +538,14 @@ void twi_handleTimeout(bool reset){
     // reapply the previous register values
     TWAR = previous_TWAR;
     TWBR = previous_TWBR;
+
+    // a queued transaction on the bus was cut off
+    uint8_t oldSREG = SREG;
+    cli();
+    if (twi_current) {
+      twi_finish(5);
+    }
+    SREG = oldSREG;
   }
 }
 
@@ -500,6 +564,149 @@ bool twi_manageTimeoutFlag(bool clear_flag){
   return(flag);
 }
 
+/* 
+ * Function twi_queue
+ * Desc     queues a master transaction and returns at once; it starts
+ *          when the bus is free, is run by the ISR and ends with its
+ *          status set and onComplete called. twi_init must have been
+ *          called. onComplete may queue further transactions.
+ * Input    transaction: address, buffers and callback filled in
+ * Output   0 .. queued
+ *          1 .. already queued
+ */
+uint8_t twi_queue(twi_transaction_t* transaction)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  if (TWI_PENDING == transaction->status) {
+    SREG = oldSREG;
+    return 1;
+  }
+  transaction->status = TWI_PENDING;
+  transaction->next = NULL;
+  if (twi_queueTail) {
+    twi_queueTail->next = transaction;
+  } else {
+    twi_queueHead = transaction;
+  }
+  twi_queueTail = transaction;
+  twi_startNext();
+  SREG = oldSREG;
+  return 0;
+}
+
+/* 
+ * Function twi_pollQueue
+ * Desc     call regularly while transactions are queued: starts one that
+ *          waited for a blocking call or slave transfer to finish, and
+ *          ends one that has taken longer than the timeout, resetting
+ *          the interface since nothing else would ever end it
+ * Input    none
+ * Output   none
+ */
+void twi_pollQueue(void)
+{
+  if (twi_current && (twi_timeout_us > 0ul) && ((micros() - twi_currentMicros) > twi_timeout_us)) {
+    twi_handleTimeout(true);
+  }
+  twi_kick();
+}
+
+/* 
+ * Function twi_setReady
+ * Desc     leaves master or slave mode; ends the queued transaction
+ *          that was on the bus, if any, and starts the next one
+ * Input    none
+ * Output   none
+ */
+static void twi_setReady(void)
+{
+  twi_state = TWI_READY;
+  if (twi_current) {
+    if (twi_error == 0xFF)
+      twi_finish(0);
+    else if ((twi_error == TW_MT_SLA_NACK) || (twi_error == TW_MR_SLA_NACK))
+      twi_finish(2);
+    else if (twi_error == TW_MT_DATA_NACK)
+      twi_finish(3);
+    else
+      twi_finish(4);
+  }
+}
+
+/* 
+ * Function twi_finish
+ * Desc     ends the queued transaction on the bus and starts the next
+ *          one, interrupts must be off
+ * Input    status: result, as from twi_writeTo
+ * Output   none
+ */
+static void twi_finish(uint8_t status)
+{
+  twi_transaction_t* transaction = twi_current;
+  void (*onComplete)(twi_transaction_t*) = transaction->onComplete;
+  twi_current = NULL;
+  // the owner may reuse the transaction as soon as status is set
+  transaction->status = status;
+  if (onComplete) {
+    onComplete(transaction);
+  }
+  twi_startNext();
+}
+
+/* 
+ * Function twi_startRead
+ * Desc     sets up the master receiver for a queued transaction
+ * Input    transaction: the transaction on the bus
+ * Output   none
+ */
+static void twi_startRead(twi_transaction_t* transaction)
+{
+  twi_state = TWI_MRX;
+  twi_masterData = transaction->rxData;
+  twi_masterBufferIndex = 0;
+  twi_masterBufferLength = transaction->rxLength - 1;  // see twi_readFrom
+  twi_slarw = TW_READ;
+  twi_slarw |= transaction->address << 1;
+}
+
+/* 
+ * Function twi_startNext
+ * Desc     starts the first queued transaction, unless the bus is in use
+ *          or held for a repeated start, interrupts must be off
+ * Input    none
+ * Output   none
+ */
+static void twi_startNext(void)
+{
+  twi_transaction_t* transaction = twi_queueHead;
+  if (!transaction || twi_current || (TWI_READY != twi_state) || twi_inRepStart) {
+    return;
+  }
+  twi_queueHead = transaction->next;
+  if (!twi_queueHead) {
+    twi_queueTail = NULL;
+  }
+  twi_current = transaction;
+  twi_currentMicros = micros();
+  twi_sendStop = true;
+  twi_error = 0xFF;
+
+  if (transaction->txLength || !transaction->rxLength) {
+    twi_state = TWI_MTX;
+    twi_masterData = (uint8_t*)transaction->txData;
+    twi_masterBufferIndex = 0;
+    twi_masterBufferLength = transaction->txLength;
+    twi_slarw = TW_WRITE;
+    twi_slarw |= transaction->address << 1;
+  } else {
+    twi_startRead(transaction);
+  }
+
+  // send start condition
+  TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA);
+}
+
 ISR(TWI_vect)
 {
   switch(TW_STATUS){
@@ -517,8 +724,12 @@ ISR(TWI_vect)
       // if there is data to send, send it, otherwise stop 
       if(twi_masterBufferIndex < twi_masterBufferLength){
         // copy data to output register and ack
-        TWDR = twi_masterBuffer[twi_masterBufferIndex++];
+        TWDR = twi_masterData[twi_masterBufferIndex++];
         twi_reply(1);
+      }else if (twi_current && twi_current->rxLength){
+        // queued write-then-read, turn around with a repeated start
+        twi_startRead(twi_current);
+        TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
       }else{
         if (twi_sendStop){
           twi_stop();
@@ -548,7 +759,7 @@ ISR(TWI_vect)
     // Master Receiver
     case TW_MR_DATA_ACK: // data received, ack sent
       // put byte into buffer
-      twi_masterBuffer[twi_masterBufferIndex++] = TWDR;
+      twi_masterData[twi_masterBufferIndex++] = TWDR;
       __attribute__ ((fallthrough));
     case TW_MR_SLA_ACK:  // address sent, ack received
       // ack if more bytes are expected, otherwise nack
@@ -560,7 +771,7 @@ ISR(TWI_vect)
       break;
     case TW_MR_DATA_NACK: // data received, nack sent
       // put final byte into buffer
-      twi_masterBuffer[twi_masterBufferIndex++] = TWDR;
+      twi_masterData[twi_masterBufferIndex++] = TWDR;
       if (twi_sendStop){
         twi_stop();
       } else {
@@ -573,6 +784,7 @@ ISR(TWI_vect)
       }
       break;
     case TW_MR_SLA_NACK: // address sent, nack received
+      twi_error = TW_MR_SLA_NACK;
       twi_stop();
       break;
     // TW_MR_ARB_LOST handled by TW_MT_ARB_LOST case
@@ -582,6 +794,10 @@ ISR(TWI_vect)
     case TW_SR_GCALL_ACK: // addressed generally, returned ack
     case TW_SR_ARB_LOST_SLA_ACK:   // lost arbitration, returned ack
     case TW_SR_ARB_LOST_GCALL_ACK: // lost arbitration, returned ack
+      // a queued transaction that lost arbitration ends with the slave transfer
+      if (twi_current) {
+        twi_error = TW_MT_ARB_LOST;
+      }
       // enter slave receiver mode
       twi_state = TWI_SRX;
       // indicate that rx buffer can be overwritten and ack
@@ -621,6 +837,10 @@ ISR(TWI_vect)
     // Slave Transmitter
     case TW_ST_SLA_ACK:          // addressed, returned ack
     case TW_ST_ARB_LOST_SLA_ACK: // arbitration lost, returned ack
+      // a queued transaction that lost arbitration ends with the slave transfer
+      if (twi_current) {
+        twi_error = TW_MT_ARB_LOST;
+      }
       // enter slave transmitter mode
       twi_state = TWI_STX;
       // ready the tx buffer index for iteration
@@ -652,7 +872,7 @@ ISR(TWI_vect)
       // ack future responses
       twi_reply(1);
       // leave slave receiver state
-      twi_state = TWI_READY;
+      twi_setReady();
       break;
 
     // All
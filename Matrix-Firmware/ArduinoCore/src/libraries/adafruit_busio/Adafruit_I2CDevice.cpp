@@ -247,6 +247,47 @@ bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
   return read(read_buffer, read_len);
 }
 
+#ifdef TWI_HAS_QUEUE
+/*!
+ *    @brief  Queue a write, then read, and return without waiting for it.
+ *    The read follows the write with a repeated start, and the transfer
+ *    ends with a STOP. Either part may be empty. Unlike the blocking
+ *    calls, neither is limited to maxBufferSize().
+ *    @param  transaction The transfer to fill in and queue, must not be
+ *    busy()
+ *    @param  write_buffer Pointer to buffer of data to write from
+ *    @param  write_len Number of bytes from buffer to write, up to 255
+ *    @param  read_buffer Pointer to buffer of data to read into
+ *    @param  read_len Number of bytes to read, up to 255
+ *    @param  callback Called from the I2C interrupt when the transfer has
+ *    completed or failed, or nullptr
+ *    @param  context Stored in transaction->context for the callback
+ *    @return True if queued, false if busy() or a length is too long
+ */
+bool Adafruit_I2CDevice::queue(Adafruit_I2CTransaction *transaction,
+                               const uint8_t *write_buffer, size_t write_len,
+                               uint8_t *read_buffer, size_t read_len,
+                               void (*callback)(Adafruit_I2CTransaction *),
+                               void *context) {
+  if ((write_len > 255) || (read_len > 255) || busy(transaction)) {
+    return false;
+  }
+  if (!_begun) {
+    _wire->begin();
+    _begun = true;
+  }
+
+  transaction->address = _addr;
+  transaction->txData = write_buffer;
+  transaction->txLength = write_len;
+  transaction->rxData = read_buffer;
+  transaction->rxLength = read_len;
+  transaction->onComplete = callback;
+  transaction->context = context;
+  return twi_queue(transaction) == 0;
+}
+#endif
+
 /*!
  *    @brief  Returns the 7-bit address of this device
  *    @return The 7-bit address of this device
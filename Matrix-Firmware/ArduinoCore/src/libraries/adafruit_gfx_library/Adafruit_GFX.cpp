@@ -117,8 +117,18 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
   wrap = true;
   _cp437 = false;
   gfxFont = NULL;
+  glyphCache = NULL;
+  glyphCacheSlots = glyphCacheUsed = glyphCacheLast = 0;
+  glyphCacheClock = 0;
 }
 
+/**************************************************************************/
+/*!
+   @brief    Free the glyph cache, if any
+*/
+/**************************************************************************/
+Adafruit_GFX::~Adafruit_GFX(void) { neoFree(glyphCache); }
+
 /**************************************************************************/
 /*!
    @brief    Write a line.  Bresenham's algorithm - thx wikpedia
@@ -191,6 +201,23 @@ void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
   drawPixel(x, y, color);
 }
 
+/**************************************************************************/
+/*!
+   @brief    Blend a color over the existing pixel, used for anti-aliased
+   fonts. Displays that can read back their pixels should override this;
+   the generic version can't, so it just draws pixels at least half covered.
+    @param   x      x coordinate
+    @param   y      y coordinate
+    @param   color  16-bit 5-6-5 Color to blend in
+    @param   alpha  Opacity of color, 0 (none) to 255 (replaces the pixel)
+*/
+/**************************************************************************/
+void Adafruit_GFX::writePixelBlend(int16_t x, int16_t y, uint16_t color,
+                                   uint8_t alpha) {
+  if (alpha >= 128)
+    writePixel(x, y, color);
+}
+
 /**************************************************************************/
 /*!
    @brief    Write a perfectly vertical line, overwrite in subclasses if
@@ -585,6 +612,162 @@ void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
   endWrite();
 }
 
+// Product of two 0-255 coverages, as a 0-255 alpha
+static uint8_t coverQ8(uint8_t a, uint8_t b) {
+  return ((uint16_t)a * b + 255) >> 8;
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw a point at a fractional position, spread bilinearly over
+            the (up to) four pixels around it with writePixelBlend(). Whole
+            coordinates light a single pixel, like drawPixel(). Integer
+            math only, so it's cheap enough for smooth motion on AVR.
+    @param    x   x coordinate, Q8.8 fixed point (pixels * 256)
+    @param    y   y coordinate, Q8.8 fixed point
+    @param    color 16-bit 5-6-5 Color to draw with
+*/
+/**************************************************************************/
+void Adafruit_GFX::drawPixelQ8(int16_t x, int16_t y, uint16_t color) {
+  drawPixelQ8(x, y, color, 0, 0, _width, _height);
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw a fractional point, leaving pixels outside a clip rectangle
+            alone (e.g. to repaint part of a scene)
+    @param    x   x coordinate, Q8.8 fixed point
+    @param    y   y coordinate, Q8.8 fixed point
+    @param    color 16-bit 5-6-5 Color to draw with
+    @param    cx  Clip rectangle left column
+    @param    cy  Clip rectangle top row
+    @param    cw  Clip rectangle width
+    @param    ch  Clip rectangle height
+*/
+/**************************************************************************/
+void Adafruit_GFX::drawPixelQ8(int16_t x, int16_t y, uint16_t color,
+                               int16_t cx, int16_t cy, int16_t cw,
+                               int16_t ch) {
+  int16_t px = x >> 8, py = y >> 8; // Pixel up and left of the point
+  uint8_t fx = x, fy = y;
+  uint8_t w[2][2] = {{coverQ8(255 - fx, 255 - fy), coverQ8(fx, 255 - fy)},
+                     {coverQ8(255 - fx, fy), coverQ8(fx, fy)}};
+  startWrite();
+  for (uint8_t j = 0; j < 2; j++) {
+    for (uint8_t i = 0; i < 2; i++) {
+      int16_t xx = px + i, yy = py + j;
+      if (w[j][i] && (xx >= cx) && (xx < cx + cw) && (yy >= cy) &&
+          (yy < cy + ch))
+        writePixelBlend(xx, yy, color, w[j][i]);
+    }
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw an anti-aliased line between fractional end points. The
+            ends are drawn like drawPixelQ8(), and each column (or row, for
+            steep lines) the ends don't touch gets one pixel's worth, split
+            between the two pixels the line passes between as in Xiaolin
+            Wu's algorithm.
+            Coordinates up to about +/-127 pixels.
+    @param    x0  Start point x coordinate, Q8.8 fixed point
+    @param    y0  Start point y coordinate, Q8.8 fixed point
+    @param    x1  End point x coordinate, Q8.8 fixed point
+    @param    y1  End point y coordinate, Q8.8 fixed point
+    @param    color 16-bit 5-6-5 Color to draw with
+*/
+/**************************************************************************/
+void Adafruit_GFX::drawLineQ8(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                              uint16_t color) {
+  startWrite();
+  drawPixelQ8(x0, y0, color);
+  drawPixelQ8(x1, y1, color);
+
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) { // Step along y, the longer axis
+    _swap_int16_t(x0, y0);
+    _swap_int16_t(x1, y1);
+  }
+  if (x0 > x1) {
+    _swap_int16_t(x0, x1);
+    _swap_int16_t(y0, y1);
+  }
+  int16_t dx = x1 - x0;
+  if (dx > 0) {
+    // Columns between the ends, clipped to the display. A fractional end
+    // also lights the column after its own, which is left to it
+    int16_t first = ((x0 + 255) >> 8) + 1, last = (x1 >> 8) - 1;
+    first = max(first, (int16_t)0);
+    last = min(last, (int16_t)((steep ? _height : _width) - 1));
+    // y in 16.16, stepping by the slope for each column
+    int32_t slope = ((int32_t)(y1 - y0) << 16) / dx;
+    int32_t yy = ((int32_t)y0 << 8) +
+                 (((int32_t)((first << 8) - x0) * slope) >> 8);
+    for (int16_t x = first; x <= last; x++, yy += slope) {
+      int16_t y = yy >> 16;
+      uint8_t f = yy >> 8;
+      if (steep) {
+        writePixelBlend(y, x, color, 255 - f);
+        if (f)
+          writePixelBlend(y + 1, x, color, f);
+      } else {
+        writePixelBlend(x, y, color, 255 - f);
+        if (f)
+          writePixelBlend(x, y + 1, color, f);
+      }
+    }
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Fill a rectangle with fractional edges. Whole pixels inside are
+            filled normally, the ones along the edges blended by how much
+            of them the rectangle covers. Whole coordinates fill the same
+            pixels as fillRect().
+    @param    x   Top left corner x coordinate, Q8.8 fixed point
+    @param    y   Top left corner y coordinate, Q8.8 fixed point
+    @param    w   Width, Q8.8 fixed point
+    @param    h   Height, Q8.8 fixed point
+    @param    color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void Adafruit_GFX::fillRectQ8(int16_t x, int16_t y, int16_t w, int16_t h,
+                              uint16_t color) {
+  if ((w <= 0) || (h <= 0))
+    return;
+  int16_t x1 = x + w, y1 = y + h; // Exclusive edges
+  // Pixels touched, and those entirely inside
+  int16_t c0 = x >> 8, c1 = (x1 - 1) >> 8, r0 = y >> 8, r1 = (y1 - 1) >> 8;
+  int16_t ic0 = (x + 255) >> 8, ic1 = x1 >> 8, ir0 = (y + 255) >> 8,
+          ir1 = y1 >> 8;
+
+  startWrite();
+  if ((ic1 > ic0) && (ir1 > ir0))
+    writeFillRect(ic0, ir0, ic1 - ic0, ir1 - ir0, color);
+  c0 = max(c0, (int16_t)0);
+  r0 = max(r0, (int16_t)0);
+  c1 = min(c1, (int16_t)(_width - 1));
+  r1 = min(r1, (int16_t)(_height - 1));
+  for (int16_t r = r0; r <= r1; r++) {
+    int16_t cy = min(y1, (int16_t)((r + 1) << 8)) - max(y, (int16_t)(r << 8));
+    bool rowInside = (r >= ir0) && (r < ir1);
+    for (int16_t c = c0; c <= c1; c++) {
+      if (rowInside && (c >= ic0) && (c < ic1))
+        continue; // Already filled
+      int16_t cx =
+          min(x1, (int16_t)((c + 1) << 8)) - max(x, (int16_t)(c << 8));
+      uint8_t a = coverQ8(min(cx, (int16_t)255), min(cy, (int16_t)255));
+      if (a)
+        writePixelBlend(c, r, color, a);
+    }
+  }
+  endWrite();
+}
+
 /**************************************************************************/
 /*!
    @brief   Draw a triangle with no fill color
@@ -1178,21 +1361,14 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     // newlines, returns, non-printable characters, etc.  Calling
     // drawChar() directly with 'bad' characters of font may cause mayhem!
 
-    c -= (uint8_t)pgm_read_byte(&gfxFont->first);
-    GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c);
+    GFXcachedGlyph tmp;
+    const GFXcachedGlyph *glyph = fetchGlyph(c, &tmp);
     uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
 
-    uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
-    uint8_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height);
-    int8_t xo = pgm_read_byte(&glyph->xOffset),
-           yo = pgm_read_byte(&glyph->yOffset);
+    uint16_t bo = glyph->bitmapOffset;
+    uint8_t w = glyph->width, h = glyph->height;
+    int8_t xo = glyph->xOffset, yo = glyph->yOffset;
     uint8_t xx, yy, bits = 0, bit = 0;
-    int16_t xo16 = 0, yo16 = 0;
-
-    if (size_x > 1 || size_y > 1) {
-      xo16 = xo;
-      yo16 = yo;
-    }
 
     // Todo: Add character clipping here
 
@@ -1212,22 +1388,48 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     // displays supporting setAddrWindow() and pushColors()), but haven't
     // implemented this yet.
 
+    uint8_t flags = pgm_read_byte(&gfxFont->flags);
+    if (flags & (GFX_FONT_RLE | GFX_FONT_AA)) {
+      startWrite();
+      if (flags & GFX_FONT_RLE)
+        writeRLEGlyph(x, y, glyph, color, size_x, size_y);
+      else
+        writeAAGlyph(x, y, glyph, color, size_x, size_y);
+      endWrite();
+      return;
+    }
+
+    // Set pixels are drawn in horizontal runs, one writeFastHLine() (or
+    // writeFillRect() when scaled) per run rather than one per pixel.
     startWrite();
     for (yy = 0; yy < h; yy++) {
+      uint16_t row = glyph->hasRows ? glyph->rows[yy] : 0;
+      if (glyph->hasRows && !row)
+        continue; // Blank row, nothing to draw
+      int16_t run = -1; // Start of the current run of set pixels, if any
       for (xx = 0; xx < w; xx++) {
-        if (!(bit++ & 7)) {
-          bits = pgm_read_byte(&bitmap[bo++]);
-        }
-        if (bits & 0x80) {
-          if (size_x == 1 && size_y == 1) {
-            writePixel(x + xo + xx, y + yo + yy, color);
-          } else {
-            writeFillRect(x + (xo16 + xx) * size_x, y + (yo16 + yy) * size_y,
-                          size_x, size_y, color);
+        bool set;
+        if (glyph->hasRows) {
+          set = row & 0x8000;
+          row <<= 1;
+        } else {
+          if (!(bit++ & 7)) {
+            bits = pgm_read_byte(&bitmap[bo++]);
           }
+          set = bits & 0x80;
+          bits <<= 1;
+        }
+        if (set) {
+          if (run < 0)
+            run = xx;
+        } else if (run >= 0) {
+          writeGlyphSpan(x, y, xo + run, yo + yy, xx - run, color, size_x,
+                         size_y);
+          run = -1;
         }
-        bits <<= 1;
       }
+      if (run >= 0)
+        writeGlyphSpan(x, y, xo + run, yo + yy, w - run, color, size_x, size_y);
     }
     endWrite();
 
@@ -1264,11 +1466,11 @@ size_t Adafruit_GFX::write(uint8_t c) {
     } else if (c != '\r') {
       uint8_t first = pgm_read_byte(&gfxFont->first);
       if ((c >= first) && (c <= (uint8_t)pgm_read_byte(&gfxFont->last))) {
-        GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c - first);
-        uint8_t w = pgm_read_byte(&glyph->width),
-                h = pgm_read_byte(&glyph->height);
+        GFXcachedGlyph tmp;
+        const GFXcachedGlyph *glyph = fetchGlyph(c, &tmp);
+        uint8_t w = glyph->width, h = glyph->height;
         if ((w > 0) && (h > 0)) { // Is there an associated bitmap?
-          int16_t xo = (int8_t)pgm_read_byte(&glyph->xOffset); // sic
+          int16_t xo = glyph->xOffset; // sic
           if (wrap && ((cursor_x + textsize_x * (xo + w)) > _width)) {
             cursor_x = 0;
             cursor_y += (int16_t)textsize_y *
@@ -1277,8 +1479,7 @@ size_t Adafruit_GFX::write(uint8_t c) {
           drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
                    textsize_y);
         }
-        cursor_x +=
-            (uint8_t)pgm_read_byte(&glyph->xAdvance) * (int16_t)textsize_x;
+        cursor_x += glyph->xAdvance * (int16_t)textsize_x;
       }
     }
   }
@@ -1348,6 +1549,255 @@ void Adafruit_GFX::setFont(const GFXfont *f) {
     cursor_y -= 6;
   }
   gfxFont = (GFXfont *)f;
+  glyphCacheUsed = 0; // Cached glyphs belong to the old font
+}
+
+/**************************************************************************/
+/*!
+    @brief  Keep recently used custom font glyphs decoded in RAM. Repeated
+            characters then skip the PROGMEM reads and bit unpacking in
+            drawChar(), write() and getTextBounds(). Each slot takes
+            sizeof(GFXcachedGlyph) bytes (27 with the default
+            GFX_GLYPH_CACHE_ROWS of 8); bitmaps of glyphs wider than 16 or
+            taller than GFX_GLYPH_CACHE_ROWS pixels are still read from
+            PROGMEM, only their metrics are cached.
+    @param  slots  Number of glyphs to keep, least recently used ones are
+                   replaced first. 0 turns the cache off and frees it.
+    @return true on success, false if the cache could not be allocated
+            (it is off then).
+*/
+/**************************************************************************/
+bool Adafruit_GFX::setGlyphCache(uint8_t slots) {
+  neoFree(glyphCache);
+  glyphCache = NULL;
+  glyphCacheSlots = glyphCacheUsed = 0;
+  if (!slots)
+    return true;
+  if (!(glyphCache =
+            (GFXcachedGlyph *)neoAlloc(slots * sizeof(GFXcachedGlyph))))
+    return false;
+  glyphCacheSlots = slots;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Look up a custom font glyph, decoding it into the glyph cache
+            on a miss.
+    @param  c    The character, must be within the current font's range
+    @param  tmp  Scratch glyph, receives the metrics when there is no cache
+    @return The cache entry, or tmp (without rows) if the cache is off
+*/
+/**************************************************************************/
+const GFXcachedGlyph *Adafruit_GFX::fetchGlyph(uint8_t c,
+                                               GFXcachedGlyph *tmp) {
+  GFXcachedGlyph *e = tmp;
+  if (glyphCache) {
+    uint8_t i = glyphCacheLast;
+    glyphCacheClock++;
+    // write() and drawChar() look up the same character back to back,
+    // so try the last hit before scanning
+    if ((i >= glyphCacheUsed) || (glyphCache[i].c != c)) {
+      for (i = 0; (i < glyphCacheUsed) && (glyphCache[i].c != c); i++)
+        ;
+    }
+    if (i < glyphCacheUsed) {
+      glyphCacheLast = i;
+      glyphCache[i].stamp = glyphCacheClock;
+      return &glyphCache[i];
+    }
+    // Miss: take a free slot, else replace the least recently used one
+    if (glyphCacheUsed < glyphCacheSlots) {
+      i = glyphCacheUsed++;
+    } else {
+      uint8_t oldest = 0;
+      for (i = 1; i < glyphCacheSlots; i++) {
+        if ((uint16_t)(glyphCacheClock - glyphCache[i].stamp) >
+            (uint16_t)(glyphCacheClock - glyphCache[oldest].stamp))
+          oldest = i;
+      }
+      i = oldest;
+    }
+    glyphCacheLast = i;
+    e = &glyphCache[i];
+    e->stamp = glyphCacheClock;
+  }
+
+  GFXglyph *glyph =
+      pgm_read_glyph_ptr(gfxFont, c - (uint8_t)pgm_read_byte(&gfxFont->first));
+  e->c = c;
+  e->bitmapOffset = pgm_read_word(&glyph->bitmapOffset);
+  e->width = pgm_read_byte(&glyph->width);
+  e->height = pgm_read_byte(&glyph->height);
+  e->xAdvance = pgm_read_byte(&glyph->xAdvance);
+  e->xOffset = pgm_read_byte(&glyph->xOffset);
+  e->yOffset = pgm_read_byte(&glyph->yOffset);
+  // Only classic 1 bit/pixel bitmaps are cached, other formats just get
+  // their metrics cached
+  e->hasRows = (e != tmp) && (e->width <= 16) &&
+               (e->height <= GFX_GLYPH_CACHE_ROWS) &&
+               !pgm_read_byte(&gfxFont->flags);
+  if (e->hasRows) {
+    uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
+    uint16_t bo = e->bitmapOffset;
+    uint8_t bits = 0, bit = 0;
+    for (uint8_t yy = 0; yy < e->height; yy++) {
+      uint16_t row = 0;
+      for (uint8_t xx = 0; xx < e->width; xx++) {
+        if (!(bit++ & 7)) {
+          bits = pgm_read_byte(&bitmap[bo++]);
+        }
+        if (bits & 0x80)
+          row |= 0x8000 >> xx;
+        bits <<= 1;
+      }
+      e->rows[yy] = row;
+    }
+  }
+  return e;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw an anti-aliased custom font glyph (GFX_FONT_2BPP or
+            GFX_FONT_4BPP). Fully covered pixels are drawn in spans like
+            classic glyphs, partly covered ones go through
+            writePixelBlend(). Call within startWrite()/endWrite().
+    @param  x       Character origin x coordinate
+    @param  y       Character origin y coordinate
+    @param  glyph   The glyph, from fetchGlyph()
+    @param  color   16-bit 5-6-5 Color to draw with
+    @param  size_x  Font magnification level in X-axis
+    @param  size_y  Font magnification level in Y-axis
+*/
+/**************************************************************************/
+void Adafruit_GFX::writeAAGlyph(int16_t x, int16_t y,
+                                const GFXcachedGlyph *glyph, uint16_t color,
+                                uint8_t size_x, uint8_t size_y) {
+  uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t bpp = (pgm_read_byte(&gfxFont->flags) & GFX_FONT_4BPP) ? 4 : 2,
+          full = (1 << bpp) - 1, step = 255 / full, bits = 0, left = 0;
+  int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+
+  for (uint8_t yy = 0; yy < glyph->height; yy++) {
+    int16_t run = -1; // Start of the current run of fully covered pixels
+    for (uint8_t xx = 0; xx < glyph->width; xx++) {
+      if (!left) {
+        bits = pgm_read_byte(&bitmap[bo++]);
+        left = 8;
+      }
+      uint8_t v = bits >> (8 - bpp);
+      bits <<= bpp;
+      left -= bpp;
+      if (v == full) {
+        if (run < 0)
+          run = xx;
+        continue;
+      }
+      if (run >= 0) {
+        writeGlyphSpan(x, y, xo + run, yo + yy, xx - run, color, size_x,
+                       size_y);
+        run = -1;
+      }
+      if (v) {
+        int16_t px = x + (xo + xx) * size_x, py = y + (yo + yy) * size_y;
+        for (uint8_t j = 0; j < size_y; j++)
+          for (uint8_t i = 0; i < size_x; i++)
+            writePixelBlend(px + i, py + j, color, v * step);
+      }
+    }
+    if (run >= 0)
+      writeGlyphSpan(x, y, xo + run, yo + yy, glyph->width - run, color,
+                     size_x, size_y);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a run-length encoded custom font glyph (GFX_FONT_RLE).
+            Set runs go straight to writeGlyphSpan(), split where they
+            wrap to the next row. Call within startWrite()/endWrite().
+    @param  x       Character origin x coordinate
+    @param  y       Character origin y coordinate
+    @param  glyph   The glyph, from fetchGlyph()
+    @param  color   16-bit 5-6-5 Color to draw with
+    @param  size_x  Font magnification level in X-axis
+    @param  size_y  Font magnification level in Y-axis
+*/
+/**************************************************************************/
+void Adafruit_GFX::writeRLEGlyph(int16_t x, int16_t y,
+                                 const GFXcachedGlyph *glyph, uint16_t color,
+                                 uint8_t size_x, uint8_t size_y) {
+  uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t w = glyph->width, bits = 0, xx = 0, yy = 0;
+  uint16_t left = w * glyph->height; // Pixels still to decode
+  bool set = false, lo = false;
+
+  while (left) {
+    uint16_t n = 0;
+    uint8_t v;
+    do { // Read one run, 15 means more nibbles follow
+      if (lo) {
+        v = bits & 0x0F;
+      } else {
+        bits = pgm_read_byte(&bitmap[bo++]);
+        v = bits >> 4;
+      }
+      lo = !lo;
+      n += v;
+    } while (v == 15);
+
+    if (set) {
+      n++; // Set runs are stored as length - 1
+    } else if (!n && (xx || yy)) {
+      break; // End marker, rest of the glyph is unset
+    }
+    if (n > left)
+      n = left; // Corrupt data, don't run past the glyph
+    left -= n;
+
+    while (n) {
+      uint8_t len = (n < (uint16_t)(w - xx)) ? n : (w - xx);
+      if (set)
+        writeGlyphSpan(x, y, glyph->xOffset + xx, glyph->yOffset + yy, len,
+                       color, size_x, size_y);
+      n -= len;
+      if ((xx += len) >= w) {
+        xx = 0;
+        yy++;
+      }
+    }
+    set = !set;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw one horizontal run of a custom font glyph's pixels.
+    @param  x       Character origin x coordinate
+    @param  y       Character origin y coordinate
+    @param  xx      Run start, in font pixels from the origin
+    @param  yy      Run row, in font pixels from the origin
+    @param  len     Run length in font pixels
+    @param  color   16-bit 5-6-5 Color to draw with
+    @param  size_x  Font magnification level in X-axis
+    @param  size_y  Font magnification level in Y-axis
+*/
+/**************************************************************************/
+void Adafruit_GFX::writeGlyphSpan(int16_t x, int16_t y, int16_t xx, int16_t yy,
+                                  uint8_t len, uint16_t color, uint8_t size_x,
+                                  uint8_t size_y) {
+  if (size_x == 1 && size_y == 1) {
+    if (len == 1)
+      writePixel(x + xx, y + yy, color);
+    else
+      writeFastHLine(x + xx, y + yy, len, color);
+  } else {
+    writeFillRect(x + xx * size_x, y + yy * size_y, len * size_x, size_y,
+                  color);
+  }
 }
 
 /**************************************************************************/
@@ -1381,12 +1831,10 @@ void Adafruit_GFX::charBounds(unsigned char c, int16_t *x, int16_t *y,
       uint8_t first = pgm_read_byte(&gfxFont->first),
               last = pgm_read_byte(&gfxFont->last);
       if ((c >= first) && (c <= last)) { // Char present in this font?
-        GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c - first);
-        uint8_t gw = pgm_read_byte(&glyph->width),
-                gh = pgm_read_byte(&glyph->height),
-                xa = pgm_read_byte(&glyph->xAdvance);
-        int8_t xo = pgm_read_byte(&glyph->xOffset),
-               yo = pgm_read_byte(&glyph->yOffset);
+        GFXcachedGlyph tmp;
+        const GFXcachedGlyph *glyph = fetchGlyph(c, &tmp);
+        uint8_t gw = glyph->width, gh = glyph->height, xa = glyph->xAdvance;
+        int8_t xo = glyph->xOffset, yo = glyph->yOffset;
         if (wrap && ((*x + (((int16_t)xo + gw) * textsize_x)) > _width)) {
           *x = 0; // Reset x to zero, advance y by one line
           *y += textsize_y * (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
@@ -1762,7 +2210,7 @@ const uint8_t PROGMEM GFXcanvas1::GFXclrBit[] = {0x7F, 0xBF, 0xDF, 0xEF,
 /**************************************************************************/
 GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
   uint16_t bytes = ((w + 7) / 8) * h;
-  if ((buffer = (uint8_t *)malloc(bytes))) {
+  if ((buffer = (uint8_t *)neoAlloc(bytes))) {
     memset(buffer, 0, bytes);
   }
 }
@@ -1773,8 +2221,7 @@ GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
 */
 /**************************************************************************/
 GFXcanvas1::~GFXcanvas1(void) {
-  if (buffer)
-    free(buffer);
+  neoFree(buffer);
 }
 
 /**************************************************************************/
@@ -2115,7 +2562,7 @@ void GFXcanvas1::drawFastRawHLine(int16_t x, int16_t y, int16_t w,
 /**************************************************************************/
 GFXcanvas8::GFXcanvas8(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
   uint32_t bytes = w * h;
-  if ((buffer = (uint8_t *)malloc(bytes))) {
+  if ((buffer = (uint8_t *)neoAlloc(bytes))) {
     memset(buffer, 0, bytes);
   }
 }
@@ -2126,8 +2573,7 @@ GFXcanvas8::GFXcanvas8(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
 */
 /**************************************************************************/
 GFXcanvas8::~GFXcanvas8(void) {
-  if (buffer)
-    free(buffer);
+  neoFree(buffer);
 }
 
 /**************************************************************************/
@@ -2383,7 +2829,7 @@ void GFXcanvas8::drawFastRawHLine(int16_t x, int16_t y, int16_t w,
 /**************************************************************************/
 GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
   uint32_t bytes = w * h * 2;
-  if ((buffer = (uint16_t *)malloc(bytes))) {
+  if ((buffer = (uint16_t *)neoAlloc(bytes))) {
     memset(buffer, 0, bytes);
   }
 }
@@ -2394,8 +2840,7 @@ GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
 */
 /**************************************************************************/
 GFXcanvas16::~GFXcanvas16(void) {
-  if (buffer)
-    free(buffer);
+  neoFree(buffer);
 }
 
 /**************************************************************************/
@@ -2667,3 +3112,307 @@ void GFXcanvas16::drawFastRawHLine(int16_t x, int16_t y, int16_t w,
     buffer[i] = color;
   }
 }
+
+/**************************************************************************/
+/*!
+   @brief    Instatiate a GFX 24-bit canvas context for graphics. Pixels
+             are stored 3 bytes each in the byte order of a NeoPixel strip,
+             so Adafruit_NeoMatrix can copy them out without converting.
+   @param    w      Display width, in pixels
+   @param    h      Display height, in pixels
+   @param    order  Color order as in NeoPixel type flags (e.g. NEO_GRB);
+                    only the red, green and blue offsets are used. Defaults
+                    to NEO_RGB.
+*/
+/**************************************************************************/
+GFXcanvas24::GFXcanvas24(uint16_t w, uint16_t h, uint8_t order)
+    : Adafruit_GFX(w, h), order(order), expander(NULL) {
+  rOffset = (order >> 4) & 3;
+  gOffset = (order >> 2) & 3;
+  bOffset = order & 3;
+  uint32_t bytes = (uint32_t)w * h * 3;
+  if ((buffer = (uint8_t *)neoAlloc(bytes))) {
+    memset(buffer, 0, bytes);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief    Delete the canvas, free memory
+*/
+/**************************************************************************/
+GFXcanvas24::~GFXcanvas24(void) {
+  neoFree(buffer);
+}
+
+/**************************************************************************/
+/*!
+   @brief    Set how 16-bit colors given to the GFX drawing functions are
+             widened to 24 bits. By default the bits are replicated, e.g.
+             0xFFFF becomes 0xFFFFFF; pass Adafruit_NeoMatrix::expandColor
+             to match what the matrix itself draws, gamma included.
+   @param    fn  Conversion function, or NULL for the default
+*/
+/**************************************************************************/
+void GFXcanvas24::setColorExpander(uint32_t (*fn)(uint16_t)) {
+  expander = fn;
+}
+
+/**************************************************************************/
+/*!
+   @brief    Widen a 16-bit 5-6-5 color to 24-bit 0xRRGGBB
+   @param    color  16-bit 5-6-5 Color
+   @returns  24-bit color
+*/
+/**************************************************************************/
+uint32_t GFXcanvas24::expand(uint16_t color) const {
+  if (expander)
+    return expander(color);
+  uint8_t r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+  return ((uint32_t)((r << 3) | (r >> 2)) << 16) |
+         ((uint16_t)((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a pixel to the canvas framebuffer
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color 16-bit 5-6-5 Color to draw with
+*/
+/**************************************************************************/
+void GFXcanvas24::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixelRGB(x, y, expand(color));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a pixel to the canvas framebuffer in full color
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color 24-bit 0xRRGGBB Color to draw with
+*/
+/**************************************************************************/
+void GFXcanvas24::drawPixelRGB(int16_t x, int16_t y, uint32_t color) {
+  if (buffer) {
+    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+      return;
+
+    int16_t t;
+    switch (rotation) {
+    case 1:
+      t = x;
+      x = WIDTH - 1 - y;
+      y = t;
+      break;
+    case 2:
+      x = WIDTH - 1 - x;
+      y = HEIGHT - 1 - y;
+      break;
+    case 3:
+      t = x;
+      x = y;
+      y = HEIGHT - 1 - t;
+      break;
+    }
+
+    uint8_t *p = &buffer[(x + y * WIDTH) * 3];
+    p[rOffset] = color >> 16;
+    p[gOffset] = color >> 8;
+    p[bOffset] = color;
+  }
+}
+
+/**********************************************************************/
+/*!
+        @brief    Get the pixel color value at a given coordinate
+        @param    x   x coordinate
+        @param    y   y coordinate
+        @returns  The desired pixel's 24-bit 0xRRGGBB color value
+*/
+/**********************************************************************/
+uint32_t GFXcanvas24::getPixelRGB(int16_t x, int16_t y) const {
+  if (!buffer || (x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    return 0;
+  int16_t t;
+  switch (rotation) {
+  case 1:
+    t = x;
+    x = WIDTH - 1 - y;
+    y = t;
+    break;
+  case 2:
+    x = WIDTH - 1 - x;
+    y = HEIGHT - 1 - y;
+    break;
+  case 3:
+    t = x;
+    x = y;
+    y = HEIGHT - 1 - t;
+    break;
+  }
+  const uint8_t *p = &buffer[(x + y * WIDTH) * 3];
+  return ((uint32_t)p[rOffset] << 16) | ((uint16_t)p[gOffset] << 8) |
+         p[bOffset];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill the framebuffer completely with one color
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas24::fillScreen(uint16_t color) { fillScreenRGB(expand(color)); }
+
+/**************************************************************************/
+/*!
+    @brief  Fill the framebuffer completely with one color
+    @param  color 24-bit 0xRRGGBB Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas24::fillScreenRGB(uint32_t color) {
+  if (buffer) {
+    uint8_t r = color >> 16, g = color >> 8, b = color;
+    if ((r == g) && (g == b)) {
+      memset(buffer, r, (uint32_t)WIDTH * HEIGHT * 3);
+    } else {
+      fillRawRect(0, 0, WIDTH, HEIGHT, color);
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief    Speed optimized vertical line drawing
+   @param    x   Line horizontal start point
+   @param    y   Line vertical start point
+   @param    h   length of vertical line to be drawn, including first point
+   @param    color   color 16-bit 5-6-5 Color to draw line with
+*/
+/**************************************************************************/
+void GFXcanvas24::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                uint16_t color) {
+  if (h < 0) { // Convert negative heights to positive equivalent
+    y += h + 1;
+    h = -h;
+  }
+  fillRectRGB(x, y, 1, h, expand(color));
+}
+
+/**************************************************************************/
+/*!
+   @brief  Speed optimized horizontal line drawing
+   @param  x      Line horizontal start point
+   @param  y      Line vertical start point
+   @param  w      Length of horizontal line to be drawn, including 1st point
+   @param  color  Color 16-bit 5-6-5 Color to draw line with
+*/
+/**************************************************************************/
+void GFXcanvas24::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                uint16_t color) {
+  if (w < 0) { // Convert negative widths to positive equivalent
+    x += w + 1;
+    w = -w;
+  }
+  fillRectRGB(x, y, w, 1, expand(color));
+}
+
+/**************************************************************************/
+/*!
+   @brief    Speed optimized rectangle fill
+   @param    x   Top left corner x coordinate
+   @param    y   Top left corner y coordinate
+   @param    w   Width in pixels
+   @param    h   Height in pixels
+   @param    color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas24::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                           uint16_t color) {
+  fillRectRGB(x, y, w, h, expand(color));
+}
+
+/**************************************************************************/
+/*!
+   @brief    Fill a rectangle in full color, clipped to the canvas
+   @param    x   Top left corner x coordinate
+   @param    y   Top left corner y coordinate
+   @param    w   Width in pixels
+   @param    h   Height in pixels
+   @param    color 24-bit 0xRRGGBB Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas24::fillRectRGB(int16_t x, int16_t y, int16_t w, int16_t h,
+                              uint32_t color) {
+  if (!buffer)
+    return;
+  if (x < 0) { // Clip left
+    w += x;
+    x = 0;
+  }
+  if (y < 0) { // Clip top
+    h += y;
+    y = 0;
+  }
+  if (x + w > _width) // Clip right
+    w = _width - x;
+  if (y + h > _height) // Clip bottom
+    h = _height - y;
+  if ((w <= 0) || (h <= 0))
+    return;
+
+  // Same rectangle in raw (rotation 0) coordinates
+  int16_t t;
+  switch (rotation) {
+  case 1:
+    t = x;
+    x = WIDTH - y - h;
+    y = t;
+    t = w;
+    w = h;
+    h = t;
+    break;
+  case 2:
+    x = WIDTH - x - w;
+    y = HEIGHT - y - h;
+    break;
+  case 3:
+    t = x;
+    x = y;
+    y = HEIGHT - t - w;
+    t = w;
+    w = h;
+    h = t;
+    break;
+  }
+  fillRawRect(x, y, w, h, color);
+}
+
+/**************************************************************************/
+/*!
+   @brief    Fill a rectangle of the raw canvas buffer, already clipped and
+             in raw (rotation 0) coordinates. The first pixel is built
+             once and copied along each row.
+   @param    x   Top left corner x coordinate
+   @param    y   Top left corner y coordinate
+   @param    w   Width in pixels
+   @param    h   Height in pixels
+   @param    color 24-bit 0xRRGGBB Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas24::fillRawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                              uint32_t color) {
+  uint8_t px[3];
+  px[rOffset] = color >> 16;
+  px[gOffset] = color >> 8;
+  px[bOffset] = color;
+  uint8_t *row = &buffer[((uint32_t)y * WIDTH + x) * 3];
+  for (int16_t j = 0; j < h; j++, row += WIDTH * 3) {
+    uint8_t *p = row;
+    for (int16_t i = 0; i < w; i++) {
+      *p++ = px[0];
+      *p++ = px[1];
+      *p++ = px[2];
+    }
+  }
+}
@@ -8,6 +8,15 @@ fonts to be used with the Adafruit_GFX Arduino library.
 For UNIX-like systems.  Outputs to stdout; redirect to header file, e.g.:
   ./fontconvert ~/Library/Fonts/FreeSans.ttf 18 > FreeSans18pt7b.h
 
+With -r, glyph bitmaps are run-length encoded (GFX_FONT_RLE, format
+described in gfxfont.h).  Saves about a third of the bitmap size at 18pt
+and up, but small pixel fonts come out bigger; the output comment lists
+both sizes.
+
+With -a 2 or -a 4, glyphs keep FreeType's grayscale coverage at 2 or 4
+bits per pixel (GFX_FONT_2BPP / GFX_FONT_4BPP) for anti-aliased text.
+Makes the bitmaps 2 or 4 times larger.
+
 REQUIRES FREETYPE LIBRARY.  www.freetype.org
 
 Currently this only extracts the printable 7-bit ASCII chars of a font.
@@ -29,29 +38,112 @@ See notes at end for glyph nomenclature & other tidbits.
 
 #define DPI 141 // Approximate res. of Adafruit 2.8" TFT
 
+// Write one hexadecimal byte of the bitmap table
+void enbyte(uint8_t value) {
+  static uint8_t row = 0, firstCall = 1;
+  if (!firstCall) {    // Format output table nicely
+    if (++row >= 12) { // Last entry on line?
+      printf(",\n  "); //   Newline format output
+      row = 0;         //   Reset row counter
+    } else {           // Not end of line
+      printf(", ");    //   Simple comma delim
+    }
+  }
+  printf("0x%02X", value); // Write byte value
+  firstCall = 0;           // Formatting flag
+}
+
 // Accumulate bits for output, with periodic hexadecimal byte write
 void enbit(uint8_t value) {
-  static uint8_t row = 0, sum = 0, bit = 0x80, firstCall = 1;
+  static uint8_t sum = 0, bit = 0x80;
   if (value)
-    sum |= bit;          // Set bit if needed
-  if (!(bit >>= 1)) {    // Advance to next bit, end of byte reached?
-    if (!firstCall) {    // Format output table nicely
-      if (++row >= 12) { // Last entry on line?
-        printf(",\n  "); //   Newline format output
-        row = 0;         //   Reset row counter
-      } else {           // Not end of line
-        printf(", ");    //   Simple comma delim
+    sum |= bit;       // Set bit if needed
+  if (!(bit >>= 1)) { // Advance to next bit, end of byte reached?
+    enbyte(sum);      // Write byte value
+    sum = 0;          // Clear for next byte
+    bit = 0x80;       // Reset bit counter
+  }
+}
+
+// Accumulate the top n bits of value (MSB first) for output
+void enbits(uint8_t value, uint8_t n) {
+  while (n--) {
+    enbit(value & 0x80);
+    value <<= 1;
+  }
+}
+
+// Accumulate 4-bit values for output, high nibble first.  Returns the
+// number of bytes written; flush (value ignored) pads out the last byte.
+int ennibble(uint8_t value, uint8_t flush) {
+  static uint8_t sum = 0, hi = 1;
+  if (flush) {
+    if (hi)
+      return 0;
+    hi = 1;
+  } else if (hi) {
+    sum = value << 4;
+    hi = 0;
+    return 0;
+  } else {
+    sum |= value;
+    hi = 1;
+  }
+  enbyte(sum);
+  return 1;
+}
+
+// Write one run of an RLE glyph, 15 = "add 15 and keep reading"
+int enrun(int n) {
+  int bytes = 0;
+  while (n >= 15) {
+    bytes += ennibble(15, 0);
+    n -= 15;
+  }
+  return bytes + ennibble(n, 0);
+}
+
+// Run-length encode one glyph bitmap (see gfxfont.h for the format).
+// Returns the number of bytes written.
+int enrle(FT_Bitmap *bitmap) {
+  int x, y, run = 0, bytes = 0, total = bitmap->width * bitmap->rows,
+            lastSet = -1, pos = 0;
+  uint8_t set = 0, px;
+
+  // Find the last set pixel; the unset run after it becomes an end marker
+  for (y = 0; y < bitmap->rows; y++)
+    for (x = 0; x < bitmap->width; x++)
+      if (bitmap->buffer[y * bitmap->pitch + x / 8] & (0x80 >> (x & 7)))
+        lastSet = y * bitmap->width + x;
+
+  if (lastSet < 0) { // Nothing set, one unset run covers it all
+    bytes += total ? enrun(total) : 0;
+    return bytes + ennibble(0, 1);
+  }
+
+  for (y = 0; y < bitmap->rows; y++) {
+    for (x = 0; x < bitmap->width; x++, pos++) {
+      px = (bitmap->buffer[y * bitmap->pitch + x / 8] & (0x80 >> (x & 7))) != 0;
+      if (px != set) {
+        bytes += enrun(set ? run - 1 : run);
+        set = px;
+        run = 0;
+      }
+      run++;
+      if (pos == lastSet) {
+        bytes += enrun(run - 1);     // Final set run
+        if (pos < total - 1)         // Unset pixels left over?
+          bytes += ennibble(0, 0);   // End marker
+        return bytes + ennibble(0, 1);
       }
     }
-    printf("0x%02X", sum); // Write byte value
-    sum = 0;               // Clear for next byte
-    bit = 0x80;            // Reset bit counter
-    firstCall = 0;         // Formatting flag
   }
+  return bytes; // Not reached
 }
 
 int main(int argc, char *argv[]) {
-  int i, j, err, size, first = ' ', last = '~', bitmapOffset = 0, x, y, byte;
+  int i, j, err, size, first = ' ', last = '~', bitmapOffset = 0, x, y, byte,
+      rle = 0, aa = 0, packedSize = 0;
   char *fontName, c, *ptr;
   FT_Library library;
   FT_Face face;
@@ -62,14 +154,29 @@ int main(int argc, char *argv[]) {
   uint8_t bit;
 
   // Parse command line.  Valid syntaxes are:
-  //   fontconvert [filename] [size]
-  //   fontconvert [filename] [size] [last char]
-  //   fontconvert [filename] [size] [first char] [last char]
+  //   fontconvert [-r | -a bpp] [filename] [size]
+  //   fontconvert [-r | -a bpp] [filename] [size] [last char]
+  //   fontconvert [-r | -a bpp] [filename] [size] [first char] [last char]
   // Unless overridden, default first and last chars are
   // ' ' (space) and '~', respectively
 
+  if ((argc > 1) && !strcmp(argv[1], "-r")) { // RLE bitmaps
+    rle = 1;
+    argc--;
+    argv++;
+  } else if ((argc > 2) && !strcmp(argv[1], "-a")) { // Anti-aliased
+    aa = atoi(argv[2]);
+    argc -= 2;
+    argv += 2;
+    if ((aa != 2) && (aa != 4)) {
+      fprintf(stderr, "Anti-aliased fonts are 2 or 4 bits per pixel\n");
+      return 1;
+    }
+  }
+
   if (argc < 3) {
-    fprintf(stderr, "Usage: %s fontfile size [first] [last]\n", argv[0]);
+    fprintf(stderr, "Usage: %s [-r | -a 2|4] fontfile size [first] [last]\n",
+            argv[0]);
     return 1;
   }
 
@@ -123,8 +230,8 @@ int main(int argc, char *argv[]) {
   }
 
   // Use TrueType engine version 35, without subpixel rendering.
-  // This improves clarity of fonts since this library does not
-  // support rendering multiple levels of gray in a glyph.
+  // This improves clarity of fonts, also the anti-aliased ones since
+  // the library blends one coverage value per pixel, not per subpixel.
   // See https://github.com/adafruit/Adafruit-GFX-Library/issues/103
   FT_UInt interpreter_version = TT_INTERPRETER_VERSION_35;
   FT_Property_Set(library, "truetype", "interpreter-version",
@@ -150,13 +257,16 @@ int main(int argc, char *argv[]) {
   // Process glyphs and output huge bitmap data array
   for (i = first, j = 0; i <= last; i++, j++) {
     // MONO renderer provides clean image with perfect crop
-    // (no wasted pixels) via bitmap struct.
-    if ((err = FT_Load_Char(face, i, FT_LOAD_TARGET_MONO))) {
+    // (no wasted pixels) via bitmap struct.  NORMAL gives the same
+    // with 8-bit coverage per pixel, for anti-aliased output.
+    if ((err = FT_Load_Char(face, i,
+                            aa ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO))) {
       fprintf(stderr, "Error %d loading char '%c'\n", err, i);
       continue;
     }
 
-    if ((err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO))) {
+    if ((err = FT_Render_Glyph(face->glyph, aa ? FT_RENDER_MODE_NORMAL
+                                               : FT_RENDER_MODE_MONO))) {
       fprintf(stderr, "Error %d rendering char '%c'\n", err, i);
       continue;
     }
@@ -184,6 +294,29 @@ int main(int argc, char *argv[]) {
     table[j].xOffset = g->left;
     table[j].yOffset = 1 - g->top;
 
+    if (aa) {
+      int max = (1 << aa) - 1, n = bitmap->width * bitmap->rows * aa;
+      for (y = 0; y < bitmap->rows; y++) {
+        for (x = 0; x < bitmap->width; x++) {
+          // Round 0-255 coverage to 0-max, kept in the top aa bits
+          int v = (bitmap->buffer[y * bitmap->pitch + x] * max + 127) / 255;
+          enbits(v << (8 - aa), aa);
+        }
+      }
+      for (n = (8 - (n & 7)) & 7; n--;) // Pad to next byte boundary
+        enbit(0);
+      bitmapOffset += (bitmap->width * bitmap->rows * aa + 7) / 8;
+      FT_Done_Glyph(glyph);
+      continue;
+    }
+
+    packedSize += (bitmap->width * bitmap->rows + 7) / 8;
+    if (rle) {
+      bitmapOffset += enrle(bitmap);
+      FT_Done_Glyph(glyph);
+      continue;
+    }
+
     for (y = 0; y < bitmap->rows; y++) {
       for (x = 0; x < bitmap->width; x++) {
         byte = x / 8;
@@ -231,12 +364,24 @@ int main(int argc, char *argv[]) {
   printf("  (GFXglyph *)%sGlyphs,\n", fontName);
   if (face->size->metrics.height == 0) {
     // No face height info, assume fixed width and get from a glyph.
-    printf("  0x%02X, 0x%02X, %d };\n\n", first, last, table[0].height);
+    printf("  0x%02X, 0x%02X, %d", first, last, table[0].height);
   } else {
-    printf("  0x%02X, 0x%02X, %ld };\n\n", first, last,
+    printf("  0x%02X, 0x%02X, %ld", first, last,
            face->size->metrics.height >> 6);
   }
-  printf("// Approx. %d bytes\n", bitmapOffset + (last - first + 1) * 7 + 7);
+  if (rle)
+    printf(", GFX_FONT_RLE };\n\n");
+  else if (aa)
+    printf(", GFX_FONT_%dBPP };\n\n", aa);
+  else
+    printf(" };\n\n");
+  printf("// Approx. %d bytes\n", bitmapOffset + (last - first + 1) * 7 + 8);
+  if (rle) {
+    printf("// RLE bitmaps %d bytes, packed would be %d bytes\n", bitmapOffset,
+           packedSize);
+    if (bitmapOffset > packedSize)
+      fprintf(stderr, "Warning: RLE is larger than packed for this font\n");
+  }
   // Size estimate is based on AVR struct and pointer sizes;
   // actual size may vary.
 
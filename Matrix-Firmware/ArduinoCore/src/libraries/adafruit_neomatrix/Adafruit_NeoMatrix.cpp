@@ -60,6 +60,17 @@
   (*(const unsigned char *)(addr)) ///< PROGMEM concept doesn't apply on ESP8266
 #endif
 #endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#endif
+#ifndef pgm_read_dword
+#define pgm_read_dword(addr) (*(const unsigned long *)(addr))
+#endif
+#if !defined(__INT_MAX__) || (__INT_MAX__ > 0xFFFF)
+#define pgm_read_pointer(addr) ((void *)pgm_read_dword(addr))
+#else
+#define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
+#endif
 
 #ifndef _swap_uint16_t
 #define _swap_uint16_t(a, b)                                                   \
@@ -70,6 +81,15 @@
   } ///< Swap contents of two uint16_t variables
 #endif
 
+#ifndef _swap_int16_t
+#define _swap_int16_t(a, b)                                                    \
+  {                                                                            \
+    int16_t t = a;                                                             \
+    a = b;                                                                     \
+    b = t;                                                                     \
+  } ///< Swap contents of two int16_t variables
+#endif
+
 // Constructor for single matrix:
 Adafruit_NeoMatrix::Adafruit_NeoMatrix(int w, int h, uint8_t pin,
                                        uint8_t matrixType, neoPixelType ledType)
@@ -88,12 +108,24 @@ Adafruit_NeoMatrix::Adafruit_NeoMatrix(uint8_t mW, uint8_t mH, uint8_t tX,
 
 // Expand 16-bit input color (Adafruit_GFX colorspace) to 24-bit (NeoPixel)
 // (w/gamma adjustment)
-static uint32_t expandColor(uint16_t color) {
+uint32_t Adafruit_NeoMatrix::expandColor(uint16_t color) {
   return ((uint32_t)pgm_read_byte(&gamma5[color >> 11]) << 16) |
          ((uint32_t)pgm_read_byte(&gamma6[(color >> 5) & 0x3F]) << 8) |
          pgm_read_byte(&gamma5[color & 0x1F]);
 }
 
+// Minor axis steps writeLine()'s Bresenham loop has taken after k major
+// axis steps, starting from an error term of dx / 2
+static int16_t lineSteps(int32_t k, int16_t dx, int16_t dy) {
+  int32_t e = k * dy - dx / 2;
+  return (e > 0) ? (e + dx - 1) / dx : 0;
+}
+
+// First major axis step by which the loop has taken m >= 1 minor steps
+static int32_t lineStepAt(int16_t m, int16_t dx, int16_t dy) {
+  return ((int32_t)(m - 1) * dx + dx / 2) / dy + 1;
+}
+
 uint16_t Adafruit_NeoMatrix::Color(uint8_t r, uint8_t g, uint8_t b) {
   return ((uint16_t)(r & 0xF8) << 8) | ((uint16_t)(g & 0xFC) << 3) | (b >> 3);
 }
@@ -107,10 +139,10 @@ void Adafruit_NeoMatrix::setPassThruColor(uint32_t c) {
 // Call without a value to reset (disable passthrough)
 void Adafruit_NeoMatrix::setPassThruColor(void) { passThruFlag = false; }
 
-void Adafruit_NeoMatrix::drawPixel(int16_t x, int16_t y, uint16_t color) {
+uint16_t Adafruit_NeoMatrix::screenIndex(int16_t x, int16_t y) {
 
   if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
-    return;
+    return 0xFFFF;
 
   int16_t t;
   switch (rotation) {
@@ -130,6 +162,539 @@ void Adafruit_NeoMatrix::drawPixel(int16_t x, int16_t y, uint16_t color) {
     break;
   }
 
+  if (indexMap)
+    return indexMap[y * WIDTH + x];
+  // A remap function or layout may point past the strip
+  uint16_t n = pixelIndex(x, y);
+  return (n < numLEDs) ? n : 0xFFFF;
+}
+
+void Adafruit_NeoMatrix::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  // Off-matrix pixels get index 0xFFFF, which setPixelColor() ignores
+  uint16_t n = screenIndex(x, y);
+  if (n < numLEDs)
+    touch(x, y, 1, 1);
+  setPixelColor(n, passThruFlag ? passThruColor : expandColor(color));
+}
+
+void Adafruit_NeoMatrix::startWrite(void) {
+  if (!writeDepth++)
+    writeBytes = 0; // Brightness etc. may have changed since the last batch
+}
+
+void Adafruit_NeoMatrix::endWrite(void) {
+  if (writeDepth)
+    writeDepth--;
+}
+
+void Adafruit_NeoMatrix::prepareWrite(uint16_t color) {
+  if (writeBytes && (color == writeColor))
+    return;
+
+  uint32_t c = passThruFlag ? passThruColor : expandColor(color);
+  uint8_t r = (uint8_t)(c >> 16), g = (uint8_t)(c >> 8), b = (uint8_t)c,
+          w = (uint8_t)(c >> 24);
+  if (brightness) { // Same scaling as setPixelColor()
+    r = (r * brightness) >> 8;
+    g = (g * brightness) >> 8;
+    b = (b * brightness) >> 8;
+    w = (w * brightness) >> 8;
+  }
+  if (palette) {
+    writeValue[0] = closestPaletteIndex(r, g, b, w);
+    writeBytes = 1;
+  } else {
+    writeValue[rOffset] = r;
+    writeValue[gOffset] = g;
+    writeValue[bOffset] = b;
+    if (wOffset != rOffset)
+      writeValue[wOffset] = w;
+    writeBytes = (wOffset == rOffset) ? 3 : 4;
+  }
+  writeColor = color;
+}
+
+// Account for a clipped rectangle about to be written: pixel count (n, or
+// all of w x h if 0) and damage bounds. Called once per span rather than
+// per pixel.
+void Adafruit_NeoMatrix::touch(int16_t x, int16_t y, int16_t w, int16_t h,
+                               uint16_t n) {
+  if (!n)
+    n = (uint16_t)w * h;
+  pixelsWritten = (pixelsWritten > 0xFFFF - n) ? 0xFFFF : pixelsWritten + n;
+  if (x < damageX0)
+    damageX0 = x;
+  if (y < damageY0)
+    damageY0 = y;
+  if (x + w > damageX1)
+    damageX1 = x + w;
+  if (y + h > damageY1)
+    damageY1 = y + h;
+}
+
+void Adafruit_NeoMatrix::eraseDamage(uint16_t color) {
+  int16_t x, y, w, h;
+  getDamage(&x, &y, &w, &h);
+  if (w) {
+    fillRect(x, y, w, h, color);
+    clearDamage(); // The background isn't damage
+  }
+}
+
+void Adafruit_NeoMatrix::getDamage(int16_t *x, int16_t *y, int16_t *w,
+                                   int16_t *h) const {
+  bool none = (damageX0 >= damageX1) || (damageY0 >= damageY1);
+  *x = none ? 0 : damageX0;
+  *y = none ? 0 : damageY0;
+  *w = none ? 0 : damageX1 - damageX0;
+  *h = none ? 0 : damageY1 - damageY0;
+}
+
+void Adafruit_NeoMatrix::clearDamage(void) {
+  damageX0 = damageY0 = 0x7FFF;
+  damageX1 = damageY1 = 0;
+}
+
+void Adafruit_NeoMatrix::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if (!writeDepth) {
+    drawPixel(x, y, color);
+    return;
+  }
+  uint16_t n = screenIndex(x, y);
+  if (n < numLEDs) {
+    touch(x, y, 1, 1);
+    prepareWrite(color);
+    putPixel(n);
+  }
+}
+
+void Adafruit_NeoMatrix::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                        uint16_t color) {
+  if ((y < 0) || (y >= _height))
+    return;
+  if (w < 0) { // Line extends left of x
+    x += w + 1;
+    w = -w;
+  }
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (x + w > _width)
+    w = _width - x;
+  if (w <= 0)
+    return;
+
+  touch(x, y, w, 1);
+  startWrite();
+  prepareWrite(color);
+  while (w--)
+    putPixel(screenIndex(x++, y));
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                        uint16_t color) {
+  if ((x < 0) || (x >= _width))
+    return;
+  if (h < 0) { // Line extends above y
+    y += h + 1;
+    h = -h;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (y + h > _height)
+    h = _height - y;
+  if (h <= 0)
+    return;
+
+  touch(x, y, 1, h);
+  startWrite();
+  prepareWrite(color);
+  while (h--)
+    putPixel(screenIndex(x, y++));
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::writeFillRect(int16_t x, int16_t y, int16_t w,
+                                       int16_t h, uint16_t color) {
+  if (h < 0) { // Rect extends above y
+    y += h + 1;
+    h = -h;
+  }
+  startWrite();
+  while (h-- > 0)
+    writeFastHLine(x, y++, w, color);
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                       uint16_t color) {
+  startWrite();
+  writeFastHLine(x, y, w, color);
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                       uint16_t color) {
+  startWrite();
+  writeFastVLine(x, y, h, color);
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                  uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+// indexMap offset of on-screen pixel (x, y), and the offset steps for
+// x + 1 and y + 1 in the current rotation
+int16_t Adafruit_NeoMatrix::mapOffset(int16_t x, int16_t y, int16_t *dX,
+                                      int16_t *dY) {
+  switch (rotation) {
+  case 1:
+    *dX = WIDTH;
+    *dY = -1;
+    return x * WIDTH + (WIDTH - 1 - y);
+  case 2:
+    *dX = -1;
+    *dY = -WIDTH;
+    return (HEIGHT - 1 - y) * WIDTH + (WIDTH - 1 - x);
+  case 3:
+    *dX = -WIDTH;
+    *dY = 1;
+    return (HEIGHT - 1 - x) * WIDTH + y;
+  default:
+    *dX = 1;
+    *dY = WIDTH;
+    return y * WIDTH + x;
+  }
+}
+
+// Same pixels as Adafruit_GFX::writeLine(), but clipped to the matrix once
+// up front, after which each step is just an error term update and, with
+// an index map, an offset step instead of a full screenIndex().
+void Adafruit_NeoMatrix::writeLine(int16_t x0, int16_t y0, int16_t x1,
+                                   int16_t y1, uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) { // Step along y, the longer axis
+    _swap_int16_t(x0, y0);
+    _swap_int16_t(x1, y1);
+  }
+  if (x0 > x1) {
+    _swap_int16_t(x0, x1);
+    _swap_int16_t(y0, y1);
+  }
+  int16_t dx = x1 - x0, dy = abs(y1 - y0), ystep = (y0 < y1) ? 1 : -1;
+  int16_t xMax = (steep ? _height : _width) - 1,
+          yMax = (steep ? _width : _height) - 1;
+
+  // Trivial reject: both ends off the same side
+  if ((x1 < 0) || (x0 > xMax) || (max(y0, y1) < 0) || (min(y0, y1) > yMax))
+    return;
+
+  // Clip to the steps k0..k1 that are on the matrix, first along the major
+  // axis, then by the minor axis steps that keep y in range
+  int32_t k0 = max(0, -x0), k1 = min(dx, xMax - x0);
+  int16_t mMin = (ystep > 0) ? -y0 : y0 - yMax,
+          mMax = (ystep > 0) ? yMax - y0 : y0;
+  if (mMin > 0)
+    k0 = max(k0, lineStepAt(mMin, dx, dy));
+  if (mMax < dy)
+    k1 = min(k1, lineStepAt(mMax + 1, dx, dy) - 1);
+  if (k0 > k1)
+    return;
+
+  int16_t m = lineSteps(k0, dx, dy), mEnd = lineSteps(k1, dx, dy);
+  int16_t err = dx / 2 - k0 * dy + (int32_t)m * dx;
+  int16_t x = x0 + k0, y = y0 + ystep * m, yEnd = y0 + ystep * mEnd;
+  uint16_t n = k1 - k0 + 1;
+  if (steep)
+    touch(min(y, yEnd), x, abs(yEnd - y) + 1, n, n);
+  else
+    touch(x, min(y, yEnd), n, abs(yEnd - y) + 1, n);
+
+  startWrite();
+  prepareWrite(color);
+  if (indexMap) {
+    int16_t dX, dY;
+    int16_t o = steep ? mapOffset(y, x, &dX, &dY) : mapOffset(x, y, &dX, &dY);
+    int16_t dMajor = steep ? dY : dX, dMinor = (steep ? dX : dY) * ystep;
+    while (n--) {
+      putPixel(indexMap[o]);
+      o += dMajor;
+      err -= dy;
+      if (err < 0) {
+        o += dMinor;
+        err += dx;
+      }
+    }
+  } else {
+    while (n--) {
+      putPixel(steep ? screenIndex(y, x) : screenIndex(x, y));
+      x++;
+      err -= dy;
+      if (err < 0) {
+        y += ystep;
+        err += dx;
+      }
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::drawLineAA(int16_t x0, int16_t y0, int16_t x1,
+                                    int16_t y1, uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    _swap_int16_t(x0, y0);
+    _swap_int16_t(x1, y1);
+  }
+  if (x0 > x1) {
+    _swap_int16_t(x0, x1);
+    _swap_int16_t(y0, y1);
+  }
+  int16_t dx = x1 - x0, xMax = (steep ? _height : _width) - 1,
+          yMax = (steep ? _width : _height) - 1;
+  if ((x1 < 0) || (x0 > xMax) || (max(y0, y1) < 0) || (min(y0, y1) > yMax))
+    return;
+
+  // y in 16.16 fixed point; the 8 bits below the point split each step's
+  // intensity between the two pixels it straddles
+  int32_t k0 = max(0, -x0), k1 = min(dx, xMax - x0);
+  int32_t grad = dx ? (int32_t)(y1 - y0) * 65536 / dx : 0;
+  int32_t yq = (int32_t)y0 * 65536 + k0 * grad;
+  int16_t yA = yq >> 16, yB = (yq + (k1 - k0) * grad) >> 16;
+  int16_t top = constrain(min(yA, yB), 0, yMax),
+          bottom = constrain(max(yA, yB) + 1, 0, yMax);
+  uint16_t n = k1 - k0 + 1;
+  if (steep)
+    touch(top, x0 + k0, bottom - top + 1, n, 2 * n);
+  else
+    touch(x0 + k0, top, n, bottom - top + 1, 2 * n);
+
+  startWrite();
+  prepareWrite(color);
+  for (int16_t x = x0 + k0; x <= x0 + k1; x++, yq += grad) {
+    int16_t y = yq >> 16;
+    uint8_t f = yq >> 8;
+    n = steep ? screenIndex(y, x) : screenIndex(x, y);
+    if (n < numLEDs)
+      blendPixel(n, 255 - f);
+    if (f) {
+      n = steep ? screenIndex(y + 1, x) : screenIndex(x, y + 1);
+      if (n < numLEDs)
+        blendPixel(n, f);
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::drawSprite(int16_t x, int16_t y,
+                                    const NeoSprite *sprite, uint16_t color) {
+  drawSprite(x, y, sprite, color, 0, 0, _width, _height);
+}
+
+void Adafruit_NeoMatrix::drawSprite(int16_t x, int16_t y,
+                                    const NeoSprite *sprite, uint16_t color,
+                                    int16_t cx, int16_t cy, int16_t cw,
+                                    int16_t ch) {
+  const uint8_t *data = (const uint8_t *)pgm_read_pointer(&sprite->data);
+  const uint16_t *pal = (const uint16_t *)pgm_read_pointer(&sprite->palette);
+  uint8_t w = pgm_read_byte(&sprite->width), h = pgm_read_byte(&sprite->height),
+          flags = pgm_read_byte(&sprite->flags),
+          format = flags & SPRITE_FORMAT;
+  uint16_t key = pgm_read_word(&sprite->key);
+  bool keyed = flags & SPRITE_KEYED;
+
+  // Visible part: sprite, clip rect and matrix intersected
+  int16_t x0 = max(max(x, cx), (int16_t)0),
+          y0 = max(max(y, cy), (int16_t)0),
+          x1 = min(min((int16_t)(x + w), (int16_t)(cx + cw)), _width),
+          y1 = min(min((int16_t)(y + h), (int16_t)(cy + ch)), _height);
+  if ((x0 >= x1) || (y0 >= y1))
+    return;
+
+  touch(x0, y0, x1 - x0, y1 - y0);
+  startWrite();
+  if (format == SPRITE_MASK) {
+    uint8_t byteWidth = (w + 7) / 8;
+    prepareWrite(color);
+    for (int16_t py = y0; py < y1; py++) {
+      const uint8_t *row = &data[(py - y) * byteWidth];
+      for (int16_t px = x0; px < x1; px++) {
+        uint8_t i = px - x;
+        if (pgm_read_byte(&row[i >> 3]) & (0x80 >> (i & 7)))
+          putPixel(screenIndex(px, py));
+      }
+    }
+  } else {
+    uint8_t bytes = (format == SPRITE_INDEXED) ? 1 : 2, run = 0;
+    bool rle = flags & SPRITE_RLE, repeat = false;
+    uint16_t v = 0;
+    for (int16_t py = y; py < y1; py++) {
+      if (!rle && (py < y0))
+        continue; // Raw rows above the clip are skipped without decoding
+      const uint8_t *p = rle ? data : &data[(py - y) * w * bytes];
+      for (int16_t px = x; px < x + w; px++) {
+        if (!rle && ((px < x0) || (px >= x1)))
+          continue;
+        if (rle) { // Next pixel from the packet stream
+          if (!run) {
+            uint8_t c = pgm_read_byte(data++);
+            repeat = c & 0x80;
+            run = (c & 0x7F) + 1;
+            if (repeat) {
+              v = pgm_read_byte(data++);
+              if (bytes == 2)
+                v |= pgm_read_byte(data++) << 8;
+            }
+          }
+          if (!repeat) {
+            v = pgm_read_byte(data++);
+            if (bytes == 2)
+              v |= pgm_read_byte(data++) << 8;
+          }
+          run--;
+          if ((py < y0) || (px < x0) || (px >= x1))
+            continue;
+        } else {
+          v = (bytes == 2) ? pgm_read_word(&p[(px - x) * 2])
+                           : pgm_read_byte(&p[px - x]);
+        }
+        if (keyed && (v == key))
+          continue;
+        prepareWrite((bytes == 2) ? v : pgm_read_word(&pal[v]));
+        putPixel(screenIndex(px, py));
+      }
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_NeoMatrix::writePixelBlend(int16_t x, int16_t y, uint16_t color,
+                                         uint8_t alpha) {
+  uint16_t n = screenIndex(x, y);
+  if (n >= numLEDs)
+    return;
+  touch(x, y, 1, 1);
+  startWrite();
+  prepareWrite(color);
+  blendPixel(n, alpha);
+  endWrite();
+}
+
+// Blend the prepareWrite() color into pixel n; alpha 255 replaces the pixel.
+// The buffer holds brightness-scaled values, as does writeValue.
+void Adafruit_NeoMatrix::blendPixel(uint16_t n, uint8_t alpha) {
+  if (palette) { // Indices don't mix
+    if (alpha >= 128)
+      putPixel(n);
+    return;
+  }
+  uint8_t *p = &pixels[n * writeBytes];
+  uint16_t a = alpha + 1, inv = 256 - a; // 255 -> 256, replaces the pixel
+  for (uint8_t i = 0; i < writeBytes; i++)
+    p[i] = (p[i] * inv + writeValue[i] * a) >> 8;
+}
+
+// Store an unscaled color in pixel n, like setPixelColor() minus the
+// white channel; n past the strip (0xFFFF included) is ignored
+void Adafruit_NeoMatrix::storeRGB(uint16_t n, uint8_t r, uint8_t g,
+                                  uint8_t b) {
+  if (n >= numLEDs)
+    return;
+  if (brightness) {
+    r = (r * brightness) >> 8;
+    g = (g * brightness) >> 8;
+    b = (b * brightness) >> 8;
+  }
+  if (palette) {
+    pixels[n] = closestPaletteIndex(r, g, b, 0);
+  } else if (wOffset == rOffset) {
+    uint8_t *p = &pixels[n * 3];
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
+  } else {
+    uint8_t *p = &pixels[n * 4];
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
+    p[wOffset] = 0;
+  }
+}
+
+void Adafruit_NeoMatrix::drawCanvas(const GFXcanvas24 &canvas, int16_t x,
+                                    int16_t y) {
+  const uint8_t *src = canvas.getBuffer();
+  if (!src)
+    return;
+  uint8_t order = canvas.getOrder();
+  uint8_t cr = (order >> 4) & 3, cg = (order >> 2) & 3, cb = order & 3;
+
+  if (!x && !y && (canvas.getRotation() == rotation) &&
+      (canvas.width() == _width) && (canvas.height() == _height)) {
+    // Same raw layout: walk both buffers in raw order, one remap per pixel
+    bool verbatim = !brightness && !palette && (wOffset == rOffset) &&
+                    (cr == rOffset) && (cg == gOffset) && (cb == bOffset);
+    touch(0, 0, _width, _height);
+    uint16_t i = 0;
+    for (int16_t ry = 0; ry < HEIGHT; ry++) {
+      for (int16_t rx = 0; rx < WIDTH; rx++, i++, src += 3) {
+        uint16_t n = indexMap ? indexMap[i] : pixelIndex(rx, ry);
+        if (n >= numLEDs)
+          continue; // Mapped past the strip
+        if (verbatim) {
+          uint8_t *p = &pixels[n * 3];
+          p[0] = src[0];
+          p[1] = src[1];
+          p[2] = src[2];
+        } else {
+          storeRGB(n, src[cr], src[cg], src[cb]);
+        }
+      }
+    }
+    return;
+  }
+
+  int16_t x0 = max(x, (int16_t)0), y0 = max(y, (int16_t)0),
+          x1 = min((int16_t)(x + canvas.width()), _width),
+          y1 = min((int16_t)(y + canvas.height()), _height);
+  if ((x0 >= x1) || (y0 >= y1))
+    return;
+  touch(x0, y0, x1 - x0, y1 - y0);
+  for (int16_t py = y0; py < y1; py++) {
+    for (int16_t px = x0; px < x1; px++) {
+      uint32_t c = canvas.getPixelRGB(px - x, py - y);
+      storeRGB(screenIndex(px, py), c >> 16, c >> 8, c);
+    }
+  }
+}
+
+void Adafruit_NeoMatrix::fillScreen(uint16_t color) {
+  uint16_t i, n;
+  uint32_t c;
+
+  touch(0, 0, _width, _height);
+  c = passThruFlag ? passThruColor : expandColor(color);
+  n = numPixels();
+  for (i = 0; i < n; i++)
+    setPixelColor(i, c);
+}
+
+void Adafruit_NeoMatrix::setRemapFunction(uint16_t (*fn)(uint16_t, uint16_t)) {
+  remapFn = fn;
+  if (indexMap) // Cached indices are stale now, recompute them
+    buildIndexMap();
+}
+
+uint16_t Adafruit_NeoMatrix::pixelIndex(uint16_t x, uint16_t y) {
+
   int tileOffset = 0, pixelOffset;
 
   if (remapFn) { // Custom X/Y remapping function
@@ -213,20 +778,26 @@ void Adafruit_NeoMatrix::drawPixel(int16_t x, int16_t y, uint16_t color) {
     }
   }
 
-  setPixelColor(tileOffset + pixelOffset,
-                passThruFlag ? passThruColor : expandColor(color));
+  return tileOffset + pixelOffset;
 }
 
-void Adafruit_NeoMatrix::fillScreen(uint16_t color) {
-  uint16_t i, n;
-  uint32_t c;
-
-  c = passThruFlag ? passThruColor : expandColor(color);
-  n = numPixels();
-  for (i = 0; i < n; i++)
-    setPixelColor(i, c);
+bool Adafruit_NeoMatrix::buildIndexMap(void) {
+  if (!indexMap) {
+    indexMap = (uint16_t *)neoAlloc(WIDTH * HEIGHT * sizeof(uint16_t));
+    if (!indexMap)
+      return false;
+  }
+  uint16_t *p = indexMap;
+  for (uint16_t y = 0; y < HEIGHT; y++) {
+    for (uint16_t x = 0; x < WIDTH; x++) {
+      uint16_t n = pixelIndex(x, y);
+      *p++ = (n < numLEDs) ? n : 0xFFFF; // Past the strip, as screenIndex()
+    }
+  }
+  return true;
 }
 
-void Adafruit_NeoMatrix::setRemapFunction(uint16_t (*fn)(uint16_t, uint16_t)) {
-  remapFn = fn;
+void Adafruit_NeoMatrix::freeIndexMap(void) {
+  neoFree(indexMap);
+  indexMap = NULL;
 }
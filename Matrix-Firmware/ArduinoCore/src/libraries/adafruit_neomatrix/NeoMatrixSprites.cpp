@@ -0,0 +1,276 @@
+/*!
+ * @file NeoMatrixSprites.cpp
+ *
+ * Sprite layer for Adafruit_NeoMatrix.
+ *
+ * The matrix keeps last frame's pixels in the NeoPixel buffer, so a frame
+ * in which one small sprite moved only needs that sprite's old and new
+ * rectangles redrawn: background first, then every item that overlaps
+ * the rectangle, in slot order and clipped to it. Sprites are blitted with
+ * Adafruit_NeoMatrix::drawSprite(), straight into the buffer. Rectangles
+ * stand in for lines and bars, which is most of what animations draw, and
+ * points for small things that should move smoothly, like a ball.
+ *
+ * This file is part of the Adafruit NeoMatrix library.
+ *
+ * NeoMatrix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * NeoMatrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoMatrix.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <NeoMatrixSprites.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+#include <pgmspace.h>
+#endif
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#endif
+
+NeoMatrixSprites::NeoMatrixSprites(Adafruit_NeoMatrix &matrix, uint8_t count,
+                                   uint16_t background)
+    : matrix(matrix), entries(NULL), count(count), background(background),
+      full(true) {}
+
+NeoMatrixSprites::~NeoMatrixSprites() { neoFree(entries); }
+
+/*!
+  @brief   Allocate the slots, all empty.
+  @return  true on success, false if they could not be allocated.
+*/
+bool NeoMatrixSprites::begin(void) {
+  neoFree(entries);
+  entries = (entry_t *)neoAlloc(count * sizeof(entry_t));
+  full = true;
+  return (entries != NULL);
+}
+
+/*!
+  @brief   Put an image in a slot and show it.
+  @param   i       Slot number.
+  @param   sprite  Sprite in PROGMEM, or NULL to empty the slot.
+  @param   x       Left edge column.
+  @param   y       Top edge row.
+*/
+void NeoMatrixSprites::set(uint8_t i, const NeoSprite *sprite, int16_t x,
+                           int16_t y) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  e->sprite = sprite;
+  e->x = x;
+  e->y = y;
+  e->w = sprite ? pgm_read_byte(&sprite->width) : 0;
+  e->h = sprite ? pgm_read_byte(&sprite->height) : 0;
+  e->point = false;
+  e->visible = true;
+  e->dirty = true;
+}
+
+/*!
+  @brief   Put a filled rectangle in a slot and show it. Nothing is redrawn
+           if the slot already holds the same rectangle, so animations can
+           simply set their shapes every frame.
+  @param   i      Slot number.
+  @param   x      Left edge column.
+  @param   y      Top edge row.
+  @param   w      Width in pixels, 0 to empty the slot.
+  @param   h      Height in pixels, 0 to empty the slot.
+  @param   color  16-bit '565' RGB color.
+*/
+void NeoMatrixSprites::setRect(uint8_t i, int16_t x, int16_t y, uint8_t w,
+                               uint8_t h, uint16_t color) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  if (!h)
+    w = 0;
+  if (!e->sprite && !e->point && (e->x == x) && (e->y == y) &&
+      (e->w == w) && (e->h == h) && (e->color == color) && e->visible)
+    return;
+  e->sprite = NULL;
+  e->point = false;
+  e->x = x;
+  e->y = y;
+  e->w = w;
+  e->h = h;
+  e->color = color;
+  e->visible = true;
+  e->dirty = true;
+}
+
+/*!
+  @brief   Put a point at a fractional position in a slot and show it. It
+           is drawn with Adafruit_GFX::drawPixelQ8(), spread over the
+           pixels around it, so it can glide smoothly instead of jumping a
+           whole pixel at a time. Like setRect(), nothing is redrawn if
+           the point didn't move.
+  @param   i      Slot number.
+  @param   x      Column, Q8.8 fixed point (pixels * 256).
+  @param   y      Row, Q8.8 fixed point.
+  @param   color  16-bit '565' RGB color.
+*/
+void NeoMatrixSprites::setPoint(uint8_t i, int16_t x, int16_t y,
+                                uint16_t color) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  int16_t px = x >> 8, py = y >> 8;
+  uint8_t fx = x, fy = y;
+  if (e->point && (e->x == px) && (e->y == py) && (e->fx == fx) &&
+      (e->fy == fy) && (e->color == color) && e->visible)
+    return;
+  e->sprite = NULL;
+  e->point = true;
+  e->x = px;
+  e->y = py;
+  e->w = 2; // Covers up to 2x2 pixels
+  e->h = 2;
+  e->fx = fx;
+  e->fy = fy;
+  e->color = color;
+  e->visible = true;
+  e->dirty = true;
+}
+
+/*!
+  @brief   Move an item. Nothing is redrawn unless the position changed.
+  @param   i  Slot number.
+  @param   x  New left edge column.
+  @param   y  New top edge row.
+*/
+void NeoMatrixSprites::moveTo(uint8_t i, int16_t x, int16_t y) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  if ((e->x != x) || (e->y != y)) {
+    e->x = x;
+    e->y = y;
+    e->dirty = true;
+  }
+}
+
+/*!
+  @brief   Set the color of a rectangle or SPRITE_MASK sprite.
+  @param   i      Slot number.
+  @param   color  16-bit '565' RGB color.
+*/
+void NeoMatrixSprites::setColor(uint8_t i, uint16_t color) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  if (e->color != color) {
+    e->color = color;
+    e->dirty = true;
+  }
+}
+
+/*!
+  @brief   Show or hide an item.
+  @param   i        Slot number.
+  @param   visible  true to show.
+*/
+void NeoMatrixSprites::show(uint8_t i, bool visible) {
+  if (!entries || (i >= count))
+    return;
+  entry_t *e = &entries[i];
+  if (e->visible != visible) {
+    e->visible = visible;
+    e->dirty = true;
+  }
+}
+
+/*!
+  @brief   Change the background color. Repaints everything on the next
+           update().
+  @param   color  16-bit '565' RGB color.
+*/
+void NeoMatrixSprites::setBackground(uint16_t color) {
+  background = color;
+  full = true;
+}
+
+/*!
+  @brief   Repaint the whole matrix on the next update(). Call this when
+           something else has drawn over the matrix in the meantime.
+*/
+void NeoMatrixSprites::invalidate(void) { full = true; }
+
+/*!
+  @brief   Bring the matrix up to date with the slots, redrawing
+           only the rectangles that changed.
+  @return  true if any pixel may have changed and the matrix needs a
+           show().
+*/
+bool NeoMatrixSprites::update(void) {
+  if (!entries)
+    return false;
+  bool changed = full;
+  matrix.startWrite();
+  if (full)
+    repaint(0, 0, matrix.width(), matrix.height());
+  for (uint8_t i = 0; i < count; i++) {
+    entry_t *e = &entries[i];
+    if (!e->dirty && !full)
+      continue;
+    uint8_t w = e->visible ? e->w : 0, h = e->visible ? e->h : 0;
+    if (!full) {
+      if (e->drawnW && w && (e->drawnX < e->x + w) &&
+          (e->x < e->drawnX + e->drawnW) && (e->drawnY < e->y + h) &&
+          (e->y < e->drawnY + e->drawnH)) {
+        // Small moves overlap the old spot, repaint both in one go
+        int16_t x0 = min(e->x, e->drawnX), y0 = min(e->y, e->drawnY);
+        repaint(x0, y0, max(e->x + w, e->drawnX + e->drawnW) - x0,
+                max(e->y + h, e->drawnY + e->drawnH) - y0);
+      } else {
+        if (e->drawnW)
+          repaint(e->drawnX, e->drawnY, e->drawnW, e->drawnH);
+        if (w)
+          repaint(e->x, e->y, w, h);
+      }
+    }
+    e->drawnX = e->x;
+    e->drawnY = e->y;
+    e->drawnW = w;
+    e->drawnH = h;
+    e->dirty = false;
+    changed = true;
+  }
+  matrix.endWrite();
+  full = false;
+  return changed;
+}
+
+// Fill a rectangle with the background and draw the scene over it
+void NeoMatrixSprites::repaint(int16_t x, int16_t y, int16_t w, int16_t h) {
+  matrix.fillRect(x, y, w, h, background);
+  for (uint8_t i = 0; i < count; i++) {
+    entry_t *e = &entries[i];
+    if (!e->w || !e->visible || (e->x >= x + w) || (e->y >= y + h) ||
+        (e->x + e->w <= x) || (e->y + e->h <= y))
+      continue;
+    if (e->sprite) {
+      matrix.drawSprite(e->x, e->y, e->sprite, e->color, x, y, w, h);
+    } else if (e->point) {
+      matrix.drawPixelQ8(e->x * 256 + e->fx, e->y * 256 + e->fy, e->color,
+                         x, y, w, h);
+    } else { // Rectangle, clipped to the repainted area
+      int16_t x0 = max(e->x, x), y0 = max(e->y, y);
+      matrix.fillRect(x0, y0, min(e->x + e->w, x + w) - x0,
+                      min(e->y + e->h, y + h) - y0, e->color);
+    }
+  }
+}
@@ -0,0 +1,289 @@
+/*!
+ * @file NeoMatrixTicker.cpp
+ *
+ * Scrolling text ticker for Adafruit_GFX displays.
+ *
+ * Glyphs are decoded one column at a time, only when a column scrolls
+ * into the window, into a ring buffer just two columns wider than the
+ * window. Drawing a frame is then a matter of reading bits from the ring;
+ * the fractional part of the scroll position blends each pixel between
+ * the two columns it sits across, so slow scrolling stays smooth.
+ *
+ * This file is part of the Adafruit NeoMatrix library.
+ *
+ * NeoMatrix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * NeoMatrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoMatrix.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <NeoMatrixTicker.h>
+#include <Adafruit_NeoMatrix.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+#include <pgmspace.h>
+#endif
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#endif
+#ifndef pgm_read_dword
+#define pgm_read_dword(addr) (*(const unsigned long *)(addr))
+#endif
+#if !defined(__INT_MAX__) || (__INT_MAX__ > 0xFFFF)
+#define pgm_read_pointer(addr) ((void *)pgm_read_dword(addr))
+#else
+#define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
+#endif
+
+NeoMatrixTicker::NeoMatrixTicker(Adafruit_GFX &gfx, const GFXfont *font)
+    : gfx(gfx), font(font), text(NULL), textInFlash(false), loop(true),
+      textLen(0), textCols(0), x(0), baseline(0), top(0), w(0), h(0),
+      ring(NULL), ringLen(0), r(255), g(255), b(255), speed(10), frac(0),
+      pos(0), last(0) {}
+
+NeoMatrixTicker::~NeoMatrixTicker() { neoFree(ring); }
+
+/*!
+  @brief   Set up the ticker window and allocate its column ring buffer.
+  @param   x         Left edge of the window.
+  @param   baseline  Text baseline, as with Adafruit_GFX::setCursor().
+  @param   w         Width of the window in pixels.
+  @return  true on success, false if the font isn't in the packed 1 bit
+           per pixel format or the ring buffer could not be allocated.
+*/
+bool NeoMatrixTicker::begin(int16_t x, int16_t baseline, uint8_t w) {
+  neoFree(ring);
+  ring = NULL;
+  // rasterize() reads glyph bits straight from the bitmap, which RLE and
+  // anti-aliased fonts don't have
+  if (pgm_read_byte(&font->flags) & (GFX_FONT_RLE | GFX_FONT_AA))
+    return false;
+  this->x = x;
+  this->baseline = baseline;
+  this->w = w;
+  ringLen = w + 2; // window plus the column blended in from the right
+  ring = (uint16_t *)neoAlloc(ringLen * sizeof(uint16_t));
+  restart();
+  return (ring != NULL);
+}
+
+/*!
+  @brief   Set the text to scroll from a string in RAM. The string is not
+           copied and must stay valid while the ticker runs.
+  @param   text  Null-terminated string.
+*/
+void NeoMatrixTicker::setText(const char *text) {
+  this->text = text;
+  textInFlash = false;
+  textLen = text ? strlen(text) : 0;
+  restart();
+}
+
+/*!
+  @brief   Set the text to scroll from a string in PROGMEM (F("...")).
+  @param   text  Null-terminated flash string.
+*/
+void NeoMatrixTicker::setText(const __FlashStringHelper *text) {
+  this->text = (const char *)text;
+  textInFlash = true;
+  textLen = text ? strlen_P((const char *)text) : 0;
+  restart();
+}
+
+/*!
+  @brief   Set the text color.
+  @param   color  32-bit packed RGB color, as with Adafruit_NeoPixel::Color().
+*/
+void NeoMatrixTicker::setColor(uint32_t color) {
+  r = (uint8_t)(color >> 16);
+  g = (uint8_t)(color >> 8);
+  b = (uint8_t)color;
+}
+
+/*!
+  @brief   Set the scroll speed.
+  @param   speed  Pixels per second.
+*/
+void NeoMatrixTicker::setSpeed(uint16_t speed) { this->speed = speed; }
+
+/*!
+  @brief   Choose whether the text starts over once it has scrolled out.
+  @param   loop  true to repeat (default), false to stop.
+*/
+void NeoMatrixTicker::setLoop(bool loop) { this->loop = loop; }
+
+/*!
+  @brief   Scroll the text in from the right edge again. Also measures the
+           text and the rows it covers, which takes one pass over its
+           glyph metrics.
+*/
+void NeoMatrixTicker::restart(void) {
+  int8_t minY = 127, maxY = -128;
+  textCols = 0;
+  for (uint16_t i = 0; i < textLen; i++) {
+    GFXglyph *glyph = glyphFor(readChar(i));
+    if (!glyph)
+      continue;
+    int8_t yo = pgm_read_byte(&glyph->yOffset);
+    uint8_t gh = pgm_read_byte(&glyph->height);
+    textCols += pgm_read_byte(&glyph->xAdvance);
+    if (gh) {
+      minY = min(minY, yo);
+      maxY = max(maxY, (int8_t)(yo + gh));
+    }
+  }
+  if (minY > maxY)
+    minY = maxY = 0; // nothing visible
+  top = baseline + minY;
+  h = min(maxY - minY, TICKER_MAX_ROWS);
+
+  nextCol = 0;
+  nextChar = 0;
+  glyphCol = 0;
+  frac = 0;
+  pos = 0;
+  last = millis();
+}
+
+/*!
+  @brief   Advance the scroll position. Call this every frame.
+  @param   now  Current time (millis()).
+  @return  true if the position changed and the ticker should be redrawn.
+*/
+bool NeoMatrixTicker::update(unsigned long now) {
+  uint32_t elapsed = min(now - last, 1000UL); // don't jump after a stall
+  last = now;
+  uint32_t step = elapsed * speed * 256 + frac;
+  uint32_t oldPos = pos;
+  pos += step / 1000;
+  frac = step % 1000;
+
+  uint32_t end = (uint32_t)(w + textCols) << 8;
+  if (pos >= end) {
+    if (loop) {
+      uint32_t over = pos - end;
+      restart();
+      pos = over;
+    } else {
+      pos = end;
+    }
+  }
+  return (pos != oldPos);
+}
+
+/*!
+  @brief   Draw the ticker window at the current scroll position. Every
+           pixel of the text band within the window is written, unlit ones
+           in black, so there's no need to clear it first.
+*/
+void NeoMatrixTicker::draw(void) {
+  if (!ring)
+    return;
+  uint16_t scroll = pos >> 8;
+  uint8_t f = pos & 0xFF; // fraction of the way to the next column
+  uint16_t full = Adafruit_NeoMatrix::Color(r, g, b),
+           left = Adafruit_NeoMatrix::Color(((uint16_t)r * (256 - f)) >> 8,
+                                            ((uint16_t)g * (256 - f)) >> 8,
+                                            ((uint16_t)b * (256 - f)) >> 8),
+           right = Adafruit_NeoMatrix::Color(((uint16_t)r * f) >> 8,
+                                             ((uint16_t)g * f) >> 8,
+                                             ((uint16_t)b * f) >> 8);
+
+  gfx.startWrite();
+  for (uint8_t i = 0; i < w; i++) {
+    // text column under this pixel, the text enters from the right edge
+    int32_t t = (int32_t)i + scroll - w;
+    uint16_t colA = ((t >= 0) && (t < textCols)) ? column(t) : 0;
+    uint16_t colB = ((t + 1 >= 0) && (t + 1 < textCols)) ? column(t + 1) : 0;
+    for (uint8_t k = 0; k < h; k++) {
+      uint16_t bit = 1 << k;
+      uint16_t color = (colA & bit) ? ((colB & bit) ? full : left)
+                                    : ((colB & bit) ? right : 0);
+      gfx.writePixel(x + i, top + k, color);
+    }
+  }
+  gfx.endWrite();
+}
+
+/*!
+  @brief   Check whether a non-looping ticker has finished.
+  @return  true once the text has scrolled out of the window.
+*/
+bool NeoMatrixTicker::isDone(void) const {
+  return !loop && (pos >= ((uint32_t)(w + textCols) << 8));
+}
+
+// Column t of the rendered text. Columns are requested in (nearly)
+// ascending order and never more than a window's width back, so the ring
+// only ever needs to rasterize forward.
+uint16_t NeoMatrixTicker::column(uint16_t t) {
+  while (nextCol <= t) {
+    ring[nextCol % ringLen] = rasterize();
+    nextCol++;
+  }
+  return ring[t % ringLen];
+}
+
+// Decode the next column of the text from the font's bitmap
+uint16_t NeoMatrixTicker::rasterize(void) {
+  GFXglyph *glyph = NULL;
+  uint8_t xa = 0;
+  while (nextChar < textLen) {
+    glyph = glyphFor(readChar(nextChar));
+    if (glyph && (xa = pgm_read_byte(&glyph->xAdvance)))
+      break;
+    nextChar++; // not in the font, or zero width
+    glyphCol = 0;
+  }
+  if (nextChar >= textLen)
+    return 0;
+
+  uint16_t bits = 0;
+  int8_t gx = glyphCol - (int8_t)pgm_read_byte(&glyph->xOffset);
+  uint8_t gw = pgm_read_byte(&glyph->width);
+  if ((gx >= 0) && (gx < gw)) {
+    uint8_t *bitmap = (uint8_t *)pgm_read_pointer(&font->bitmap);
+    uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
+    uint8_t gh = pgm_read_byte(&glyph->height);
+    int8_t k = baseline + (int8_t)pgm_read_byte(&glyph->yOffset) - top;
+    // glyph bitmaps are row major, so step one row (gw bits) at a time
+    uint16_t bit = gx;
+    for (uint8_t yy = 0; yy < gh; yy++, k++, bit += gw) {
+      if ((k >= 0) && (k < h) &&
+          (pgm_read_byte(&bitmap[bo + (bit >> 3)]) & (0x80 >> (bit & 7))))
+        bits |= 1 << k;
+    }
+  }
+
+  if (++glyphCol >= xa) {
+    glyphCol = 0;
+    nextChar++;
+  }
+  return bits;
+}
+
+uint8_t NeoMatrixTicker::readChar(uint16_t i) const {
+  return textInFlash ? pgm_read_byte(&text[i]) : text[i];
+}
+
+GFXglyph *NeoMatrixTicker::glyphFor(uint8_t c) const {
+  uint8_t first = pgm_read_word(&font->first);
+  if ((c < first) || (c > (uint8_t)pgm_read_word(&font->last)))
+    return NULL;
+  return &(((GFXglyph *)pgm_read_pointer(&font->glyph))[c - first]);
+}
@@ -78,7 +78,8 @@
   @return  Adafruit_NeoPixel object. Call the begin() function before use.
 */
 Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, neoPixelType t)
-    : begun(false), brightness(0), pixels(NULL), endTime(0) {
+    : begun(false), brightness(0), pixels(NULL), palette(NULL), paletteSize(0),
+      endTime(0) {
   updateType(t);
   updateLength(n);
   setPin(p);
@@ -110,14 +111,16 @@ Adafruit_NeoPixel::Adafruit_NeoPixel()
       is800KHz(true),
 #endif
       begun(false), numLEDs(0), numBytes(0), pin(-1), brightness(0),
-      pixels(NULL), rOffset(1), gOffset(0), bOffset(2), wOffset(1), endTime(0) {
+      pixels(NULL), palette(NULL), paletteSize(0), rOffset(1), gOffset(0),
+      bOffset(2), wOffset(1), endTime(0) {
 }
 
 /*!
   @brief   Deallocate Adafruit_NeoPixel object, set data pin back to INPUT.
 */
 Adafruit_NeoPixel::~Adafruit_NeoPixel() {
-  free(pixels);
+  neoFree(pixels);
+  neoFree(palette);
   if (pin >= 0)
     pinMode(pin, INPUT);
 }
@@ -144,12 +147,12 @@ void Adafruit_NeoPixel::begin(void) {
            type).
 */
 void Adafruit_NeoPixel::updateLength(uint16_t n) {
-  free(pixels); // Free existing data (if any)
+  neoFree(pixels); // Free existing data (if any)
 
   // Allocate new data -- note: ALL PIXELS ARE CLEARED
-  numBytes = n * ((wOffset == rOffset) ? 3 : 4);
-  if ((pixels = (uint8_t *)malloc(numBytes))) {
-    memset(pixels, 0, numBytes);
+  // (in palette mode each pixel is a single palette index byte)
+  numBytes = n * (palette ? 1 : ((wOffset == rOffset) ? 3 : 4));
+  if ((pixels = (uint8_t *)neoAlloc(numBytes))) {
     numLEDs = n;
   } else {
     numLEDs = numBytes = 0;
@@ -188,11 +191,151 @@ void Adafruit_NeoPixel::updateType(neoPixelType t) {
   // allocated), re-allocate to new size. Will clear any data.
   if (pixels) {
     bool newThreeBytesPerPixel = (wOffset == rOffset);
-    if (newThreeBytesPerPixel != oldThreeBytesPerPixel)
-      updateLength(numLEDs);
+    if (newThreeBytesPerPixel != oldThreeBytesPerPixel) {
+      if (palette)
+        setPaletteMode(paletteSize); // palette entries change size too
+      else
+        updateLength(numLEDs);
+    }
+  }
+}
+
+/*!
+  @brief   Switch the strip between palette mode and regular RGB(W) mode.
+           In palette mode each pixel is stored as a single byte, an index
+           into a table of up to 256 colors, cutting pixel RAM to a third
+           (a quarter for RGBW). Colors are looked up as data is issued to
+           the LEDs. Old data is deallocated and new data is cleared, and
+           all palette entries start out black.
+  @param   size  Number of palette entries, 1 to 256 (16 and 256 are
+                 typical), or 0 to return to regular RGB(W) pixels.
+  @return  true on success, false if size is out of range or memory could
+           not be allocated (the strip is then back in RGB(W) mode).
+  @note    setPixelColor() still works in palette mode, but has to search
+           the palette for the closest entry. Use setPixelIndex() and
+           setPaletteColor() where speed matters; changing a palette entry
+           recolors every pixel using it, which makes palette cycling
+           effects essentially free.
+*/
+bool Adafruit_NeoPixel::setPaletteMode(uint16_t size) {
+  uint16_t n = numLEDs;
+  neoFree(palette);
+  palette = NULL;
+  paletteSize = 0;
+  if ((size == 0) || (size > 256)) {
+    updateLength(n);
+    return (size == 0);
+  }
+
+  neoFree(pixels);
+  pixels = (uint8_t *)neoAlloc(n);
+  palette = (uint8_t *)neoAlloc(size * ((wOffset == rOffset) ? 3 : 4));
+  if (!pixels || !palette) {
+    neoFree(palette);
+    palette = NULL;
+    updateLength(n);
+    return false;
+  }
+  numLEDs = numBytes = n;
+  paletteSize = size;
+  return true;
+}
+
+/*!
+  @brief   Set a palette entry using a 32-bit 'packed' RGB or RGBW value.
+           Has no effect unless the strip is in palette mode.
+  @param   i  Palette index.
+  @param   c  32-bit color value. Most significant byte is white (for RGBW
+              pixels) or ignored (for RGB pixels), next is red, then green,
+              and least significant byte is blue.
+*/
+void Adafruit_NeoPixel::setPaletteColor(uint8_t i, uint32_t c) {
+  if (i < paletteSize) {
+    uint8_t *p, r = (uint8_t)(c >> 16), g = (uint8_t)(c >> 8), b = (uint8_t)c,
+                w = (uint8_t)(c >> 24);
+    if (brightness) { // See notes in setBrightness()
+      r = (r * brightness) >> 8;
+      g = (g * brightness) >> 8;
+      b = (b * brightness) >> 8;
+      w = (w * brightness) >> 8;
+    }
+    if (wOffset == rOffset) {
+      p = &palette[i * 3];
+    } else {
+      p = &palette[i * 4];
+      p[wOffset] = w;
+    }
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
   }
 }
 
+/*!
+  @brief   Query a palette entry.
+  @param   i  Palette index.
+  @return  'Packed' 32-bit RGB or WRGB value, 0 if not in palette mode or
+           i is out of range. Subject to the same brightness rounding as
+           getPixelColor().
+*/
+uint32_t Adafruit_NeoPixel::getPaletteColor(uint8_t i) const {
+  if (i >= paletteSize)
+    return 0;
+  return unpackColor(&palette[i * ((wOffset == rOffset) ? 3 : 4)]);
+}
+
+/*!
+  @brief   Set a pixel to a palette entry (palette mode only).
+  @param   n  Pixel index, starting from 0.
+  @param   i  Palette index.
+*/
+void Adafruit_NeoPixel::setPixelIndex(uint16_t n, uint8_t i) {
+  if (palette && (n < numLEDs) && (i < paletteSize))
+    pixels[n] = i;
+}
+
+/*!
+  @brief   Query the palette index of a pixel (palette mode only).
+  @param   n  Index of pixel to read (0 = first).
+  @return  Palette index, 0 if not in palette mode or n is out of range.
+*/
+uint8_t Adafruit_NeoPixel::getPixelIndex(uint16_t n) const {
+  if (!palette || (n >= numLEDs))
+    return 0;
+  return pixels[n];
+}
+
+/*!
+  @brief   Find the palette entry closest to a color (sum of absolute
+           component differences).
+  @param   r  Red, already scaled by the strip brightness.
+  @param   g  Green, already scaled by the strip brightness.
+  @param   b  Blue, already scaled by the strip brightness.
+  @param   w  White, already scaled by the strip brightness (ignored for
+              RGB pixels).
+  @return  Palette index.
+*/
+uint8_t Adafruit_NeoPixel::closestPaletteIndex(uint8_t r, uint8_t g, uint8_t b,
+                                               uint8_t w) const {
+  uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4, best = 0;
+  uint16_t bestDist = 0xFFFF;
+  const uint8_t *p = palette;
+  for (uint16_t i = 0; i < paletteSize; i++, p += bytesPerPixel) {
+    uint16_t dist = abs((int16_t)p[rOffset] - r) +
+                    abs((int16_t)p[gOffset] - g) +
+                    abs((int16_t)p[bOffset] - b);
+    if (bytesPerPixel == 4)
+      dist += abs((int16_t)p[wOffset] - w);
+    if (dist < bestDist) {
+      bestDist = dist;
+      best = i;
+      if (dist == 0)
+        break;
+    }
+  }
+  return best;
+}
+
 // RP2040 specific driver
 #if defined(ARDUINO_ARCH_RP2040)
 void Adafruit_NeoPixel::rp2040Init(uint8_t pin, bool is800KHz)
@@ -251,15 +394,43 @@ extern "C" void k210Show(uint8_t pin, uint8_t *pixels, uint32_t numBytes,
            that the Arduino millis() and micros() functions, which require
            interrupts, will lose small intervals of time whenever this
            function is called (about 30 microseconds per RGB pixel, 40 for
-           RGBW pixels). There's no easy fix for this, but a few
-           specialized alternative or companion libraries exist that use
-           very device-specific peripherals to work around it.
+           RGBW pixels). On AVR, show() credits that time back afterwards
+           from the known length of the data stream, so millis() and
+           micros() keep running true. Elsewhere there's no easy fix for
+           this, but a few specialized alternative or companion libraries
+           exist that use very device-specific peripherals to work around
+           it.
 */
 void Adafruit_NeoPixel::show(void) {
 
   if (!pixels)
     return;
 
+#if !defined(__AVR__)
+  // Palette mode on larger MCUs: expand into a temporary buffer and issue
+  // that. AVR looks colors up while issuing data, see below.
+  if (palette) {
+    uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
+    uint8_t *indices = pixels, *pal = palette;
+    uint16_t n = numBytes;
+    uint8_t *expanded = (uint8_t *)neoAlloc(numLEDs * bytesPerPixel);
+    if (!expanded)
+      return;
+    for (uint16_t i = 0; i < numLEDs; i++)
+      memcpy(&expanded[i * bytesPerPixel], &pal[indices[i] * bytesPerPixel],
+             bytesPerPixel);
+    pixels = expanded;
+    numBytes = numLEDs * bytesPerPixel;
+    palette = NULL;
+    show();
+    pixels = indices;
+    numBytes = n;
+    palette = pal;
+    neoFree(expanded);
+    return;
+  }
+#endif
+
   // Data latch = 300+ microsecond pause in the output stream. Rather than
   // put a delay at the end of the function, the ending time is noted and
   // the function will simply hold off (if needed) on issuing the
@@ -290,8 +461,26 @@ void Adafruit_NeoPixel::show(void) {
 #if defined(__AVR__)
   // AVR MCUs -- ATmega & ATtiny (no XMEGA) ---------------------------------
 
-  volatile uint16_t i = numBytes; // Loop counter
-  volatile uint8_t *ptr = pixels, // Pointer to next byte
+  // In palette mode there's no room for the color lookup inside the timed
+  // loops, so the code below runs once per pixel, issuing its palette entry
+  // directly. The few instructions spent between pixels merely stretch the
+  // low part of a bit, far from the latch time.
+  uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
+  uint16_t passes = palette ? numLEDs : 1;
+
+#if defined(TIFR0)
+  // Timer0 keeps counting while interrupts are off, but only one of its
+  // overflows can stay pending, so millis() would lose about a millisecond
+  // for every further 1024 us spent here. Note where it started from, to
+  // credit the missed overflows at the end.
+  uint8_t t0Start = TCNT0;
+  bool t0Pending = (TIFR0 & _BV(TOV0)) && (t0Start < 255);
+#endif
+  for (uint16_t pass = 0; pass < passes; pass++) {
+
+  volatile uint16_t i = palette ? bytesPerPixel : numBytes; // Loop counter
+  volatile uint8_t *ptr = palette ? &palette[pixels[pass] * bytesPerPixel]
+                                  : pixels, // Pointer to next byte
       b = *ptr++,                 // Current byte value
       hi,                         // PORT w/output bit set high
       lo;                         // PORT w/output bit set low
@@ -1667,6 +1856,8 @@ void Adafruit_NeoPixel::show(void) {
 #error "CPU SPEED NOT SUPPORTED"
 #endif // end F_CPU ifdefs on __AVR__
 
+  } // passes
+
   // END AVR ----------------------------------------------------------------
 
 #elif defined(__arm__)
@@ -3031,6 +3222,21 @@ if(is800KHz) {
 
   // END ARCHITECTURE SELECT ------------------------------------------------
 
+#if defined(__AVR__) && defined(TIFR0)
+  // Every bit takes the same time, so the stream length in timer0 ticks is
+  // known up front. The odd cycles spent between bytes and pixels only
+  // make it a little longer, which creditTimer0Ticks() corrects from the
+  // final timer0 count.
+  uint32_t t0Ticks =
+      (uint32_t)(palette ? numLEDs * bytesPerPixel : numBytes) * 8 *
+      (F_CPU / 800000UL) / 64;
+#if defined(NEO_KHZ400)
+  if (!is800KHz)
+    t0Ticks *= 2;
+#endif
+  creditTimer0Ticks(t0Start, t0Pending, t0Ticks);
+#endif
+
 #if !(defined(NRF52) || defined(NRF52_SERIES))
   interrupts();
 #endif
@@ -3078,6 +3284,10 @@ void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g,
       g = (g * brightness) >> 8;
       b = (b * brightness) >> 8;
     }
+    if (palette) {
+      pixels[n] = closestPaletteIndex(r, g, b, 0);
+      return;
+    }
     uint8_t *p;
     if (wOffset == rOffset) { // Is an RGB-type strip
       p = &pixels[n * 3];     // 3 bytes per pixel
@@ -3111,6 +3321,10 @@ void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g,
       b = (b * brightness) >> 8;
       w = (w * brightness) >> 8;
     }
+    if (palette) {
+      pixels[n] = closestPaletteIndex(r, g, b, w);
+      return;
+    }
     uint8_t *p;
     if (wOffset == rOffset) { // Is an RGB-type strip
       p = &pixels[n * 3];     // 3 bytes per pixel (ignore W)
@@ -3139,6 +3353,12 @@ void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
       g = (g * brightness) >> 8;
       b = (b * brightness) >> 8;
     }
+    if (palette) {
+      uint8_t w = (uint8_t)(c >> 24);
+      pixels[n] = closestPaletteIndex(r, g, b,
+                                      brightness ? ((w * brightness) >> 8) : w);
+      return;
+    }
     if (wOffset == rOffset) {
       p = &pixels[n * 3];
     } else {
@@ -3300,10 +3520,21 @@ uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
   if (n >= numLEDs)
     return 0; // Out of bounds, return no color.
 
-  uint8_t *p;
+  uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
+  if (palette)
+    return unpackColor(&palette[pixels[n] * bytesPerPixel]);
+  return unpackColor(&pixels[n * bytesPerPixel]);
+}
 
+/*!
+  @brief   Convert one pixel's worth of device-native data (a la the NEO_*
+           constants) back to a 'packed' color, undoing the brightness
+           scaling as far as possible.
+  @param   p  Pointer to the 3 or 4 bytes of a pixel or palette entry.
+  @return  'Packed' 32-bit RGB or WRGB value.
+*/
+uint32_t Adafruit_NeoPixel::unpackColor(const uint8_t *p) const {
   if (wOffset == rOffset) { // Is RGB-type device
-    p = &pixels[n * 3];
     if (brightness) {
       // Stored color was decimated by setBrightness(). Returned value
       // attempts to scale back to an approximation of the original 24-bit
@@ -3319,7 +3550,6 @@ uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
              (uint32_t)p[bOffset];
     }
   } else { // Is RGBW-type device
-    p = &pixels[n * 4];
     if (brightness) { // Return scaled color
       return (((uint32_t)(p[wOffset] << 8) / brightness) << 24) |
              (((uint32_t)(p[rOffset] << 8) / brightness) << 16) |
@@ -3366,8 +3596,11 @@ void Adafruit_NeoPixel::setBrightness(uint8_t b) {
     // the limited number of steps (quantization) in the old data will be
     // quite visible in the re-scaled version. For a non-destructive
     // change, you'll need to re-render the full strip data. C'est la vie.
-    uint8_t c, *ptr = pixels,
+    // In palette mode only the palette needs scaling.
+    uint8_t c, *ptr = palette ? palette : pixels,
                oldBrightness = brightness - 1; // De-wrap old brightness value
+    uint16_t count =
+        palette ? paletteSize * ((wOffset == rOffset) ? 3 : 4) : numBytes;
     uint16_t scale;
     if (oldBrightness == 0)
       scale = 0; // Avoid /0
@@ -3375,7 +3608,7 @@ void Adafruit_NeoPixel::setBrightness(uint8_t b) {
       scale = 65535 / oldBrightness;
     else
       scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
-    for (uint16_t i = 0; i < numBytes; i++) {
+    for (uint16_t i = 0; i < count; i++) {
       c = *ptr;
       *ptr++ = (c * scale) >> 8;
     }
@@ -0,0 +1,255 @@
+/*!
+ * @file NeoPixelReceiver.cpp
+ *
+ * Serial frame receiver for Adafruit_NeoPixel.
+ *
+ * The parser runs in the RX interrupt, one byte at a time. Data bytes are
+ * scaled by the strip brightness and stored at their color's offset in
+ * the pixel buffer, so after the last byte the buffer holds the frame
+ * exactly as setPixelColor() would have left it, and the main loop only
+ * has to show() it. At 1 Mbaud a byte arrives every 10 us (160 cycles at
+ * 16 MHz), which the data path fits in with plenty to spare; a 176 pixel
+ * frame takes 5.3 ms to arrive and 5.3 ms to show, which allows for
+ * about 90 frames per second.
+ *
+ * This file is part of the Adafruit_NeoPixel library.
+ *
+ * Adafruit_NeoPixel is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Adafruit_NeoPixel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with NeoPixel.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <NeoPixelReceiver.h>
+
+// Parser states
+enum {
+  RX_IDLE,      // Waiting for a header
+  RX_ADA_D,     // Got 'A'
+  RX_ADA_A,     // Got 'Ad'
+  RX_ADA_HI,    // Got 'Ada'
+  RX_ADA_LO,    // Got the pixel count high byte
+  RX_ADA_CHECK, // Got the pixel count low byte
+  RX_TPM2_TYPE, // Got 0xC9
+  RX_TPM2_HI,   // Got the data frame type
+  RX_TPM2_LO,   // Got the length high byte
+  RX_DATA,      // Receiving pixels
+  RX_TPM2_END,  // Waiting for the end byte
+  RX_DONE       // Frame complete, waiting for update()
+};
+
+NeoPixelReceiver *NeoPixelReceiver::active = NULL;
+
+NeoPixelReceiver::NeoPixelReceiver(Adafruit_NeoPixel &strip,
+                                   HardwareSerial &serial)
+    : strip(strip), serial(serial), state(RX_IDLE), holding(false),
+      wanted(false), writing(false), tpm2(false), lenHi(0),
+      lenLo(0), length(0), count(0), limit(0), dst(NULL), channel(0),
+      bytesPerPixel(3), scale(256), frames(0), errors(0), lastFrame(0),
+      lastCount(0), lastByte(0) {}
+
+/*!
+  @brief   Open the serial port and start receiving frames. Bytes arriving
+           on the port no longer go to read(). Sends "Ada\n", which
+           Adalight senders wait for before they start.
+  @param   baud  Baud rate, e.g. 1000000 (exact at 16 MHz).
+  @return  true on success, false if the strip has no pixel buffer or is
+           in palette mode.
+*/
+bool NeoPixelReceiver::begin(unsigned long baud) {
+  if (!strip.pixels || strip.palette)
+    return false;
+  bytesPerPixel = (strip.wOffset == strip.rOffset) ? 3 : 4;
+  offset[0] = strip.rOffset;
+  offset[1] = strip.gOffset;
+  offset[2] = strip.bOffset;
+  offset[3] = strip.wOffset;
+  scale = strip.getBrightness() + 1;
+  state = RX_IDLE;
+  holding = wanted = false;
+  active = this;
+  serial.begin(baud);
+  serial.attachRxHandler(rxHandler);
+  serial.print(F("Ada\n"));
+  return true;
+}
+
+/*!
+  @brief   Stop receiving frames. The port stays open and bytes go to
+           read() again.
+*/
+void NeoPixelReceiver::end(void) {
+  serial.attachRxHandler(NULL);
+  if (active == this)
+    active = NULL;
+  holding = false;
+}
+
+/*!
+  @brief   Show a frame if a complete one has arrived, then acknowledge it
+           and get ready for the next. Call this every time through the
+           main loop, before drawing anything, and skip the drawing while
+           isStreaming() is true. Takes the strip when a stream starts and
+           lets it go when it stops, and drops a frame whose data stops
+           coming for NEO_RX_TIMEOUT ms.
+  @return  true if a frame was shown.
+*/
+bool NeoPixelReceiver::update(void) {
+  unsigned long now = millis();
+  if (wanted) {
+    // The sketch is between frames here, and stops drawing as soon as it
+    // sees isStreaming(), so the next frame can go to the strip
+    wanted = false;
+    holding = true;
+    lastFrame = now;
+  }
+  if (state != RX_DONE) {
+    // A frame that stops arriving, or a header misread from noise, would
+    // otherwise swallow the next frames' bytes as its data
+    noInterrupts();
+    if ((state != RX_DATA) || (count != lastCount)) {
+      lastCount = count;
+      lastByte = now;
+    } else if (now - lastByte > NEO_RX_TIMEOUT) {
+      state = RX_IDLE;
+      errors++;
+    }
+    // Not while pixels are coming in, which would tear the sketch's frame
+    if (holding && (state < RX_DATA) && (now - lastFrame > NEO_RX_HOLD))
+      holding = false;
+    interrupts();
+    return false;
+  }
+  if (writing) {
+    strip.show();
+    frames++;
+  }
+  lastFrame = millis();
+  scale = strip.getBrightness() + 1; // In case it changed
+  state = RX_IDLE;
+  serial.write(NEO_RX_ACK);
+  return writing;
+}
+
+/*!
+  @brief   Check whether a frame is coming in. The sketch's show() should
+           wait, it would lose the frame's bytes, and so should other
+           output on the port, since a sender waiting for its NEO_RX_ACK
+           takes any 0xAC for one.
+  @return  true from a valid header until update() is done with the frame.
+*/
+bool NeoPixelReceiver::isReceiving(void) const { return state >= RX_DATA; }
+
+void NeoPixelReceiver::rxHandler(unsigned char c) {
+  if (active)
+    active->receive(c);
+}
+
+// Advance the parser by one byte, called from the RX interrupt
+void NeoPixelReceiver::receive(uint8_t c) {
+  switch (state) {
+  case RX_DATA:
+    if (count < limit) {
+      dst[offset[channel]] = ((uint16_t)c * scale) >> 8;
+      if (++channel == 3) {
+        if (bytesPerPixel == 4)
+          dst[offset[3]] = 0;
+        channel = 0;
+        dst += bytesPerPixel;
+      }
+    }
+    if (++count == length)
+      state = tpm2 ? RX_TPM2_END : RX_DONE;
+    return;
+  case RX_ADA_D:
+    if (c == 'd')
+      state = RX_ADA_A;
+    else
+      sync(c);
+    return;
+  case RX_ADA_A:
+    if (c == 'a')
+      state = RX_ADA_HI;
+    else
+      sync(c);
+    return;
+  case RX_ADA_HI:
+    lenHi = c;
+    state = RX_ADA_LO;
+    return;
+  case RX_ADA_LO:
+    lenLo = c;
+    state = RX_ADA_CHECK;
+    return;
+  case RX_ADA_CHECK: {
+    uint16_t pixels = ((uint16_t)lenHi << 8 | lenLo) + 1;
+    if ((c != (lenHi ^ lenLo ^ 0x55)) || (pixels > 0xFFFF / 3)) {
+      errors++;
+      sync(c);
+      return;
+    }
+    tpm2 = false;
+    length = pixels * 3;
+    break;
+  }
+  case RX_TPM2_TYPE:
+    if (c == 0xDA)
+      state = RX_TPM2_HI;
+    else
+      sync(c); // Other packet types aren't supported
+    return;
+  case RX_TPM2_HI:
+    lenHi = c;
+    state = RX_TPM2_LO;
+    return;
+  case RX_TPM2_LO:
+    tpm2 = true;
+    length = (uint16_t)lenHi << 8 | c;
+    if (!length) {
+      state = RX_TPM2_END;
+      return;
+    }
+    break;
+  case RX_TPM2_END:
+    if (c == 0x36) {
+      state = RX_DONE;
+    } else {
+      errors++;
+      sync(c);
+    }
+    return;
+  case RX_DONE:
+    return; // The sender should be waiting for the ACK
+  default:
+    sync(c);
+    return;
+  }
+
+  // Header complete, data follows. Until update() has taken the strip from
+  // the sketch, which may be drawing into it or showing it, the frame is
+  // parsed and acknowledged but not stored
+  uint16_t size = strip.numLEDs * 3;
+  writing = holding;
+  if (!writing)
+    wanted = true;
+  limit = writing ? min(length, size) : 0;
+  count = 0;
+  channel = 0;
+  dst = strip.pixels;
+  state = RX_DATA;
+}
+
+// Look for the start of a header
+void NeoPixelReceiver::sync(uint8_t c) {
+  state = (c == 'A') ? RX_ADA_D : (c == 0xC9) ? RX_TPM2_TYPE : RX_IDLE;
+}
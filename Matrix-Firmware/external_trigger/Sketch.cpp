@@ -1,19 +1,41 @@
 ﻿#include <Arduino.h>
+#include <FixedString.h>
+#include <MemoryStats.h>
+#include <Telemetry.h>
 
 #include <Adafruit_NeoMatrix.h>
+#include <NeoMatrixSprites.h>
+#include <NeoMatrixTicker.h>
+#include <NeoPixelReceiver.h>
 #include <gamma.h>
 #include <Fonts/TomThumb.h>
 
 #include <WS2812FX.h>
+#include <BeatClock.h>
 
 #define LED_COUNT 176
 #define LED_PIN 8
+#define LED_TYPE (NEO_GRB + NEO_KHZ800)
 #define ANALOG_PIN A0
+#define STREAM_BAUD 1000000
+#define TELEMETRY_INTERVAL 100
+#define TELEMETRY_STATUS 1
+#define TELEMETRY_MEMORY 2
+#define MEMORY_INTERVAL 1000
 
 void advanceAniColor();
 double approxRollingAverage(double avg, double new_sample, double N);
 bool calculateBallPath();
 
+// Retained scene for the animations made of a few rectangles (ANI1, ANI2
+// and Pong), so a frame only redraws what changed
+enum pongItem_e {PONG_NET, PONG_LEFT, PONG_RIGHT, PONG_BALL, ANI_SCENE_NUM};
+
+// The pixels, sprite slots and ticker columns all live here instead of
+// the heap; it must come before the objects that allocate from it
+NEO_ARENA(ledArena, Adafruit_NeoPixel::arenaSize(LED_COUNT, LED_TYPE) +
+	NeoMatrixSprites::arenaSize(ANI_SCENE_NUM) + NeoMatrixTicker::arenaSize(16));
+
 // Parameter 1 = number of pixels in strip
 // Parameter 2 = Arduino pin number (most are valid)
 // Parameter 3 = Neo_Matrix options concerning the layout of the matrix as LEDs
@@ -23,7 +45,35 @@ bool calculateBallPath();
 //   NEO_GRB     Pixels are wired for GRB bit stream (most NeoPixel products)
 //   NEO_RGB     Pixels are wired for RGB bit stream (v1 FLORA pixels, not v2)
 //   NEO_RGBW    Pixels are wired for RGBW bit stream (NeoPixel RGBW products)
-Adafruit_NeoMatrix neoMatrix = Adafruit_NeoMatrix(16, 11, LED_PIN, NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_COLUMNS + NEO_MATRIX_PROGRESSIVE, NEO_GRB + NEO_KHZ800);
+Adafruit_NeoMatrix neoMatrix = Adafruit_NeoMatrix(16, 11, LED_PIN, NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_COLUMNS + NEO_MATRIX_PROGRESSIVE, LED_TYPE);
+
+// Phase locks to the triggers; its period replaces the rolling average once locked
+BeatClock beatClock;
+
+// Frames streamed from a PC (Adalight/TPM2) take over the matrix
+NeoPixelReceiver frameReceiver(neoMatrix, Serial);
+bool streamed = false;
+
+// Binary status reports on the same port, see tools/telemetry.py. They
+// pause while frames come in: a sender waiting for frameReceiver's ACK
+// would take any 0xAC in them for one
+Telemetry telemetry(Serial);
+
+// Scrolls the info caption above the red line
+NeoMatrixTicker infoTicker(neoMatrix, &TomThumb);
+
+// Retained scene for the items listed in pongItem_e
+NeoMatrixSprites aniScene(neoMatrix, ANI_SCENE_NUM);
+
+// Pixels written for the last frame shown
+uint16_t framePixels = 0;
+
+// Profiling, in timer 1 ticks (see beginTicks())
+unsigned long showTicks = 0;       // duration of the last show()
+unsigned long sampleTicks = 0;     // time of the last analog sample
+unsigned long triggerTicks = 0;    // time of the sample that triggered last
+bool triggerShown = true;          // last trigger already made it to the LEDs
+unsigned long triggerLatency = 0;  // from trigger sample to LEDs updated
 
 enum sysState_e {SYS_INIT, SYS_SHOWCAPTION, SYS_SHOWCAPTION_WAIT, SYS_INFO, SYS_INFO_WAIT, SYS_INFO_DRAW, SYS_ANI_WAIT, SYS_ANI};
 typedef enum sysState_e sysState_t;
@@ -52,12 +102,43 @@ struct waypoint_s {
 };
 typedef struct waypoint_s waypoint_t;
 
+// TELEMETRY_STATUS payload, little endian; levels in 1/16 ADC steps
+struct statusReport_s {
+	uint16_t sample;
+	int16_t avgAnalog;
+	int16_t triggerLow;
+	int16_t triggerHigh;
+	int16_t avgMin;
+	int16_t avgMax;
+	uint16_t bpm;
+	uint8_t confidence;
+	uint16_t framePixels;
+	uint16_t showMicros;
+	uint16_t triggerLatencyMicros;
+} __attribute__((packed));
+typedef struct statusReport_s statusReport_t;
+
+// TELEMETRY_MEMORY payload, little endian; sizes in bytes
+struct memoryReport_s {
+	uint16_t heapUsed;
+	uint16_t heapPeak;
+	uint16_t stackPeak;
+	uint16_t untouched;
+	uint16_t allocs;
+	uint16_t frees;
+	uint16_t failed;
+	uint16_t arenaSize;
+	uint16_t arenaPeak;
+} __attribute__((packed));
+typedef struct memoryReport_s memoryReport_t;
+
 unsigned long last_trigger = 0;
 unsigned long last_sample = 0;
 unsigned long last_draw = 0;
 unsigned long last_modechg = 0;
 unsigned long last_minmax = 0;
 unsigned long last_statusreport = 0;
+unsigned long last_memoryreport = 0;
 unsigned long last_btn_evt = 0;
 
 unsigned long lastStateChange = 0;
@@ -74,8 +155,10 @@ double avg_trigger_interval = 500.0;
 int button_state = HIGH;
 uint8_t brightness = 100;
 
-char caption1[6];
-char caption2[6];
+// Fixed size, so captions never touch the heap WS2812FX allocates from
+FixedString<5> caption1;
+FixedString<5> caption2;
+FixedString<15> infoText;
 
 sysState_t sysState;
 aniState_t aniState;
@@ -104,6 +187,7 @@ ballVector_t ballVector(pointXY_t p, double angle);
 
 void setup() {
 	now = millis();
+	beginTicks();
 	
 	neoMatrix.begin();
 	neoMatrix.setFont(&TomThumb);
@@ -112,13 +196,19 @@ void setup() {
 	neoMatrix.setBrightness(brightness);
 	neoMatrix.fillScreen(0);
 	
-	//Serial.begin(9600);
+	infoTicker.begin(0, 5, 16);
+	infoTicker.setColor(Adafruit_NeoPixel::Color(255, 255, 255));
+	infoTicker.setSpeed(12);
+	
+	aniScene.begin();
+	
+	frameReceiver.begin(STREAM_BAUD);
 	
 	pinMode(3, INPUT_PULLUP);
 
 	lastStateChange = now;
-	strcpy_P(caption1, PSTR("Init"));
-	strcpy_P(caption2, PSTR("v1.1"));
+	caption1 = F("Init");
+	caption2 = F("v1.1");
 	
 	ballPathLength = 1;
 	ballPath[0].distance = 0.0;
@@ -149,8 +239,9 @@ void handleButton() {
 					} else {
 						aniState = ANI_OFF;
 					}
-					strcpy_P(caption1, PSTR("Mode"));
-					itoa(aniState, caption2, 10);
+					caption1 = F("Mode");
+					caption2.clear();
+					caption2.print((int) aniState);
 					sysState = SYS_SHOWCAPTION;
 				}
 			}
@@ -168,8 +259,15 @@ void handleTrigger() {
 			local_trigger_factor *= 0.8;
 		}
 		if (abs(sample - avgAnalog) > (((double) (avg_max - avg_min)) / 2.0 * local_trigger_factor)) {
-			avg_trigger_interval = approxRollingAverage(avg_trigger_interval, trigger_interval, 4);
+			beatClock.beat(now);
+			if (beatClock.isLocked()) {
+				avg_trigger_interval = beatClock.getPeriod();
+			} else {
+				avg_trigger_interval = approxRollingAverage(avg_trigger_interval, trigger_interval, 4);
+			}
 			last_trigger = now;
+			triggerTicks = sampleTicks;
+			triggerShown = false;
 			ani_trg_count++;
 			advanceAniColor();
 		}
@@ -186,6 +284,7 @@ void computeMinMax() {
 
 void sampleInput() {
 	sample = analogRead(ANALOG_PIN);
+	sampleTicks = ticks();
 	avgAnalog = approxRollingAverage(avgAnalog, sample, 1000);
 	min_sample = min(min_sample, sample);
 	max_sample = max(max_sample, sample);
@@ -212,7 +311,15 @@ bool screenUpdateRequired() {
 void refreshScreen() {
 	// redraw each 30 ms (approx. 30 fps), whenever this is needed
 	if (screenUpdateRequired()) {
+		unsigned long t = ticks();
 		neoMatrix.show();
+		showTicks = ticks() - t;
+		if (!triggerShown) {
+			triggerLatency = ticks() - triggerTicks;
+			triggerShown = true;
+		}
+		framePixels = neoMatrix.getPixelsWritten();
+		neoMatrix.resetPixelsWritten();
 		for (int i = 0; i < sizeof(aniParams) / sizeof(aniParams[0]); i++) {
 			lastAniParams[i] = aniParams[i];
 		}
@@ -439,7 +546,12 @@ void runAnimations() {
 	span = avg_max - avg_min;
 	relVal = min(1.0, abs(avgAnalog - sample) * 2.0 / span);
 	
-	neoMatrix.fillScreen(0);
+	// Scene animations repaint only what changed, the others just erase
+	// what they drew the last frame
+	bool retained = aniState == ANI1 || aniState == ANI2 || aniState == ANI4;
+	if (!retained) {
+		neoMatrix.eraseDamage();
+	}
 	
 	switch (aniState) {
 		case ANI1:
@@ -447,15 +559,14 @@ void runAnimations() {
 			if (ani_trg_count > neoMatrix.width()) {
 				ani_trg_count = 0;
 			}
-			for (int i = 0; i < ani_trg_count; i++) {
-				neoMatrix.drawFastVLine(i, 0, neoMatrix.height(), neoMatrix.Color(255, 255, 255));
-			}
+			// one bar per trigger, side by side
+			aniScene.setRect(0, 0, 0, ani_trg_count, neoMatrix.height(), neoMatrix.Color(255, 255, 255));
 			saveAniParams(ani_trg_count);
 			break;
 		case ANI2:
 			// filled rect, size proportional to sound level
 			//neoMatrix.drawRect(round(8.0 - relVal * 8.0), round(5.5 - relVal * 5.5), round(relVal * 16.0), round(relVal * 11.0), neoMatrix.Color(255, 255, 255));
-			neoMatrix.fillRect(round(8.0 - relVal * 8.0), round(5.5 - relVal * 5.5), round(relVal * 16.0), round(relVal * 11.0), aniColor);
+			aniScene.setRect(0, round(8.0 - relVal * 8.0), round(5.5 - relVal * 5.5), round(relVal * 16.0), round(relVal * 11.0), aniColor);
 			saveAniParams(round(8.0 - relVal * 8.0), round(5.5 - relVal * 5.5), round(relVal * 16.0), round(relVal * 11.0), aniColor);
 			break;
 		case ANI3:
@@ -494,17 +605,17 @@ void runAnimations() {
 				calculateBallPath();
 			}
 			// Net
-			neoMatrix.drawFastVLine(7, 0, neoMatrix.height(), neoMatrix.Color(100, 100, 100));
-			neoMatrix.drawFastVLine(8, 0, neoMatrix.height(), neoMatrix.Color(100, 100, 100));
+			aniScene.setRect(PONG_NET, 7, 0, 2, neoMatrix.height(), neoMatrix.Color(100, 100, 100));
 			// Players
-			neoMatrix.drawLine(round(ballPath[0].bV.start.x), round(ballPath[0].bV.start.y - 1), round(ballPath[0].bV.start.x), round(ballPath[0].bV.start.y + 1), neoMatrix.Color(255, 255, 255));
-			neoMatrix.drawLine(round(ballPath[ballPathLength - 1].bV.start.x), round(ballPath[ballPathLength - 1].bV.start.y - 1), round(ballPath[ballPathLength - 1].bV.start.x), round(ballPath[ballPathLength - 1].bV.start.y + 1), neoMatrix.Color(255, 255, 255));
+			aniScene.setRect(PONG_LEFT, round(ballPath[0].bV.start.x), round(ballPath[0].bV.start.y - 1), 1, 3, neoMatrix.Color(255, 255, 255));
+			aniScene.setRect(PONG_RIGHT, round(ballPath[ballPathLength - 1].bV.start.x), round(ballPath[ballPathLength - 1].bV.start.y - 1), 1, 3, neoMatrix.Color(255, 255, 255));
 			// Ball
 			ballProgress = (now - last_trigger) / ((double) avg_trigger_interval);
 			ballProgress = min(1.0, ballProgress);
 			ballPos = alongBallPath(ballProgress);
-			neoMatrix.drawPixel(round(ballPos.x), round(ballPos.y), aniColor);
-			saveAniParams(round(ballPos.x), round(ballPos.y), aniColor);
+			// Ball in 1/256 pixels, so it glides between pixels
+			aniScene.setPoint(PONG_BALL, ballPos.x * 256, ballPos.y * 256, aniColor);
+			saveAniParams(ballPos.x * 256, ballPos.y * 256, aniColor);
 			break;
 		case ANI5:
 			// VU-Meter animation
@@ -565,23 +676,50 @@ void runAnimations() {
 			saveAniParams(aniColor);
 			break;
 	}
+	if (retained) {
+		aniScene.update();
+	}
 	saveAniState();
 }
 
-void printDebugInfo() {
-	// Serial debug info
-	Serial.print("avgAnalog = ");
-	Serial.print(avgAnalog);
-	Serial.print(", trigger: [");
-	Serial.print(avgAnalog - (((double) (avg_max - avg_min)) / 2.0 * trigger_factor));
-	Serial.print(", ");
-	Serial.print(avgAnalog + (((double) (avg_max - avg_min)) / 2.0 * trigger_factor));
-	Serial.print("], was: [");
-	Serial.print(avg_min);
-	Serial.print(", ");
-	Serial.print(avg_max);
-	Serial.print("], delta = ");
-	Serial.println(avg_max - avg_min);
+int16_t toLevelQ4(double level) {
+	return (int16_t) (level * 16.0);
+}
+
+void sendTelemetry() {
+	// Fixed point fields, so nothing is formatted here and the report
+	// is queued whole or dropped, never waited for
+	double trigger_range = ((double) (avg_max - avg_min)) / 2.0 * trigger_factor;
+	statusReport_t report;
+	report.sample = sample;
+	report.avgAnalog = toLevelQ4(avgAnalog);
+	report.triggerLow = toLevelQ4(avgAnalog - trigger_range);
+	report.triggerHigh = toLevelQ4(avgAnalog + trigger_range);
+	report.avgMin = toLevelQ4(avg_min);
+	report.avgMax = toLevelQ4(avg_max);
+	report.bpm = beatClock.getBPM();
+	report.confidence = beatClock.getConfidence();
+	report.framePixels = framePixels;
+	report.showMicros = min(ticksToMicroseconds(showTicks), 0xFFFFUL);
+	report.triggerLatencyMicros = min(ticksToMicroseconds(triggerLatency), 0xFFFFUL);
+	telemetry.send(TELEMETRY_STATUS, &report, sizeof(report));
+}
+
+void sendMemoryReport() {
+	// Scans the stack paint, so it goes out less often than the status
+	memoryStats_t stats;
+	getMemoryStats(&stats);
+	memoryReport_t report;
+	report.heapUsed = stats.heapUsed;
+	report.heapPeak = stats.heapPeak;
+	report.stackPeak = stats.stackPeak;
+	report.untouched = stats.untouched;
+	report.allocs = stats.allocs;
+	report.frees = stats.frees;
+	report.failed = stats.failed;
+	report.arenaSize = ledArena.size();
+	report.arenaPeak = ledArena.peak();
+	telemetry.send(TELEMETRY_MEMORY, &report, sizeof(report));
 }
 
 void runSystem() {
@@ -613,16 +751,20 @@ void runSystem() {
 			if (now - lastStateChange > 1000) {
 				neoMatrix.fillScreen(0);
 				neoMatrix.setBrightness(brightness);
+				// the caption overwrote the scene, and the animation may have changed
+				for (int i = 0; i < ANI_SCENE_NUM; i++) {
+					aniScene.show(i, false);
+				}
+				aniScene.invalidate();
 				sysState = SYS_ANI;
 			}
 			break;
 		case SYS_INFO:
 			neoMatrix.fillScreen(0);
 			neoMatrix.setBrightness(25);
-			neoMatrix.setCursor(0, 5);
-			strcpy_P(caption1, PSTR("Line"));
-			neoMatrix.print(caption1);
-			neoMatrix.drawFastHLine(0, 5, 16, neoMatrix.Color(255,0,0));
+			infoText = F("Line  bpm ");
+			infoText.print(beatClock.getBPM());
+			infoTicker.setText(infoText.c_str());
 			sysState = SYS_INFO_DRAW;
 			break;
 		case SYS_INFO_WAIT:
@@ -631,6 +773,9 @@ void runSystem() {
 			}
 			break;
 		case SYS_INFO_DRAW:
+			infoTicker.update(now);
+			infoTicker.draw();
+			neoMatrix.drawFastHLine(0, 5, 16, neoMatrix.Color(255,0,0));
 			neoMatrix.fillRect(0, 7, 16, 3, neoMatrix.Color(0,0,0));
 			// Show a line, corresp: 0, 1024, avg, min, max, trigmin, trigmax
 			neoMatrix.drawFastHLine(0, 8, 16, neoMatrix.Color(255,255,255));
@@ -675,6 +820,19 @@ void runSystem() {
 void loop() {
 	now = millis();
 	
+	frameReceiver.update();
+	if (frameReceiver.isStreaming()) {
+		streamed = true;
+		return;
+	}
+	if (streamed) {
+		// Back from streaming, redraw everything
+		neoMatrix.fillScreen(0);
+		aniScene.invalidate();
+		lastAniParams[0] = ~aniParams[0]; // forces the next show()
+		streamed = false;
+	}
+	
 	if (now - last_sample > 1) {
 		sampleInput();
 		last_sample = now;
@@ -686,18 +844,26 @@ void loop() {
 	}
 	
 	handleTrigger();
+	beatClock.update(now);
 	
-	if (now - last_draw > 30) {
+	// show() holds off the RX interrupt, so not while a frame comes in
+	if (now - last_draw > 30 && !frameReceiver.isReceiving()) {
 		refreshScreen();
 		last_draw = now;
 	}
 	
 	runSystem();
 
-	/*if (now - last_statusreport > 2000) {
-		printDebugInfo();
-		last_statusreport = now;
-	};*/
+	if (!frameReceiver.isReceiving()) {
+		if (now - last_statusreport > TELEMETRY_INTERVAL) {
+			sendTelemetry();
+			last_statusreport = now;
+		}
+		if (now - last_memoryreport > MEMORY_INTERVAL) {
+			sendMemoryReport();
+			last_memoryreport = now;
+		}
+	}
 
 	handleButton();
 }
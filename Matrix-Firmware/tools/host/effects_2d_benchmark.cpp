@@ -0,0 +1,76 @@
+// 2D segments in WS2812FX: checks that the 2D modes stay inside their
+// rectangle and that 1D modes are refused on 2D segments, then measures
+// the host time per frame of every 2D mode on 16x11 and 16x16 matrices.
+// sources: libraries/WS2812FX/WS2812FX.cpp libraries/WS2812FX/modes.cpp libraries/WS2812FX/modes_2d.cpp libraries/WS2812FX/modes_funcs.cpp libraries/WS2812FX/BeatClock.cpp libraries/adafruit_neopixel/Adafruit_NeoPixel.cpp core/NeoArena.cpp libraries/adafruit_neomatrix/Adafruit_NeoMatrix.cpp libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/Print.cpp core/WString.cpp core/WMath.cpp
+#include <WS2812FX.h>
+#include <stdio.h>
+
+#define MATRIX_TYPE (NEO_MATRIX_TOP + NEO_MATRIX_LEFT + NEO_MATRIX_COLUMNS + NEO_MATRIX_ZIGZAG)
+
+static const uint8_t modes2D[] = {
+  FX_MODE_PLASMA, FX_MODE_FIRE_2D, FX_MODE_MATRIX_RAIN, FX_MODE_RIPPLE
+};
+
+static bool staysInside(uint8_t mode) {
+  const uint8_t x0 = 3, y0 = 2, w = 9, h = 6;
+  WS2812FX fx(16, 11, 8, MATRIX_TYPE);
+  fx.init();
+  fx.setSegment2D(0, x0, y0, w, h, mode, BLUE, 1000);
+  fx.start();
+  for (int frame = 0; frame < 200; frame++) {
+    fx.trigger();
+    fx.service();
+    for (uint8_t y = 0; y < 11; y++) {
+      for (uint8_t x = 0; x < 16; x++) {
+        bool inside = x >= x0 && x < x0 + w && y >= y0 && y < y0 + h;
+        if (!inside && fx.getPixelColor(fx.pixelIndex(x, y)) != 0) {
+          printf("%s: frame %d lit (%d, %d)\n", (const char *)fx.getModeName(mode), frame, x, y);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+static bool refuses1D() {
+  WS2812FX fx(16, 11, 8, MATRIX_TYPE);
+  fx.init();
+  fx.setSegment2D(0, 0, 0, 16, 11, FX_MODE_PLASMA, BLUE, 1000);
+  fx.setSegment2D(1, 0, 0, 4, 4, FX_MODE_LARSON_SCANNER, BLUE, 1000);
+  fx.setMode(0, FX_MODE_COMET);
+  return fx.getMode(0) == FX_MODE_PLASMA && fx.getNumSegments() == 1;
+}
+
+// host ns per frame, rendering and show()
+static double frameTime(int w, int h, uint8_t mode) {
+  const int frames = 5000;
+  WS2812FX fx(w, h, 8, MATRIX_TYPE);
+  fx.init();
+  fx.setSegment2D(0, 0, 0, w, h, mode, BLUE, 1000);
+  fx.start();
+  uint64_t start = hostNanos();
+  for (int i = 0; i < frames; i++) {
+    fx.trigger();
+    fx.service();
+  }
+  return (double)(hostNanos() - start) / frames;
+}
+
+int main() {
+  bool ok = refuses1D();
+  printf("1D modes refused on 2D segments: %s\n", ok ? "ok" : "FAIL");
+  for (uint8_t mode : modes2D) {
+    bool inside = staysInside(mode);
+    printf("%-12s stays inside its rectangle: %s\n", (const char *)WS2812FX(1, 1).getModeName(mode),
+           inside ? "ok" : "FAIL");
+    ok = ok && inside;
+  }
+
+  for (uint8_t mode : modes2D) {
+    WS2812FX fx(1, 1);
+    printf("%-12s 16x11 %6.0f ns/frame, 16x16 %6.0f ns/frame\n", (const char *)fx.getModeName(mode),
+           frameTime(16, 11, mode), frameTime(16, 16, mode));
+  }
+  return ok ? 0 : 1;
+}
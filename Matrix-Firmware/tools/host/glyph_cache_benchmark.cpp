@@ -0,0 +1,154 @@
+// Custom font text with the GFX glyph cache off, with 8 and with 32 slots:
+// checks that TomThumb and FreeSans9pt7b text, at size 1 and 2, comes out
+// the same as with the stock drawChar() loop (a flash read per 8 pixels, a
+// pixel or a size x size rectangle per set bit) and that getTextBounds()
+// doesn't change, then measures the host time and the flash bytes read per
+// character. Captions repeat a few characters, the character set cycles
+// through all 95 and so misses in 8 slots. The host reads flash like RAM,
+// so the flash bytes tell more about the AVR, where each is an LPM, than
+// the host time does.
+// sources: libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/NeoArena.cpp core/Print.cpp core/WString.cpp core/FixedString.cpp
+// flags: -no-pie -fno-pie -DHOST_COUNT_FLASH
+#include <Adafruit_GFX.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/TomThumb.h>
+#include <stdio.h>
+#include <string.h>
+
+#define WIDTH 256
+#define HEIGHT 160
+
+static const char captions[] = "Line  128 bpm\nMode 7\nInit v1.1\n";
+static char charset[128];
+
+static const struct {
+  const char *name;
+  const GFXfont *font;
+} fonts[] = {{"TomThumb", &TomThumb}, {"FreeSans9pt7b", &FreeSans9pt7b}};
+
+static const uint8_t cacheSlots[] = {0, 8, 32};
+
+// Adafruit_GFX::write() and drawChar() for custom fonts, as Adafruit ships
+// them, without text wrap
+static void stockText(Adafruit_GFX &gfx, const GFXfont *font, const char *text, uint8_t size) {
+  int16_t x = 0, y = 2 * font->yAdvance * size / 3;
+  for (; *text; text++) {
+    uint8_t c = *text;
+    if (c == '\n') {
+      x = 0;
+      y += font->yAdvance * size;
+      continue;
+    }
+    if (c < font->first || c > font->last) continue;
+    const GFXglyph *glyph = &font->glyph[c - font->first];
+    uint16_t bo = glyph->bitmapOffset;
+    uint8_t bits = 0, bit = 0;
+    for (uint8_t yy = 0; yy < glyph->height; yy++) {
+      for (uint8_t xx = 0; xx < glyph->width; xx++) {
+        if (!(bit++ & 7)) bits = font->bitmap[bo++];
+        if (bits & 0x80) {
+          if (size == 1)
+            gfx.drawPixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, 0xFFFF);
+          else
+            gfx.fillRect(x + (glyph->xOffset + xx) * size, y + (glyph->yOffset + yy) * size, size,
+                         size, 0xFFFF);
+        }
+        bits <<= 1;
+      }
+    }
+    x += glyph->xAdvance * size;
+  }
+}
+
+static void text(GFXcanvas16 &canvas, const GFXfont *font, const char *s, uint8_t size) {
+  canvas.setCursor(0, 2 * font->yAdvance * size / 3);
+  canvas.print(s);
+}
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what, const char *font, int slots, int size) {
+  if (!pass) {
+    printf("FAIL: %s, %s, %d slots, size %d\n", what, font, slots, size);
+    ok = false;
+  }
+}
+
+static void check(const char *name, const GFXfont *font) {
+  static GFXcanvas16 stock(WIDTH, HEIGHT), canvas(WIDTH, HEIGHT);
+  canvas.setTextWrap(false);
+  canvas.setTextColor(0xFFFF);
+  for (uint8_t size = 1; size <= 2; size++) {
+    const char *texts[] = {captions, charset};
+    for (const char *s : texts) {
+      stock.fillScreen(0);
+      stockText(stock, font, s, size);
+      canvas.setFont(font);
+      canvas.setTextSize(size);
+      int16_t x0, y0;
+      uint16_t w0, h0;
+      canvas.getTextBounds(s, 0, 0, &x0, &y0, &w0, &h0);
+      for (uint8_t slots : cacheSlots) {
+        expect(canvas.setGlyphCache(slots), "setGlyphCache", name, slots, size);
+        // twice, the second time from a warm cache
+        for (int pass = 0; pass < 2; pass++) {
+          canvas.fillScreen(0);
+          text(canvas, font, s, size);
+          expect(!memcmp(canvas.getBuffer(), stock.getBuffer(), WIDTH * HEIGHT * 2),
+                 "same pixels as the stock drawChar()", name, slots, size);
+          int16_t x1, y1;
+          uint16_t w1, h1;
+          canvas.getTextBounds(s, 0, 0, &x1, &y1, &w1, &h1);
+          expect(x1 == x0 && y1 == y0 && w1 == w0 && h1 == h0, "same text bounds", name, slots,
+                 size);
+        }
+      }
+      canvas.setGlyphCache(0);
+    }
+  }
+}
+
+// host ns and flash bytes per character of s at size 1
+static void measure(const GFXfont *font, uint8_t slots, const char *s, double *ns,
+                    double *flash) {
+  const int rounds = 2000;
+  static GFXcanvas16 canvas(WIDTH, HEIGHT);
+  canvas.setTextWrap(false);
+  canvas.setFont(font);
+  canvas.setGlyphCache(slots);
+  int chars = 0;
+  for (const char *p = s; *p; p++)
+    if (*p != '\n') chars++;
+  unsigned long reads = hostFlashReads;
+  uint64_t start = hostNanos();
+  for (int i = 0; i < rounds; i++) text(canvas, font, s, 1);
+  *ns = (double)(hostNanos() - start) / rounds / chars;
+  *flash = (double)(hostFlashReads - reads) / rounds / chars;
+  canvas.setGlyphCache(0);
+}
+
+int main() {
+  char *p = charset;
+  for (int c = ' '; c <= '~'; c++) {
+    *p++ = c;
+    if ((c - ' ') % 16 == 15) *p++ = '\n';
+  }
+  *p = 0;
+
+  for (auto &f : fonts) check(f.name, f.font);
+  printf("same text with and without the cache: %s\n", ok ? "ok" : "FAIL");
+
+  for (auto &f : fonts) {
+    for (uint8_t slots : cacheSlots) {
+      double captionNs, captionFlash, charsetNs, charsetFlash;
+      measure(f.font, slots, captions, &captionNs, &captionFlash);
+      measure(f.font, slots, charset, &charsetNs, &charsetFlash);
+      char cache[16];
+      snprintf(cache, sizeof(cache), slots ? "%d slots" : "cache off", slots);
+      printf("%-14s %-9s captions %5.0f ns, %5.1f flash bytes/char; charset %5.0f ns, %5.1f "
+             "flash bytes/char\n",
+             f.name, cache, captionNs, captionFlash, charsetNs, charsetFlash);
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Host side of the harnesses: the register file, the avr-libc functions
+// glibc lacks, a clock that only moves when told to, and a show() sink
+// (run.sh builds the core for KENDRYTE_K210, whose show() is k210Show()).
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+volatile uint8_t hostRegs[256];
+
+unsigned long hostMicros;
+void (*hostIdle)(void);
+unsigned long hostFlashReads;
+
+uint8_t hostShowData[HOST_SHOW_MAX];
+uint32_t hostShowBytes;
+unsigned long hostShows;
+
+extern "C" {
+
+static char *toBase(unsigned long value, char *s, int radix, bool negative) {
+  char tmp[33];
+  int n = 0;
+  do {
+    uint8_t digit = value % radix;
+    tmp[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= radix;
+  } while (value);
+  char *p = s;
+  if (negative) *p++ = '-';
+  while (n) *p++ = tmp[--n];
+  *p = 0;
+  return s;
+}
+
+char *itoa(int value, char *s, int radix) {
+  return ltoa(value, s, radix);
+}
+
+char *utoa(unsigned value, char *s, int radix) {
+  return toBase(value, s, radix, false);
+}
+
+// like avr-libc, only radix 10 has a sign
+char *ltoa(long value, char *s, int radix) {
+  if (radix == 10 && value < 0) return toBase(-(unsigned long)value, s, radix, true);
+  return toBase((unsigned long)value, s, radix, false);
+}
+
+char *ultoa(unsigned long value, char *s, int radix) {
+  return toBase(value, s, radix, false);
+}
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *s) {
+  sprintf(s, "%*.*f", width, prec, value);
+  return s;
+}
+
+void hostAdvance(unsigned long us) {
+  hostMicros += us;
+  if (hostIdle) hostIdle();
+}
+
+// reading the clock takes a microsecond, so loops that wait on millis()
+// or micros() run out just like on the MCU
+unsigned long millis(void) { hostAdvance(1); return hostMicros / 1000; }
+unsigned long micros(void) { hostAdvance(1); return hostMicros; }
+void delay(unsigned long ms) { hostAdvance(ms * 1000); }
+void delayMicroseconds(unsigned int us) { hostAdvance(us); }
+void yield(void) {}
+
+uint64_t hostNanos(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t val) { (void)pin; (void)val; }
+int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+
+void k210Show(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz) {
+  (void)pin;
+  (void)is800KHz;
+  hostShowBytes = numBytes < HOST_SHOW_MAX ? numBytes : HOST_SHOW_MAX;
+  memcpy(hostShowData, pixels, hostShowBytes);
+  hostShows++;
+  // the stream takes 10 us per byte at 800 kHz with the interrupts off,
+  // and with the latch time on top the next show() never has to wait for
+  // canShow()
+  uint8_t sreg = SREG;
+  SREG &= ~_BV(SREG_I);
+  hostAdvance(numBytes * 10);
+  SREG = sreg;
+  hostAdvance(300);
+}
+
+}
@@ -0,0 +1,2 @@
+// host stand-in for <avr/eeprom.h>
+#pragma once
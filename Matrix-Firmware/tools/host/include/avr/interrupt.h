@@ -0,0 +1,9 @@
+// host stand-in for <avr/interrupt.h>: a harness calls the vectors itself
+#pragma once
+#define sei()
+#define cli()
+#ifdef __cplusplus
+#define ISR(v, ...) extern "C" void v(void)
+#else
+#define ISR(v, ...) void v(void)
+#endif
@@ -0,0 +1,99 @@
+// host stand-in for <avr/io.h>: the ATmega328P registers the core uses,
+// backed by hostRegs[] (see host.cpp)
+#pragma once
+#include <stdint.h>
+extern volatile uint8_t hostRegs[256];
+#define _SFR_IO8(x) (hostRegs[x])
+#define _SFR_MEM8(x) (hostRegs[(x)&0xff])
+#define _SFR_MEM16(x) (*(volatile uint16_t*)&hostRegs[(x)&0xfe])
+#define _BV(b) (1<<(b))
+#define SREG hostRegs[0x3f]
+#define RAMEND 0x8FF
+#define TCNT0 hostRegs[0x46]
+#define TIFR0 hostRegs[0x35]
+#define TOV0 0
+#define TCNT1 _SFR_MEM16(0x84)
+#define TCCR1A hostRegs[0x80]
+#define TCCR1B hostRegs[0x81]
+#define TIMSK1 hostRegs[0x6f]
+#define TIFR1 hostRegs[0x36]
+#define TOV1 0
+#define TOIE1 0
+#define CS10 0
+#define CS11 1
+#define PORTB hostRegs[0x25]
+#define PORTC hostRegs[0x28]
+#define PORTD hostRegs[0x2b]
+#define DDRB hostRegs[0x24]
+#define DDRC hostRegs[0x27]
+#define DDRD hostRegs[0x2a]
+#define PINB hostRegs[0x23]
+#define PINC hostRegs[0x26]
+#define PIND hostRegs[0x29]
+#define SPCR hostRegs[0x4c]
+#define SPSR hostRegs[0x4d]
+#define SPDR hostRegs[0x4e]
+#define SPE 6
+#define MSTR 4
+#define DORD 5
+#define SPIF 7
+#define SPI2X 0
+#define SPR0 0
+#define SPR1 1
+#define CPOL 3
+#define CPHA 2
+#define SPIE 7
+#define EIMSK hostRegs[0x3d]
+#define GICR hostRegs[0x3d]
+#define TWBR hostRegs[0xb8]
+#define TWSR hostRegs[0xb9]
+#define TWAR hostRegs[0xba]
+#define TWDR hostRegs[0xbb]
+#define TWCR hostRegs[0xbc]
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWEN 2
+#define TWWC 3
+#define TWIE 0
+#define TWPS0 0
+#define TWPS1 1
+#define UBRR0H hostRegs[0xc5]
+#define UBRR0L hostRegs[0xc4]
+#define UCSR0A hostRegs[0xc0]
+#define UCSR0B hostRegs[0xc1]
+#define UCSR0C hostRegs[0xc2]
+#define UDR0 hostRegs[0xc6]
+#define RXEN0 4
+#define TXEN0 3
+#define RXCIE0 7
+#define UDRIE0 5
+#define U2X0 1
+#define UPE0 2
+#define TXC0 6
+#define UDRE0 5
+#define MPCM0 0
+#define UCSZ00 1
+#define UCSZ01 2
+#define USART_RX_vect __vector_18
+#define USART_UDRE_vect __vector_19
+#define TWI_vect __vector_24
+#define TIMER0_OVF_vect __vector_16
+#define TIMER1_OVF_vect __vector_13
+#define TCCR0A hostRegs[0x44]
+#define TCCR0B hostRegs[0x45]
+#define TIMSK0 hostRegs[0x6e]
+#define TOIE0 0
+#define CS00 0
+#define CS01 1
+#define WGM00 0
+#define WGM01 1
+#ifndef _SFR_IO_ADDR
+#define _SFR_IO_ADDR(sfr) 0x0B
+#endif
+#define _SFR_BYTE(x) (x)
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!((sfr) & _BV(bit)))
+#define SREG_I 7
+#define RAMSTART 0x100
@@ -0,0 +1,32 @@
+// host stand-in for <avr/pgmspace.h>: flash is ordinary memory
+#pragma once
+#include <string.h>
+#include <stdint.h>
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#ifdef HOST_COUNT_FLASH
+// a harness built with -DHOST_COUNT_FLASH counts the bytes read from flash
+#define pgm_read_byte(a) (hostFlashReads += 1, *(const uint8_t*)(a))
+#define pgm_read_word(a) (hostFlashReads += 2, *(const uint16_t*)(a))
+#define pgm_read_dword(a) (hostFlashReads += 4, *(const uint32_t*)(a))
+#else
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define pgm_read_word(a) (*(const uint16_t*)(a))
+#define pgm_read_dword(a) (*(const uint32_t*)(a))
+#endif
+#define pgm_read_ptr(a) (*(void* const*)(a))
+#define pgm_read_byte_near pgm_read_byte
+#define pgm_read_word_near pgm_read_word
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+#define strncmp_P strncmp
+#define strncasecmp_P strncasecmp
+#define strcasecmp_P strcasecmp
+#define strstr_P strstr
+#define sprintf_P sprintf
+typedef char prog_char;
+#define strnlen_P strnlen
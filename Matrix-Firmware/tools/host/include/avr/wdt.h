@@ -0,0 +1,2 @@
+// host stand-in for <avr/wdt.h>
+#pragma once
@@ -0,0 +1,41 @@
+// Included ahead of every source by run.sh. Declares the avr-libc functions
+// glibc lacks and the host clock, both implemented in host.cpp.
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char *itoa(int value, char *s, int radix);
+char *utoa(unsigned value, char *s, int radix);
+char *ltoa(long value, char *s, int radix);
+char *ultoa(unsigned long value, char *s, int radix);
+char *dtostrf(double value, signed char width, unsigned char prec, char *s);
+
+// millis() and micros() read hostMicros, which only moves when the
+// firmware reads it, delays or busy-waits, or when a harness calls
+// hostAdvance()
+extern unsigned long hostMicros;
+void hostAdvance(unsigned long us);
+
+// called on every hostAdvance(), e.g. to let a peripheral model run
+extern void (*hostIdle)(void);
+
+// wall clock time in ns, for benchmarks
+uint64_t hostNanos(void);
+
+// bytes read through pgm_read_byte/word/dword(), counted when a harness
+// is built with -DHOST_COUNT_FLASH
+extern unsigned long hostFlashReads;
+
+// a copy of what the last show() sent out, as the pixel buffer may
+// change again before show() returns
+#define HOST_SHOW_MAX 4096
+extern uint8_t hostShowData[HOST_SHOW_MAX];
+extern uint32_t hostShowBytes;
+extern unsigned long hostShows;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+// host stand-in for <util/atomic.h>: there is nothing to interrupt
+#pragma once
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK(x) for (int _once = 1; _once; _once = 0)
@@ -0,0 +1,4 @@
+// host stand-in for <util/delay.h>: busy-waits advance the host clock
+#pragma once
+#define _delay_us(us) hostAdvance((unsigned long)(us))
+#define _delay_ms(ms) hostAdvance((unsigned long)(ms) * 1000UL)
@@ -0,0 +1,210 @@
+// Lines on NeoMatrix: checks that writeLine(), which clips once and steps
+// through the buffer, sets the same pixels as Adafruit_GFX::writeLine()'s
+// drawPixel() per step, and that drawLineAA() blends the same pixels as an
+// unclipped Wu line drawn with writePixelBlend(). Covers every rotation,
+// with and without the index map and brightness, for lines on the matrix,
+// crossing it and far off it. A matrix whose remap function points past
+// the strip must give the same pixels and leave the block after the strip
+// alone. Then measures the host time per line, clipped against GFX.
+// sources: libraries/adafruit_neomatrix/Adafruit_NeoMatrix.cpp libraries/adafruit_neopixel/Adafruit_NeoPixel.cpp core/NeoArena.cpp libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/Print.cpp core/WString.cpp core/FixedString.cpp
+// flags: -no-pie -fno-pie
+#include <Adafruit_NeoMatrix.h>
+#include <NeoArena.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define W 16
+#define H 11
+#define LAYOUT (NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_COLUMNS + NEO_MATRIX_ZIGZAG)
+
+static void swap(int16_t &a, int16_t &b) {
+  int16_t t = a;
+  a = b;
+  b = t;
+}
+
+// The GFX line, one bounds checked drawPixel() per step; fast lines of
+// positive length go the same way
+class Reference : public Adafruit_NeoMatrix {
+public:
+  using Adafruit_NeoMatrix::Adafruit_NeoMatrix;
+  void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    Adafruit_GFX::writeLine(x0, y0, x1, y1, color);
+  }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    Adafruit_GFX::writeLine(x, y, x + w - 1, y, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    Adafruit_GFX::writeLine(x, y, x, y + h - 1, color);
+  }
+
+  // Wu's line over every step, the matrix drops what is off it
+  void drawLineAA(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+      swap(x0, y0);
+      swap(x1, y1);
+    }
+    if (x0 > x1) {
+      swap(x0, x1);
+      swap(y0, y1);
+    }
+    int32_t dx = x1 - x0, grad = dx ? (int32_t)(y1 - y0) * 65536 / dx : 0;
+    for (int32_t k = 0; k <= dx; k++) {
+      int32_t yq = (int32_t)y0 * 65536 + k * grad;
+      int16_t x = x0 + k, y = yq >> 16;
+      uint8_t f = yq >> 8;
+      blend(steep, x, y, color, 255 - f);
+      if (f) blend(steep, x, y + 1, color, f);
+    }
+  }
+
+private:
+  void blend(bool steep, int16_t x, int16_t y, uint16_t color, uint8_t alpha) {
+    if (steep)
+      writePixelBlend(y, x, color, alpha);
+    else
+      writePixelBlend(x, y, color, alpha);
+  }
+};
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what) {
+  if (!pass) {
+    printf("FAIL: %s\n", what);
+    ok = false;
+  }
+}
+
+// Random line with its ends within r of the middle
+static void randomLine(int r, int16_t *l) {
+  l[0] = rand() % (2 * r) - r + W / 2;
+  l[1] = rand() % (2 * r) - r + H / 2;
+  l[2] = rand() % (2 * r) - r + W / 2;
+  l[3] = rand() % (2 * r) - r + H / 2;
+}
+
+// Draws the same line both ways, returns whether the pixels match
+static bool sameLine(Adafruit_NeoMatrix &matrix, Reference &reference, int16_t *l, bool aa) {
+  uint16_t color = rand();
+  matrix.fillScreen(0x4208);
+  reference.fillScreen(0x4208);
+  if (aa) {
+    matrix.drawLineAA(l[0], l[1], l[2], l[3], color);
+    reference.drawLineAA(l[0], l[1], l[2], l[3], color);
+  } else {
+    matrix.drawLine(l[0], l[1], l[2], l[3], color);
+    reference.drawLine(l[0], l[1], l[2], l[3], color);
+  }
+  return !memcmp(matrix.getPixels(), reference.getPixels(), matrix.numPixels() * 3);
+}
+
+static void checkLines(void) {
+  const int ranges[] = {W, 20 * W, 500 * W};
+  for (int map = 0; map < 2; map++) {
+    for (uint8_t rotation = 0; rotation < 4; rotation++) {
+      for (int dim = 0; dim < 2; dim++) {
+        Adafruit_NeoMatrix matrix(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+        Reference reference(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+        Adafruit_NeoMatrix *both[] = {&matrix, &reference};
+        for (Adafruit_NeoMatrix *m : both) {
+          m->begin();
+          if (map) m->buildIndexMap();
+          m->setRotation(rotation);
+          if (dim) m->setBrightness(50);
+        }
+        bool lines = true, aa = true;
+        for (int i = 0; i < 3000; i++) {
+          int16_t l[4];
+          randomLine(ranges[i % 3], l);
+          lines = sameLine(matrix, reference, l, false) && lines;
+          aa = sameLine(matrix, reference, l, true) && aa;
+        }
+        expect(lines, "writeLine() against GFX");
+        expect(aa, "drawLineAA() against the unclipped Wu line");
+      }
+    }
+  }
+}
+
+// Skips the first rows of the strip, so the bottom of the matrix maps past
+// its end
+static uint16_t pastTheEnd(uint16_t x, uint16_t y) { return y * W + x + 3 * W; }
+
+static void checkPastTheEnd(void) {
+  Reference reference(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+  reference.begin();
+  reference.setRemapFunction(pastTheEnd);
+  NeoArenaBuffer<4096> arena;
+  for (int map = 0; map < 2; map++) {
+    Adafruit_NeoMatrix matrix(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+    uint8_t *guard = (uint8_t *)neoAlloc(64);
+    memset(guard, 0x5A, 64);
+    matrix.begin();
+    matrix.setRemapFunction(pastTheEnd);
+    if (map) expect(matrix.buildIndexMap(), "buildIndexMap()");
+    bool same = true;
+    for (int i = 0; i < 2000; i++) {
+      int16_t l[4];
+      randomLine(W, l);
+      same = sameLine(matrix, reference, l, i & 1) && same;
+      uint16_t color = rand();
+      int16_t w = 1 + rand() % W, h = 1 + rand() % H;
+      matrix.drawFastHLine(l[0], l[1], w, color);
+      matrix.drawFastVLine(l[0], l[1], h, color);
+      reference.drawFastHLine(l[0], l[1], w, color);
+      reference.drawFastVLine(l[0], l[1], h, color);
+      same = !memcmp(matrix.getPixels(), reference.getPixels(), W * H * 3) && same;
+    }
+    expect(same, map ? "past the strip, index map" : "past the strip");
+    bool untouched = true;
+    for (int i = 0; i < 64; i++) untouched = untouched && guard[i] == 0x5A;
+    expect(untouched, map ? "block after the strip, index map" : "block after the strip");
+    matrix.freeIndexMap();
+    neoFree(guard);
+  }
+}
+
+static int16_t timed[64][4];
+
+// Host ns per line over the timed lines
+static double measure(Adafruit_NeoMatrix &m, bool aa) {
+  const int rounds = 200000;
+  m.startWrite();
+  uint64_t start = hostNanos();
+  for (int i = 0; i < rounds; i++) {
+    int16_t *l = timed[i & 63];
+    if (aa)
+      m.drawLineAA(l[0], l[1], l[2], l[3], 0xFFFF);
+    else
+      m.writeLine(l[0], l[1], l[2], l[3], 0xFFFF);
+  }
+  m.endWrite();
+  return (double)(hostNanos() - start) / rounds;
+}
+
+int main() {
+  srand(5);
+  checkLines();
+  checkPastTheEnd();
+  printf("same pixels as the GFX lines: %s\n", ok ? "ok" : "FAIL");
+
+  Adafruit_NeoMatrix matrix(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+  Reference reference(W, H, 6, LAYOUT, NEO_GRB + NEO_KHZ800);
+  matrix.begin();
+  reference.begin();
+  matrix.buildIndexMap();
+  reference.buildIndexMap();
+  for (auto &l : timed) randomLine(W / 2, l);
+  printf("on the matrix:   clipped %5.1f ns, GFX %5.1f ns, Wu %5.1f ns\n",
+         measure(matrix, false), measure(reference, false), measure(matrix, true));
+  for (auto &l : timed) randomLine(6 * W, l);
+  printf("mostly off it:   clipped %5.1f ns, GFX %5.1f ns, Wu %5.1f ns\n",
+         measure(matrix, false), measure(reference, false), measure(matrix, true));
+  matrix.freeIndexMap();
+  for (auto &l : timed) randomLine(W / 2, l);
+  printf("no index map:    clipped %5.1f ns\n", measure(matrix, false));
+  return ok ? 0 : 1;
+}
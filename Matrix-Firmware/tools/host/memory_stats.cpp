@@ -0,0 +1,160 @@
+// MemoryStats heap counters, linked with malloc() and free() wrapped as a
+// sketch would be: allocations, frees, failures, new and delete must each
+// count once, and heapUsed and heapPeak must follow the block sizes malloc
+// reports. avr-libc's calloc() and realloc() call its malloc() and free(),
+// which --wrap also sends through the counters, so MemoryStats.cpp has to
+// keep those nested calls from counting twice. glibc's don't, so the
+// avr-libc ones are modelled here behind the wrappers.
+// sources: core/MemoryStats.cpp core/new.cpp
+// flags: -fno-builtin-malloc -fno-builtin-calloc -fno-builtin-realloc -fno-builtin-free -Wl,--wrap=malloc,--wrap=free
+#include <Arduino.h>
+#include <MemoryStats.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// What calloc() and realloc() become with --wrap=calloc,--wrap=realloc;
+// they go to the models below instead of glibc
+extern "C" void *__wrap_calloc(size_t count, size_t size);
+extern "C" void *__wrap_realloc(void *ptr, size_t size);
+
+// avr-libc's calloc(): malloc() and clear
+extern "C" void *__real_calloc(size_t count, size_t size) {
+  void *ptr = malloc(count * size);
+  if (ptr) memset(ptr, 0, count * size);
+  return ptr;
+}
+
+// avr-libc's realloc(): shrinks in place, otherwise moves the block with
+// malloc() and free()
+extern "C" void *__real_realloc(void *ptr, size_t size) {
+  if (!ptr) return malloc(size);
+  if (!size) {
+    free(ptr);
+    return NULL;
+  }
+  size_t old = malloc_usable_size(ptr);
+  if (size <= old) return ptr;
+  void *moved = malloc(size);
+  if (!moved) return NULL;
+  memcpy(moved, ptr, old);
+  free(ptr);
+  return moved;
+}
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what) {
+  if (!pass) {
+    printf("FAIL: %s\n", what);
+    ok = false;
+  }
+}
+
+// The counters as they should be, relative to where the harness started
+static memoryStats_t start;
+static size_t used, peak;
+static uint16_t allocs, frees, failed;
+
+static void allocated(void *ptr) {
+  used += malloc_usable_size(ptr);
+  if (used > peak) peak = used;
+  allocs++;
+}
+
+static void resized(size_t before, void *ptr) {
+  used += malloc_usable_size(ptr) - before;
+  if (used > peak) peak = used;
+}
+
+static void freed(size_t size) {
+  used -= size;
+  frees++;
+}
+
+// Compares the counters with what they should be after what
+static void check(const char *what) {
+  memoryStats_t stats;
+  getMemoryStats(&stats);
+  bool pass = stats.heapUsed - start.heapUsed == used &&
+              stats.heapPeak == max(start.heapPeak, start.heapUsed + peak) &&
+              (uint16_t)(stats.allocs - start.allocs) == allocs &&
+              (uint16_t)(stats.frees - start.frees) == frees &&
+              (uint16_t)(stats.failed - start.failed) == failed;
+  if (!pass)
+    printf("  %s: %u used, %u peak, %u allocs, %u frees, %u failed; expected %u, %u, %u, %u, "
+           "%u\n",
+           what, (unsigned)(stats.heapUsed - start.heapUsed), (unsigned)stats.heapPeak,
+           stats.allocs - start.allocs, stats.frees - start.frees, stats.failed - start.failed,
+           (unsigned)used, (unsigned)max(start.heapPeak, start.heapUsed + peak), allocs, frees,
+           failed);
+  expect(pass, what);
+}
+
+int main() {
+  getMemoryStats(&start);
+  const size_t huge = SIZE_MAX / 4;
+
+  void *a = malloc(100);
+  allocated(a);
+  check("malloc");
+  free(NULL);
+  check("free(NULL) doesn't count");
+
+  uint8_t *b = (uint8_t *)__wrap_calloc(10, 20);
+  allocated(b);
+  bool clear = true;
+  for (int i = 0; i < 200; i++) clear = clear && !b[i];
+  expect(clear, "calloc clears");
+  check("calloc counts once");
+
+  // grows, so the model moves it: malloc() and free() nested inside
+  size_t before = malloc_usable_size(a);
+  a = __wrap_realloc(a, 1000);
+  resized(before, a);
+  check("realloc that moves counts no alloc or free");
+
+  expect(__wrap_realloc(a, 10) == a, "realloc shrinks in place");
+  check("realloc in place");
+
+  void *c = __wrap_realloc(NULL, 50);
+  allocated(c);
+  check("realloc(NULL) counts an alloc");
+
+  before = malloc_usable_size(c);
+  expect(!__wrap_realloc(c, 0), "realloc(ptr, 0) returns NULL");
+  freed(before);
+  check("realloc(ptr, 0) counts a free");
+
+  expect(!malloc(huge), "huge malloc fails");
+  failed++;
+  check("failed malloc");
+  expect(!__wrap_calloc(huge, 1), "huge calloc fails");
+  failed++;
+  check("failed calloc counts once");
+  expect(!__wrap_realloc(b, huge), "huge realloc fails");
+  failed++;
+  check("failed realloc counts once, the block stays");
+
+  char *d = new char[64];
+  allocated(d);
+  check("new[]");
+  before = malloc_usable_size(d);
+  delete[] d;
+  freed(before);
+  check("delete[]");
+
+  before = malloc_usable_size(a);
+  free(a);
+  freed(before);
+  before = malloc_usable_size(b);
+  free(b);
+  freed(before);
+  check("all freed");
+  expect(used == 0 && allocs == frees, "nothing left");
+
+  printf("heap counters: %s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
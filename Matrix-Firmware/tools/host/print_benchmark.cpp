@@ -0,0 +1,202 @@
+// Print number formatting: checks print() of integers in bases 2-36 and of
+// doubles against the stock Arduino formatters (a division per digit, a
+// double multiply per decimal), and printFixed() against exact 64-bit
+// rounding, then measures the host cycles per formatted value of each,
+// against the stock versions of print(ulong) and print(double). The host
+// divides and multiplies doubles in hardware, so it shows the gap far
+// smaller than the AVR, where each is a libgcc or libm call.
+// sources: core/Print.cpp core/WString.cpp core/FixedString.cpp
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#define VALUES 4096
+#define ROUNDS 20
+
+// Collects what is printed
+class Capture : public Print {
+public:
+  char text[80];
+  int length;
+  Capture() : length(0) {}
+  size_t write(uint8_t c) {
+    text[length++] = c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) {
+    memcpy(text + length, buffer, size);
+    length += size;
+    return size;
+  }
+  const char *take(void) {
+    text[length] = 0;
+    length = 0;
+    return text;
+  }
+};
+
+// Print::printNumber() and Print::printFloat() as Arduino ships them
+static size_t stockNumber(Print &p, unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return p.write(str);
+}
+
+static size_t stockFloat(Print &p, double number, uint8_t digits) {
+  size_t n = 0;
+  if (isnan(number)) return p.print("nan");
+  if (isinf(number)) return p.print("inf");
+  if (number > 4294967040.0) return p.print("ovf");
+  if (number < -4294967040.0) return p.print("ovf");
+  if (number < 0.0) {
+    n += p.print('-');
+    number = -number;
+  }
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+  number += rounding;
+  unsigned long int_part = (unsigned long)number;
+  double remainder = number - (double)int_part;
+  n += stockNumber(p, int_part, 10);
+  if (digits > 0) n += p.print('.');
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int toPrint = (unsigned int)(remainder);
+    n += stockNumber(p, toPrint, 10);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+// printFixed(number, fracBits, digits) exactly, rounding half up
+static void exactFixed(char *out, long number, uint8_t fracBits, uint8_t digits) {
+  unsigned long long magnitude = number < 0 ? 0ULL - number : number;
+  unsigned long long scale = 1;
+  for (uint8_t i = 0; i < digits; i++) scale *= 10;
+  unsigned long long scaled = (magnitude * scale + (1ULL << fracBits >> 1)) >> fracBits;
+  out += sprintf(out, "%s%llu", number < 0 ? "-" : "", scaled / scale);
+  if (digits) sprintf(out, ".%0*llu", digits, scaled % scale);
+}
+
+static unsigned long values[VALUES];
+static double doubles[VALUES];
+static Capture capture;
+static char expected[80];
+static int mismatches;
+
+static void check(const char *what, const char *got) {
+  if (strcmp(got, expected) && ++mismatches <= 10)
+    printf("%s: \"%s\", expected \"%s\"\n", what, got, expected);
+}
+
+static void checkNumber(unsigned long v, int base) {
+  stockNumber(capture, v, base);
+  strcpy(expected, capture.take());
+  capture.print(v, base);
+  check("print(unsigned long)", capture.take());
+}
+
+static void checkSigned(long v) {
+  sprintf(expected, "%ld", v);
+  capture.print(v);
+  check("print(long)", capture.take());
+}
+
+static void checkFloat(double v, int digits) {
+  stockFloat(capture, v, digits);
+  strcpy(expected, capture.take());
+  capture.print(v, digits);
+  check("print(double)", capture.take());
+}
+
+static void checkFixed(long v, uint8_t fracBits, uint8_t digits) {
+  exactFixed(expected, v, fracBits, digits);
+  capture.printFixed(v, fracBits, digits);
+  check("printFixed()", capture.take());
+}
+
+// Best of ROUNDS passes over the values, in cycles per value
+template <typename F> static double cycles(F format) {
+  unsigned long long best = ~0ULL;
+  for (int r = 0; r < ROUNDS; r++) {
+    unsigned long long start = __rdtsc();
+    for (int i = 0; i < VALUES; i++) {
+      format(i);
+      capture.length = 0;
+    }
+    unsigned long long taken = __rdtsc() - start;
+    if (taken < best) best = taken;
+  }
+  return (double)best / VALUES;
+}
+
+int main() {
+  srand(3);
+  for (int i = 0; i < VALUES; i++) {
+    values[i] = ((unsigned long)rand() << 1 ^ rand()) >> (rand() % 32);
+    doubles[i] = (rand() % 2000000 - 1000000) / 1000.0 + rand() / (double)RAND_MAX;
+  }
+
+  static const unsigned long edges[] = {0, 1, 9, 10, 99, 100, 101, 999, 1000, 9999, 10000,
+                                        65535, 65536, 99999, 100000, 999999999UL,
+                                        1000000000UL, 4294967295UL};
+  for (unsigned long v : edges) {
+    for (int base = 2; base <= 36; base++) checkNumber(v, base);
+    checkSigned(v);
+    checkSigned(-(long)v);
+  }
+  checkSigned(-2147483647L - 1);
+  for (int i = 0; i < VALUES; i++) {
+    checkNumber(values[i], DEC);
+    checkNumber(values[i], HEX);
+    checkNumber(values[i], OCT);
+    checkNumber(values[i], BIN);
+    checkNumber(values[i], 7);
+    checkSigned((long)values[i] - 0x40000000L);
+  }
+
+  static const double floatEdges[] = {0.0, 1.999, -1.999, 0.005, 0.995, 123.456, 1e-7,
+                                      4294967040.0, 5e9, -5e9, NAN, INFINITY};
+  for (double v : floatEdges) {
+    for (int digits = 0; digits < 12; digits++) checkFloat(v, digits);
+  }
+  for (int i = 0; i < VALUES; i++) {
+    for (int digits = 0; digits < 7; digits++) checkFloat(doubles[i], digits);
+  }
+
+  for (uint8_t fracBits = 0; fracBits <= 16; fracBits++) {
+    for (uint8_t digits = 0; digits <= 4; digits++) {
+      checkFixed(0, fracBits, digits);
+      checkFixed(1, fracBits, digits);
+      checkFixed(-1, fracBits, digits);
+      checkFixed(0x7FFFFFFFL >> (16 - fracBits), fracBits, digits);
+      for (int i = 0; i < 256; i++) checkFixed((long)(doubles[i] * (1L << fracBits)), fracBits, digits);
+    }
+  }
+  printf("formatting matches: %s\n", mismatches ? "FAIL" : "ok");
+
+  printf("%-24s %7.1f cycles/value, stock %7.1f\n", "print(unsigned long)",
+         cycles([](int i) { capture.print(values[i]); }),
+         cycles([](int i) { stockNumber(capture, values[i], 10); }));
+  printf("%-24s %7.1f cycles/value, stock %7.1f\n", "print(unsigned long, HEX)",
+         cycles([](int i) { capture.print(values[i], HEX); }),
+         cycles([](int i) { stockNumber(capture, values[i], 16); }));
+  printf("%-24s %7.1f cycles/value, stock %7.1f\n", "print(double, 2)",
+         cycles([](int i) { capture.print(doubles[i]); }),
+         cycles([](int i) { stockFloat(capture, doubles[i], 2); }));
+  printf("%-24s %7.1f cycles/value, stock %7.1f\n", "print(double, 6)",
+         cycles([](int i) { capture.print(doubles[i], 6); }),
+         cycles([](int i) { stockFloat(capture, doubles[i], 6); }));
+  printf("%-24s %7.1f cycles/value\n", "printFixed(Q8, 2)",
+         cycles([](int i) { capture.printFixed((long)(doubles[i] * 256), 8); }));
+  return mismatches ? 1 : 0;
+}
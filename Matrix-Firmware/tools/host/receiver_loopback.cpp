@@ -0,0 +1,275 @@
+// NeoPixelReceiver loopback: a stand-in PC sender streams Adalight and TPM2
+// frames at 1 Mbaud into the real HardwareSerial RX interrupt while a
+// sketch-like loop keeps drawing and showing its own frames whenever the
+// receiver lets it. Every frame that reaches the LEDs must be either the
+// sketch's or one the sender sent, never a mix of the two, and the sketch
+// must get the strip back once the sender stops. With ACKs no byte may be
+// lost and no frame dropped, except at the start of a stream that begins
+// while the sketch is in show(), which loses its first header.
+// sources: core/HardwareSerial.cpp core/HardwareSerial0.cpp core/Print.cpp core/WString.cpp libraries/adafruit_neopixel/NeoPixelReceiver.cpp libraries/adafruit_neopixel/Adafruit_NeoPixel.cpp core/NeoArena.cpp
+#include <Adafruit_NeoPixel.h>
+#include <NeoPixelReceiver.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" void USART_RX_vect(void);
+extern "C" void USART_UDRE_vect(void);
+
+#define LEDS 176
+#define BYTES (LEDS * 3)
+#define BYTE_US 10 // 1 Mbaud, 10 bits a byte
+#define KEEP 16    // sent frames remembered for matching
+
+Adafruit_NeoPixel strip(LEDS, 8, NEO_GRB + NEO_KHZ800);
+NeoPixelReceiver receiver(strip, Serial);
+
+// What the sender is doing, advanced from hostIdle as the clock moves
+static struct {
+  bool running;
+  bool waitForAck;        // TPM2 style flow control, else free running
+  bool tpm2;
+  unsigned long interval; // us between frames, 0 for as fast as allowed
+  int toSend;             // frames left to send
+  int sent;
+  bool awaitingAck;
+  unsigned long nextFrame;
+  unsigned long ackSent;  // when the frame now awaiting its ACK went out
+  unsigned long ackTime;  // when the last ACK came, or the sender gave up
+  uint8_t wire[BYTES + 8];
+  int wireLen, wirePos;
+  unsigned long nextByte;
+  int acks, helloLen;
+  char hello[8];
+} tx;
+
+// The UART holds one byte in UDR and one in the shift register while the
+// RX interrupt is held off; the next one overruns
+static uint8_t held[2];
+static int heldCount, overruns, streamOverruns;
+
+// Frames as the strip stores them, for matching what show() put out
+static uint8_t frames[KEEP][BYTES];
+static uint8_t local[BYTES];
+static int torn, sketchShows, streamShows;
+
+static void makeFrame(int n, uint8_t *rgb) {
+  for (int i = 0; i < BYTES; i++) rgb[i] = (uint8_t)(n * 37 + i * 11 + (i % 3) * 89);
+}
+
+static void queueFrame(void) {
+  uint8_t rgb[BYTES];
+  makeFrame(tx.sent, rgb);
+  Adafruit_NeoPixel ref(LEDS, 8, NEO_GRB + NEO_KHZ800);
+  ref.begin();
+  for (int i = 0; i < LEDS; i++) ref.setPixelColor(i, rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]);
+  memcpy(frames[tx.sent % KEEP], ref.getPixels(), BYTES);
+
+  int n = 0;
+  if (tx.tpm2) {
+    tx.wire[n++] = 0xC9;
+    tx.wire[n++] = 0xDA;
+    tx.wire[n++] = BYTES >> 8;
+    tx.wire[n++] = BYTES & 0xFF;
+  } else {
+    uint16_t count = LEDS - 1;
+    tx.wire[n++] = 'A';
+    tx.wire[n++] = 'd';
+    tx.wire[n++] = 'a';
+    tx.wire[n++] = count >> 8;
+    tx.wire[n++] = count & 0xFF;
+    tx.wire[n++] = (count >> 8) ^ (count & 0xFF) ^ 0x55;
+  }
+  memcpy(tx.wire + n, rgb, BYTES);
+  n += BYTES;
+  if (tx.tpm2) tx.wire[n++] = 0x36;
+  tx.wireLen = n;
+  tx.wirePos = 0;
+  tx.sent++;
+  tx.toSend--;
+}
+
+static void deliver(uint8_t c) {
+  if (SREG & _BV(SREG_I)) {
+    UDR0 = c;
+    USART_RX_vect();
+  } else if (heldCount < 2) {
+    held[heldCount++] = c;
+  } else {
+    overruns++;
+    if (receiver.isStreaming()) streamOverruns++;
+  }
+}
+
+static void wire(void) {
+  static bool busy;
+  if (busy) return;
+  busy = true;
+  unsigned long now = hostMicros;
+
+  // bytes the UART held while the interrupts were off
+  if ((SREG & _BV(SREG_I)) && heldCount) {
+    for (int i = 0; i < heldCount; i++) deliver(held[i]);
+    heldCount = 0;
+  }
+
+  // what the MCU sends back, a byte per byte time
+  while ((UCSR0B & _BV(UDRIE0)) && (SREG & _BV(SREG_I))) {
+    USART_UDRE_vect();
+    uint8_t c = UDR0;
+    if (c == NEO_RX_ACK && tx.helloLen >= 4) {
+      tx.acks++;
+      tx.awaitingAck = false;
+      tx.ackTime = now;
+    } else if (tx.helloLen < 7) {
+      tx.hello[tx.helloLen++] = c;
+    }
+  }
+
+  if (tx.running) {
+    if (tx.wirePos == tx.wireLen && tx.toSend > 0) {
+      bool due = now >= tx.nextFrame;
+      if (tx.waitForAck) {
+        // a sender gives up on a lost ACK after a while
+        if (tx.awaitingAck && now - tx.ackSent > 100000) {
+          tx.awaitingAck = false;
+          tx.ackTime = tx.ackSent + 100000;
+        }
+        due = due && !tx.awaitingAck;
+      }
+      if (due) {
+        queueFrame();
+        // the sender keeps its own time, whatever the MCU was doing
+        unsigned long at = tx.nextFrame > tx.ackTime ? tx.nextFrame : tx.ackTime;
+        tx.nextByte = at > tx.nextByte ? at : tx.nextByte;
+        tx.nextFrame = (tx.interval ? tx.nextFrame + tx.interval : now);
+        if (tx.nextFrame < now) tx.nextFrame = now;
+      }
+    }
+    while (tx.wirePos < tx.wireLen && tx.nextByte <= now) {
+      deliver(tx.wire[tx.wirePos++]);
+      tx.nextByte += BYTE_US;
+      if (tx.wirePos == tx.wireLen && tx.waitForAck) {
+        tx.awaitingAck = true;
+        tx.ackSent = tx.nextByte;
+      }
+    }
+    if (tx.wirePos == tx.wireLen && tx.toSend == 0) tx.running = false;
+  }
+  busy = false;
+}
+
+static void checkShown(void) {
+  if (!memcmp(hostShowData, local, BYTES)) {
+    sketchShows++;
+    return;
+  }
+  for (int i = 0; i < KEEP; i++) {
+    if (!memcmp(hostShowData, frames[i], BYTES)) {
+      streamShows++;
+      return;
+    }
+  }
+  torn++;
+}
+
+// One pass of the sketch's loop(): receive, and only draw when the
+// receiver isn't streaming. Like refreshScreen(), show() comes every 30 ms
+// at most, and not while a frame is coming in
+static unsigned long lastShow;
+
+static void loopOnce(void) {
+  unsigned long shows = hostShows;
+  receiver.update();
+  if (!receiver.isStreaming()) {
+    // drawing takes a while, and the RX interrupt keeps running meanwhile
+    for (int i = 0; i < LEDS; i++) {
+      strip.setPixelColor(i, 0x102030);
+      hostAdvance(2);
+    }
+    if (hostMicros - lastShow > 30000 && !receiver.isReceiving()) {
+      strip.show();
+      lastShow = hostMicros;
+    }
+  }
+  hostAdvance(50);
+  if (hostShows != shows) checkShown();
+}
+
+static void startSender(bool waitForAck, bool tpm2, unsigned long interval, int count,
+                        unsigned long start) {
+  memset(&tx, 0, sizeof(tx));
+  tx.helloLen = 4; // the greeting was read when the port opened
+  tx.running = true;
+  tx.waitForAck = waitForAck;
+  tx.tpm2 = tpm2;
+  tx.interval = interval;
+  tx.toSend = count;
+  tx.nextFrame = tx.nextByte = start;
+  torn = sketchShows = streamShows = overruns = streamOverruns = 0;
+}
+
+// Runs a stream to its end, returns the frames per second that were shown.
+// A stream starts at once, or that many us into the loop pass that next
+// calls show(), which comes after drawing for LEDS * 2 us
+static double stream(const char *name, bool waitForAck, bool tpm2, unsigned long interval,
+                     int count, unsigned long intoPass, bool *ok) {
+  uint16_t before = receiver.getFrameCount(), errors = receiver.getErrorCount();
+  unsigned long start = hostMicros;
+  if (intoPass) {
+    unsigned long shows = hostShows;
+    while (hostShows == shows) loopOnce();
+    while (hostMicros + LEDS * 2 <= lastShow + 30000) loopOnce();
+    start = hostMicros + intoPass;
+  }
+  bool inShow = intoPass > LEDS * 2;
+  startSender(waitForAck, tpm2, interval, count, start);
+  while (tx.running || receiver.isStreaming()) loopOnce();
+  int shown = receiver.getFrameCount() - before;
+  uint16_t dropped = receiver.getErrorCount() - errors;
+  double seconds = (tx.nextByte - start) / 1e6;
+  printf("%-34s %4d sent, %4d shown, %3d dropped, %4.0f fps, %d torn, %3d overruns\n", name,
+         tx.sent, shown, dropped, shown / seconds, torn, overruns);
+  // the first frame only asks for the strip
+  bool pass = torn == 0 && shown == streamShows;
+  if (waitForAck && !inShow) pass = pass && shown == count - 1 && overruns == 0 && dropped == 0;
+  // the lost header costs the first frame, a TPM2 one garbled rather than
+  // missed is dropped, but nothing may be lost once the strip is held
+  if (waitForAck && inShow) pass = pass && shown >= count - 3 && dropped <= 1 && streamOverruns == 0;
+  *ok = *ok && pass;
+  return shown / seconds;
+}
+
+int main() {
+  bool ok = true;
+  SREG |= _BV(SREG_I);
+  hostIdle = wire;
+  strip.begin();
+  for (int i = 0; i < LEDS; i++) strip.setPixelColor(i, 0x102030);
+  memcpy(local, strip.getPixels(), BYTES);
+  receiver.begin(1000000);
+  for (int i = 0; i < 100; i++) loopOnce();
+  if (memcmp(tx.hello, "Ada\n", 4)) {
+    printf("no Adalight greeting\n");
+    ok = false;
+  }
+
+  stream("TPM2 with ACKs, 60 fps", true, true, 16667, 300, 0, &ok);
+  double fps = stream("TPM2 with ACKs, flat out", true, true, 0, 300, 0, &ok);
+  if (fps < 60) ok = false;
+  stream("Adalight with ACKs, 60 fps", true, false, 16667, 300, 0, &ok);
+  stream("Adalight, no ACKs, 60 fps", false, false, 16667, 300, 0, &ok);
+  // the header comes in while the sketch draws, right before its show()
+  stream("TPM2 with ACKs, before show()", true, true, 16667, 300, 100, &ok);
+  stream("Adalight with ACKs, before show()", true, false, 16667, 300, 100, &ok);
+  // and a millisecond into it
+  stream("TPM2 with ACKs, in show()", true, true, 16667, 300, LEDS * 2 + 1000, &ok);
+  stream("Adalight with ACKs, in show()", true, false, 16667, 300, LEDS * 2 + 1000, &ok);
+
+  // after the last frame the sketch must get the strip back
+  for (int i = 0; i < 20; i++) loopOnce();
+  bool back = !receiver.isStreaming() && sketchShows > 0;
+  printf("sketch draws again after the stream: %s\n", back ? "ok" : "FAIL");
+  ok = ok && back;
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
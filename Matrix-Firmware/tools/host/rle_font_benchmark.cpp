@@ -0,0 +1,253 @@
+// RLE fonts against packed ones: every font in Fonts/ is run-length
+// encoded the way fontconvert -r does it, then each of the 95 printable
+// characters is drawn from both at text size 1 and 2, and from the RLE one
+// with the glyph cache on too, and must come out the same. Prints the
+// bitmap flash bytes of either format and the host time per character.
+// sources: libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/NeoArena.cpp core/Print.cpp core/WString.cpp core/FixedString.cpp
+#include <Adafruit_GFX.h>
+#include <Fonts/FreeMono12pt7b.h>
+#include <Fonts/FreeMono18pt7b.h>
+#include <Fonts/FreeMono24pt7b.h>
+#include <Fonts/FreeMono9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+#include <Fonts/FreeMonoBold18pt7b.h>
+#include <Fonts/FreeMonoBold24pt7b.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMonoBoldOblique12pt7b.h>
+#include <Fonts/FreeMonoBoldOblique18pt7b.h>
+#include <Fonts/FreeMonoBoldOblique24pt7b.h>
+#include <Fonts/FreeMonoBoldOblique9pt7b.h>
+#include <Fonts/FreeMonoOblique12pt7b.h>
+#include <Fonts/FreeMonoOblique18pt7b.h>
+#include <Fonts/FreeMonoOblique24pt7b.h>
+#include <Fonts/FreeMonoOblique9pt7b.h>
+#include <Fonts/FreeSans12pt7b.h>
+#include <Fonts/FreeSans18pt7b.h>
+#include <Fonts/FreeSans24pt7b.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/FreeSansBold12pt7b.h>
+#include <Fonts/FreeSansBold18pt7b.h>
+#include <Fonts/FreeSansBold24pt7b.h>
+#include <Fonts/FreeSansBold9pt7b.h>
+#include <Fonts/FreeSansBoldOblique12pt7b.h>
+#include <Fonts/FreeSansBoldOblique18pt7b.h>
+#include <Fonts/FreeSansBoldOblique24pt7b.h>
+#include <Fonts/FreeSansBoldOblique9pt7b.h>
+#include <Fonts/FreeSansOblique12pt7b.h>
+#include <Fonts/FreeSansOblique18pt7b.h>
+#include <Fonts/FreeSansOblique24pt7b.h>
+#include <Fonts/FreeSansOblique9pt7b.h>
+#include <Fonts/FreeSerif12pt7b.h>
+#include <Fonts/FreeSerif18pt7b.h>
+#include <Fonts/FreeSerif24pt7b.h>
+#include <Fonts/FreeSerif9pt7b.h>
+#include <Fonts/FreeSerifBold12pt7b.h>
+#include <Fonts/FreeSerifBold18pt7b.h>
+#include <Fonts/FreeSerifBold24pt7b.h>
+#include <Fonts/FreeSerifBold9pt7b.h>
+#include <Fonts/FreeSerifBoldItalic12pt7b.h>
+#include <Fonts/FreeSerifBoldItalic18pt7b.h>
+#include <Fonts/FreeSerifBoldItalic24pt7b.h>
+#include <Fonts/FreeSerifBoldItalic9pt7b.h>
+#include <Fonts/FreeSerifItalic12pt7b.h>
+#include <Fonts/FreeSerifItalic18pt7b.h>
+#include <Fonts/FreeSerifItalic24pt7b.h>
+#include <Fonts/FreeSerifItalic9pt7b.h>
+#include <Fonts/Org_01.h>
+#include <Fonts/Picopixel.h>
+#include <Fonts/Tiny3x3a2pt7b.h>
+#include <Fonts/TomThumb.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FONTS \
+  FONT(FreeMono12pt7b) \
+  FONT(FreeMono18pt7b) \
+  FONT(FreeMono24pt7b) \
+  FONT(FreeMono9pt7b) \
+  FONT(FreeMonoBold12pt7b) \
+  FONT(FreeMonoBold18pt7b) \
+  FONT(FreeMonoBold24pt7b) \
+  FONT(FreeMonoBold9pt7b) \
+  FONT(FreeMonoBoldOblique12pt7b) \
+  FONT(FreeMonoBoldOblique18pt7b) \
+  FONT(FreeMonoBoldOblique24pt7b) \
+  FONT(FreeMonoBoldOblique9pt7b) \
+  FONT(FreeMonoOblique12pt7b) \
+  FONT(FreeMonoOblique18pt7b) \
+  FONT(FreeMonoOblique24pt7b) \
+  FONT(FreeMonoOblique9pt7b) \
+  FONT(FreeSans12pt7b) \
+  FONT(FreeSans18pt7b) \
+  FONT(FreeSans24pt7b) \
+  FONT(FreeSans9pt7b) \
+  FONT(FreeSansBold12pt7b) \
+  FONT(FreeSansBold18pt7b) \
+  FONT(FreeSansBold24pt7b) \
+  FONT(FreeSansBold9pt7b) \
+  FONT(FreeSansBoldOblique12pt7b) \
+  FONT(FreeSansBoldOblique18pt7b) \
+  FONT(FreeSansBoldOblique24pt7b) \
+  FONT(FreeSansBoldOblique9pt7b) \
+  FONT(FreeSansOblique12pt7b) \
+  FONT(FreeSansOblique18pt7b) \
+  FONT(FreeSansOblique24pt7b) \
+  FONT(FreeSansOblique9pt7b) \
+  FONT(FreeSerif12pt7b) \
+  FONT(FreeSerif18pt7b) \
+  FONT(FreeSerif24pt7b) \
+  FONT(FreeSerif9pt7b) \
+  FONT(FreeSerifBold12pt7b) \
+  FONT(FreeSerifBold18pt7b) \
+  FONT(FreeSerifBold24pt7b) \
+  FONT(FreeSerifBold9pt7b) \
+  FONT(FreeSerifBoldItalic12pt7b) \
+  FONT(FreeSerifBoldItalic18pt7b) \
+  FONT(FreeSerifBoldItalic24pt7b) \
+  FONT(FreeSerifBoldItalic9pt7b) \
+  FONT(FreeSerifItalic12pt7b) \
+  FONT(FreeSerifItalic18pt7b) \
+  FONT(FreeSerifItalic24pt7b) \
+  FONT(FreeSerifItalic9pt7b) \
+  FONT(Org_01) \
+  FONT(Picopixel) \
+  FONT(Tiny3x3a2pt7b) \
+  FONT(TomThumb)
+
+#define WIDTH 1000
+#define HEIGHT 760
+#define MAX_BITMAP 32768
+
+static const struct {
+  const char *name;
+  const GFXfont *font;
+  size_t bitmapBytes;
+} fonts[] = {
+#define FONT(f) {#f, &f, sizeof(f##Bitmaps)},
+    FONTS
+#undef FONT
+};
+
+// fontconvert's ennibble(), enrun() and enrle(), on a packed glyph
+class RLEWriter {
+public:
+  uint8_t *out;
+  size_t length;
+  bool hi;
+  RLEWriter(uint8_t *out) : out(out), length(0), hi(true) {}
+  void nibble(uint8_t value) {
+    if (hi)
+      out[length++] = value << 4;
+    else
+      out[length - 1] |= value;
+    hi = !hi;
+  }
+  void run(int n) {
+    for (; n >= 15; n -= 15) nibble(15);
+    nibble(n);
+  }
+  void glyph(const uint8_t *packed, int pixels) {
+    int lastSet = -1;
+    for (int i = 0; i < pixels; i++)
+      if (packed[i / 8] & (0x80 >> (i & 7))) lastSet = i;
+    if (lastSet < 0) {
+      if (pixels) run(pixels);
+    } else {
+      bool set = false;
+      int length = 0;
+      for (int i = 0; i <= lastSet; i++) {
+        bool px = packed[i / 8] & (0x80 >> (i & 7));
+        if (px != set) {
+          run(set ? length - 1 : length);
+          set = px;
+          length = 0;
+        }
+        length++;
+      }
+      run(length - 1);
+      if (lastSet < pixels - 1) nibble(0); // end marker
+    }
+    hi = true; // the next glyph starts on a byte
+  }
+};
+
+static uint8_t rleBitmap[MAX_BITMAP];
+static GFXglyph rleGlyphs[256];
+
+// Returns the RLE bitmap's size
+static size_t encode(const GFXfont *packed, GFXfont *rle) {
+  RLEWriter writer(rleBitmap);
+  for (uint16_t c = packed->first; c <= packed->last; c++) {
+    GFXglyph glyph = packed->glyph[c - packed->first];
+    const uint8_t *bits = packed->bitmap + glyph.bitmapOffset;
+    glyph.bitmapOffset = writer.length;
+    writer.glyph(bits, glyph.width * glyph.height);
+    rleGlyphs[c - packed->first] = glyph;
+  }
+  *rle = *packed;
+  rle->bitmap = rleBitmap;
+  rle->glyph = rleGlyphs;
+  rle->flags = GFX_FONT_RLE;
+  return writer.length;
+}
+
+static char charset[128];
+
+static void text(GFXcanvas8 &canvas, const GFXfont *font, uint8_t size) {
+  canvas.setFont(font);
+  canvas.setTextSize(size);
+  canvas.setCursor(0, font->yAdvance * size);
+  canvas.print(charset);
+}
+
+// host ns per character at size 1
+static double drawTime(GFXcanvas8 &canvas, const GFXfont *font) {
+  const int rounds = 50;
+  uint64_t start = hostNanos();
+  for (int i = 0; i < rounds; i++) text(canvas, font, 1);
+  return (double)(hostNanos() - start) / rounds / ('~' - ' ' + 1);
+}
+
+int main() {
+  char *p = charset;
+  for (int c = ' '; c <= '~'; c++) {
+    *p++ = c;
+    if ((c - ' ') % 16 == 15) *p++ = '\n';
+  }
+  *p = 0;
+
+  static GFXcanvas8 packed(WIDTH, HEIGHT), rle(WIDTH, HEIGHT);
+  packed.setTextWrap(false);
+  rle.setTextWrap(false);
+  packed.setTextColor(0xFF);
+  rle.setTextColor(0xFF);
+  bool ok = true;
+  size_t packedTotal = 0, rleTotal = 0;
+  for (auto &f : fonts) {
+    GFXfont encoded;
+    size_t rleBytes = encode(f.font, &encoded);
+    bool same = true;
+    for (uint8_t size = 1; size <= 2; size++) {
+      for (uint8_t slots = 0; slots <= 8; slots += 8) {
+        packed.fillScreen(0);
+        rle.fillScreen(0);
+        text(packed, f.font, size);
+        rle.setGlyphCache(slots);
+        text(rle, &encoded, size);
+        rle.setGlyphCache(0);
+        same = same && !memcmp(packed.getBuffer(), rle.getBuffer(), WIDTH * HEIGHT);
+      }
+    }
+    ok = ok && same;
+    packedTotal += f.bitmapBytes;
+    rleTotal += rleBytes;
+    printf("%-26s packed %5zu bytes %5.0f ns/char, RLE %5zu bytes (%3zu%%) %5.0f ns/char: %s\n",
+           f.name, f.bitmapBytes, drawTime(packed, f.font), rleBytes,
+           100 * rleBytes / f.bitmapBytes, drawTime(rle, &encoded),
+           same ? "same" : "FAIL");
+  }
+  printf("all fonts: packed %zu bytes, RLE %zu bytes (%zu%%)\n", packedTotal, rleTotal,
+         100 * rleTotal / packedTotal);
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Build and run the host harnesses: tests and benchmarks that compile core
+# and library sources with the host's g++ against the stand-ins in include/
+# and host.cpp. Each harness names the sources it needs, relative to
+# ArduinoCore/src, on a "// sources:" line, and any extra compiler flags on
+# a "// flags:" line. Exits non-zero if a harness fails to build or run.
+#
+#     run.sh [harness.cpp ...]     (default: all of them)
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+CORE=$HOST/../../ArduinoCore
+OUT=${TMPDIR:-/tmp}/matrix-host
+CXX=${CXX:-g++}
+mkdir -p "$OUT"
+
+INCLUDES="-I$HOST/include"
+for dir in $(cd "$CORE" && find include -type d ! -path '*/examples*'); do
+  INCLUDES="$INCLUDES -I$CORE/$dir"
+done
+
+# KENDRYTE_K210 selects the show() that calls out to k210Show() in host.cpp,
+# and without SPI interfaces busio leaves out its SPI device
+CXXFLAGS="-std=gnu++11 -O2 -w -funsigned-char -include $HOST/include/host.h
+  -DF_CPU=16000000L -DARDUINO=108019 -DARDUINO_ARCH_AVR -DKENDRYTE_K210
+  -DSPI_INTERFACES_COUNT=0"
+
+[ $# -eq 0 ] && set -- $(cd "$HOST" && ls *.cpp | grep -v '^host\.cpp$')
+
+status=0
+for harness in "$@"; do
+  name=$(basename "$harness" .cpp)
+  sources=$(sed -n 's|^// sources:||p' "$HOST/$name.cpp")
+  flags=$(sed -n 's|^// flags:||p' "$HOST/$name.cpp")
+  files=
+  for src in $sources; do files="$files $CORE/src/$src"; done
+  echo "== $name"
+  # C sources go through g++ as well, which is enough for the core's C
+  if $CXX $CXXFLAGS $INCLUDES -x c++ $files "$HOST/$name.cpp" "$HOST/host.cpp" \
+      -x none $flags -o "$OUT/$name" && "$OUT/$name"; then
+    :
+  else
+    echo "== $name FAILED"
+    status=1
+  fi
+done
+exit $status
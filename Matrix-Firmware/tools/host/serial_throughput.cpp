@@ -0,0 +1,77 @@
+// HardwareSerial throughput: the RX interrupt fills the ring 48 bytes at a
+// time and the main loop takes them out with per-byte Stream::read() or the
+// bulk read(); the main loop queues 48 bytes with per-byte Print::write()
+// or the bulk write() and the UDRE interrupt drains them. Checks that the
+// bytes come out in order across ring wraps, and measures the host time per
+// byte of each path, interrupt included.
+// sources: core/HardwareSerial.cpp core/HardwareSerial0.cpp core/Print.cpp core/Stream.cpp core/WString.cpp core/FixedString.cpp
+#include <Arduino.h>
+#include <stdio.h>
+
+extern "C" void USART_RX_vect(void);
+extern "C" void USART_UDRE_vect(void);
+
+#define CHUNK 48
+#define ROUNDS 200000
+
+static bool inOrder = true;
+
+static void receive(uint8_t first) {
+  for (uint8_t i = 0; i < CHUNK; i++) {
+    UDR0 = first + i;
+    USART_RX_vect();
+  }
+}
+
+static void drain(uint8_t first) {
+  for (uint8_t i = 0; i < CHUNK; i++) {
+    USART_UDRE_vect();
+    if (UDR0 != (uint8_t)(first + i)) inOrder = false;
+  }
+}
+
+static double rxTime(bool bulk) {
+  Stream &stream = Serial;
+  uint8_t buffer[CHUNK];
+  uint64_t start = hostNanos();
+  for (long r = 0; r < ROUNDS; r++) {
+    uint8_t first = r * CHUNK;
+    receive(first);
+    if (bulk) {
+      if (Serial.read(buffer, CHUNK) != CHUNK) inOrder = false;
+    } else {
+      for (uint8_t i = 0; i < CHUNK; i++) buffer[i] = stream.read();
+    }
+    for (uint8_t i = 0; i < CHUNK; i++) {
+      if (buffer[i] != (uint8_t)(first + i)) inOrder = false;
+    }
+  }
+  return (double)(hostNanos() - start) / ROUNDS / CHUNK;
+}
+
+static double txTime(bool bulk) {
+  Print &print = Serial;
+  uint8_t buffer[CHUNK];
+  uint64_t start = hostNanos();
+  for (long r = 0; r < ROUNDS; r++) {
+    uint8_t first = r * CHUNK;
+    for (uint8_t i = 0; i < CHUNK; i++) buffer[i] = first + i;
+    if (bulk) {
+      print.write(buffer, CHUNK);
+    } else {
+      for (uint8_t i = 0; i < CHUNK; i++) print.write(buffer[i]);
+    }
+    drain(first);
+  }
+  return (double)(hostNanos() - start) / ROUNDS / CHUNK;
+}
+
+int main() {
+  // UDRE stays clear, so every byte written goes through the ring
+  Serial.begin(1000000);
+  printf("rx ring %d, tx ring %d bytes\n", SERIAL0_RX_BUFFER_SIZE, SERIAL0_TX_BUFFER_SIZE);
+  printf("rx per byte %6.2f ns/byte, bulk %6.2f ns/byte\n", rxTime(false), rxTime(true));
+  printf("tx per byte %6.2f ns/byte, bulk %6.2f ns/byte\n", txTime(false), txTime(true));
+  printf("bytes in order: %s\n", inOrder ? "ok" : "FAIL");
+  return inOrder ? 0 : 1;
+}
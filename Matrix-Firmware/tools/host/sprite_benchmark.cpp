@@ -0,0 +1,312 @@
+// Sprites on NeoMatrix: checks drawSprite() against a pixel by pixel
+// reference for every sprite format, each rotation, with and without the
+// index map and with and without a clip rectangle, then that a
+// NeoMatrixSprites layer matches a full redraw over 5000 random moves,
+// color changes and hides. Finally the Pong scene of Sketch.cpp (net,
+// paddles and a gliding ball) is drawn by the layer and by clearing and
+// redrawing it with primitives every frame: the two must give the same
+// pixels, and the host time per frame of each is measured.
+// sources: libraries/adafruit_neomatrix/Adafruit_NeoMatrix.cpp libraries/adafruit_neomatrix/NeoMatrixSprites.cpp libraries/adafruit_neopixel/Adafruit_NeoPixel.cpp core/NeoArena.cpp libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/Print.cpp core/WString.cpp core/FixedString.cpp
+// flags: -no-pie -fno-pie
+#include <NeoMatrixSprites.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define W 16
+#define H 11
+#define LAYOUT (NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_COLUMNS + NEO_MATRIX_ZIGZAG)
+#define SW 7
+#define SH 5
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what) {
+  if (!pass) {
+    printf("FAIL: %s\n", what);
+    ok = false;
+  }
+}
+
+// One pixel of a sprite as neosprite.h describes it; on is false where
+// it is transparent
+static uint16_t spritePixel(const NeoSprite *s, int i, int j, uint16_t color, bool *on) {
+  int format = s->flags & SPRITE_FORMAT;
+  *on = true;
+  if (format == SPRITE_MASK) {
+    *on = s->data[j * ((s->width + 7) / 8) + i / 8] & (0x80 >> (i & 7));
+    return color;
+  }
+  int bytes = (format == SPRITE_INDEXED) ? 1 : 2, n = j * s->width + i;
+  const uint8_t *d = s->data;
+  uint16_t v = 0;
+  if (s->flags & SPRITE_RLE) {
+    int run = 0;
+    bool repeat = false;
+    for (int at = 0; at <= n; at++, run--) {
+      bool first = !run;
+      if (first) {
+        repeat = *d & 128;
+        run = (*d++ & 127) + 1;
+      }
+      if (first || !repeat) {
+        v = *d++;
+        if (bytes == 2) v |= *d++ << 8;
+      }
+    }
+  } else {
+    v = (bytes == 2) ? (d[n * 2] | d[n * 2 + 1] << 8) : d[n];
+  }
+  if ((s->flags & SPRITE_KEYED) && (v == s->key)) *on = false;
+  return (format == SPRITE_INDEXED) ? s->palette[v] : v;
+}
+
+static void referenceSprite(Adafruit_NeoMatrix &m, int x, int y, const NeoSprite *s,
+                            uint16_t color, int cx = -1000, int cy = -1000, int cw = 3000,
+                            int ch = 3000) {
+  for (int j = 0; j < s->height; j++) {
+    for (int i = 0; i < s->width; i++) {
+      bool on;
+      uint16_t c = spritePixel(s, i, j, color, &on);
+      int px = x + i, py = y + j;
+      if (on && px >= cx && px < cx + cw && py >= cy && py < cy + ch) m.drawPixel(px, py, c);
+    }
+  }
+}
+
+// Packs pixels into neosprite.h's RLE packets, returns the bytes written
+static int encodeRLE(const uint16_t *pixels, int n, int bytes, uint8_t *out) {
+  int length = 0, i = 0;
+  while (i < n) {
+    int run = 1;
+    while (i + run < n && pixels[i + run] == pixels[i] && run < 128) run++;
+    int from = i, count;
+    if (run >= 2) {
+      out[length++] = 0x80 | (run - 1);
+      count = 1;
+      i += run;
+    } else {
+      for (count = 0; i < n && count < 128; i++, count++)
+        if (i + 1 < n && pixels[i + 1] == pixels[i]) break;
+      if (!count) {
+        count = 1;
+        i++;
+      }
+      out[length++] = count - 1;
+    }
+    for (int k = from; k < from + count; k++) {
+      out[length++] = pixels[k];
+      if (bytes == 2) out[length++] = pixels[k] >> 8;
+    }
+  }
+  return length;
+}
+
+static uint16_t palette[8];
+static uint8_t raw565[SW * SH * 2], rawIndexed[SW * SH], rle565[SW * SH * 3], rleIndexed[SW * SH * 2];
+static const uint8_t mask[SH] = {0xA0, 0x54, 0xFE, 0x10, 0x82};
+static NeoSprite sprites[8];
+
+static void makeSprites(void) {
+  uint16_t p565[SW * SH], indices[SW * SH];
+  for (int i = 0; i < 8; i++) palette[i] = Adafruit_NeoMatrix::Color(i * 30, 255 - i * 30, i * 11);
+  for (int k = 0; k < SW * SH; k++) {
+    p565[k] = (k % 5 < 2) ? 0 : Adafruit_NeoMatrix::Color(k * 7, k * 3, 255 - k * 5);
+    indices[k] = (k % 4 == 0) ? 0 : (k / 3) % 8;
+    raw565[k * 2] = p565[k];
+    raw565[k * 2 + 1] = p565[k] >> 8;
+    rawIndexed[k] = indices[k];
+  }
+  encodeRLE(p565, SW * SH, 2, rle565);
+  encodeRLE(indices, SW * SH, 1, rleIndexed);
+  const NeoSprite all[8] = {
+      {raw565, NULL, SW, SH, SPRITE_RGB565, 0},
+      {raw565, NULL, SW, SH, SPRITE_RGB565 | SPRITE_KEYED, 0},
+      {rawIndexed, palette, SW, SH, SPRITE_INDEXED, 0},
+      {rawIndexed, palette, SW, SH, SPRITE_INDEXED | SPRITE_KEYED, 0},
+      {rle565, NULL, SW, SH, SPRITE_RGB565 | SPRITE_RLE | SPRITE_KEYED, 0},
+      {rleIndexed, palette, SW, SH, SPRITE_INDEXED | SPRITE_RLE, 0},
+      {rleIndexed, palette, SW, SH, SPRITE_INDEXED | SPRITE_RLE | SPRITE_KEYED, 0},
+      {mask, NULL, SW, SH, SPRITE_MASK, 0}};
+  memcpy(sprites, all, sizeof(sprites));
+}
+
+static void checkBlits(void) {
+  int bad = 0;
+  for (int rotation = 0; rotation < 4; rotation++) {
+    for (int map = 0; map < 2; map++) {
+      Adafruit_NeoMatrix a(W, H, 8, LAYOUT), b(W, H, 8, LAYOUT);
+      a.begin();
+      b.begin();
+      if (map) {
+        a.buildIndexMap();
+        b.buildIndexMap();
+      }
+      a.setRotation(rotation);
+      b.setRotation(rotation);
+      for (int s = 0; s < 8; s++) {
+        for (int t = 0; t < 200; t++) {
+          a.fillScreen(0x1234);
+          b.fillScreen(0x1234);
+          int x = rand() % 24 - 8, y = rand() % 20 - 8;
+          uint16_t color = rand();
+          if (t & 1) {
+            int cx = rand() % 20 - 4, cy = rand() % 16 - 4, cw = rand() % 12, ch = rand() % 12;
+            a.drawSprite(x, y, &sprites[s], color, cx, cy, cw, ch);
+            referenceSprite(b, x, y, &sprites[s], color, cx, cy, cw, ch);
+          } else {
+            a.drawSprite(x, y, &sprites[s], color);
+            referenceSprite(b, x, y, &sprites[s], color);
+          }
+          if (memcmp(a.getPixels(), b.getPixels(), W * H * 3)) bad++;
+        }
+      }
+    }
+  }
+  expect(!bad, "drawSprite() against the reference");
+}
+
+// Five sprites, a rectangle and a point, moved, hidden and recolored at
+// random, against clearing and drawing them all every frame
+static void checkLayer(void) {
+  const int slots = 7;
+  const uint16_t background = 0x0841;
+  Adafruit_NeoMatrix a(W, H, 8), b(W, H, 8);
+  a.begin();
+  b.begin();
+  NeoMatrixSprites layer(a, slots, background);
+  expect(layer.begin(), "layer begin()");
+  int xs[slots], ys[slots];
+  bool visible[slots];
+  uint16_t colors[slots];
+  for (int i = 0; i < slots; i++) {
+    xs[i] = rand() % W;
+    ys[i] = rand() % H;
+    visible[i] = true;
+    colors[i] = rand();
+  }
+  int bad = 0;
+  for (int frame = 0; frame < 5000; frame++) {
+    int i = rand() % slots, op = rand() % 10;
+    if (op < 7) {
+      xs[i] += rand() % 3 - 1;
+      ys[i] += rand() % 3 - 1;
+      if (i == 6) {
+        // the point moves in 1/256 pixels
+        xs[i] += rand() % 64 - 32;
+        ys[i] += rand() % 64 - 32;
+        xs[i] = constrain(xs[i], -2 * 256, (W + 1) * 256);
+        ys[i] = constrain(ys[i], -2 * 256, (H + 1) * 256);
+      } else {
+        xs[i] = constrain(xs[i], -8, W + 2);
+        ys[i] = constrain(ys[i], -6, H + 2);
+      }
+    } else if (op < 8) {
+      visible[i] = !visible[i];
+    } else {
+      colors[i] = rand();
+    }
+    for (int k = 0; k < slots; k++) {
+      if (k < 5) {
+        layer.set(k, &sprites[(k * 3) % 8], 0, 0);
+        layer.moveTo(k, xs[k], ys[k]);
+        layer.setColor(k, colors[k]);
+      } else if (k == 5) {
+        layer.setRect(k, xs[k], ys[k], 3, 2, colors[k]);
+      } else {
+        layer.setPoint(k, xs[k], ys[k], colors[k]);
+      }
+      layer.show(k, visible[k]);
+    }
+    if (frame % 500 == 0) {
+      a.fillScreen(0xFFFF);
+      layer.invalidate();
+    }
+    layer.update();
+
+    b.fillScreen(background);
+    for (int k = 0; k < slots; k++) {
+      if (!visible[k]) continue;
+      if (k < 5)
+        referenceSprite(b, xs[k], ys[k], &sprites[(k * 3) % 8], colors[k]);
+      else if (k == 5)
+        b.fillRect(xs[k], ys[k], 3, 2, colors[k]);
+      else
+        b.drawPixelQ8(xs[k], ys[k], colors[k]);
+    }
+    if (memcmp(a.getPixels(), b.getPixels(), W * H * 3)) bad++;
+  }
+  expect(!bad, "layer against a full redraw");
+}
+
+// Sketch.cpp's Pong: the net, two paddles following the ball a row at a
+// time and the ball gliding in 1/256 pixels
+#define PONG_FRAMES 200000
+static const uint16_t netColor = Adafruit_NeoMatrix::Color(100, 100, 100);
+
+static void pongState(int frame, int16_t *ballX, int16_t *ballY, int16_t *left,
+                      int16_t *right) {
+  int x = (frame * 37) % (2 * 14 * 256), y = (frame * 23) % (2 * 10 * 256);
+  *ballX = 256 + (x < 14 * 256 ? x : 2 * 14 * 256 - x);
+  *ballY = (y < 10 * 256 ? y : 2 * 10 * 256 - y);
+  *left = (*ballY >> 8) - 1;
+  *right = ((*ballY + 384) >> 8) - 1;
+}
+
+static void pongLayer(NeoMatrixSprites &scene, int frame) {
+  int16_t ballX, ballY, left, right;
+  pongState(frame, &ballX, &ballY, &left, &right);
+  scene.setRect(0, 7, 0, 2, H, netColor);
+  scene.setRect(1, 0, left, 1, 3, 0xFFFF);
+  scene.setRect(2, W - 1, right, 1, 3, 0xFFFF);
+  scene.setPoint(3, ballX, ballY, 0xF800);
+  scene.update();
+}
+
+static void pongPrimitives(Adafruit_NeoMatrix &m, int frame) {
+  int16_t ballX, ballY, left, right;
+  pongState(frame, &ballX, &ballY, &left, &right);
+  m.fillScreen(0);
+  m.fillRect(7, 0, 2, H, netColor);
+  m.drawFastVLine(0, left, 3, 0xFFFF);
+  m.drawFastVLine(W - 1, right, 3, 0xFFFF);
+  m.drawPixelQ8(ballX, ballY, 0xF800);
+}
+
+static void pong(void) {
+  Adafruit_NeoMatrix a(W, H, 8, LAYOUT), b(W, H, 8, LAYOUT);
+  a.begin();
+  b.begin();
+  a.buildIndexMap();
+  b.buildIndexMap();
+  a.setBrightness(40);
+  b.setBrightness(40);
+  NeoMatrixSprites scene(a, 4);
+  scene.begin();
+  int bad = 0;
+  for (int frame = 0; frame < 20000; frame++) {
+    pongLayer(scene, frame);
+    pongPrimitives(b, frame);
+    if (memcmp(a.getPixels(), b.getPixels(), W * H * 3)) bad++;
+  }
+  expect(!bad, "Pong layer against primitives");
+
+  uint64_t start = hostNanos();
+  for (int frame = 0; frame < PONG_FRAMES; frame++) pongLayer(scene, frame);
+  double layer = (double)(hostNanos() - start) / PONG_FRAMES;
+  start = hostNanos();
+  for (int frame = 0; frame < PONG_FRAMES; frame++) pongPrimitives(b, frame);
+  double primitives = (double)(hostNanos() - start) / PONG_FRAMES;
+  printf("Pong frame: layer %.0f ns, primitives %.0f ns\n", layer, primitives);
+}
+
+int main() {
+  srand(1);
+  makeSprites();
+  checkBlits();
+  checkLayer();
+  printf("drawSprite() and the layer match: %s\n", ok ? "ok" : "FAIL");
+  pong();
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,295 @@
+// Heap fragmentation, String against FixedString: the sketch's captions are
+// rebuilt over and over while other blocks come and go on a 1 KB heap that
+// allocates like avr-libc's malloc (first fit, a 2 byte size header, freed
+// neighbours merged, the top given back, but realloc() always moves a
+// block it has to grow). A 528 byte pixel buffer stays put, and every 50
+// rounds a 160 byte block, a WS2812FX reconfiguration, is tried. String
+// captions allocate as they grow and for every temporary; FixedString
+// captions must not call the heap at all. Also checks FixedString and
+// StringView themselves.
+// sources: core/Print.cpp core/Stream.cpp core/WString.cpp core/FixedString.cpp
+// flags: -fno-builtin-malloc -fno-builtin-free -Wl,--wrap=malloc,--wrap=realloc,--wrap=free
+#include <Arduino.h>
+#include <FixedString.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HEAP 1024
+#define ROUNDS 20000
+
+// The heap WString.cpp's malloc(), realloc() and free() end up in. Blocks
+// and free list links are 16 bit offsets into it, as pointers are on the
+// AVR, so the headers and the smallest block are the size they are there
+static uint8_t heap[HEAP] __attribute__((aligned(2)));
+static uint16_t heapTop = 2; // offset 0 ends the free list
+static uint16_t freeList;    // in address order
+static unsigned long heapCalls;
+
+static uint16_t &heapWord(uint16_t at) { return *(uint16_t *)(heap + at); }
+// a block's size is in the word before it, a free block's link in its first
+static uint16_t &sizeOf(uint16_t block) { return heapWord(block - 2); }
+static uint16_t &nextOf(uint16_t block) { return heapWord(block); }
+
+static uint16_t allocate(size_t n) {
+  n = (n < 2) ? 2 : (n + 1) & ~1;
+  for (uint16_t *q = &freeList; *q; q = &nextOf(*q)) {
+    uint16_t b = *q;
+    if (sizeOf(b) < n) continue;
+    if (sizeOf(b) >= n + 4) {
+      // split, the rest stays on the list
+      uint16_t rest = b + n + 2;
+      sizeOf(rest) = sizeOf(b) - n - 2;
+      nextOf(rest) = nextOf(b);
+      *q = rest;
+      sizeOf(b) = n;
+    } else {
+      *q = nextOf(b);
+    }
+    return b;
+  }
+  if (heapTop + n > HEAP) return 0;
+  uint16_t b = heapTop;
+  sizeOf(b) = n;
+  heapTop += n + 2;
+  return b;
+}
+
+static void release(uint16_t b) {
+  uint16_t prev = 0, *q = &freeList;
+  while (*q && *q < b) {
+    prev = *q;
+    q = &nextOf(*q);
+  }
+  nextOf(b) = *q;
+  *q = b;
+  if (nextOf(b) && b + sizeOf(b) + 2 == nextOf(b)) {
+    sizeOf(b) += 2 + sizeOf(nextOf(b));
+    nextOf(b) = nextOf(nextOf(b));
+  }
+  if (prev && prev + sizeOf(prev) + 2 == b) {
+    sizeOf(prev) += 2 + sizeOf(b);
+    nextOf(prev) = nextOf(b);
+    b = prev;
+  }
+  if (b + sizeOf(b) + 2 == heapTop) {
+    // the top block goes back, and with it the link to it
+    heapTop = b;
+    for (q = &freeList; *q != b; q = &nextOf(*q)) {}
+    *q = 0;
+  }
+}
+
+extern "C" void *__wrap_malloc(size_t n) {
+  heapCalls++;
+  uint16_t b = allocate(n);
+  return b ? heap + b : NULL;
+}
+
+extern "C" void __wrap_free(void *p) {
+  heapCalls++;
+  if (p) release((uint8_t *)p - heap);
+}
+
+extern "C" void *__wrap_realloc(void *p, size_t n) {
+  if (!p) return __wrap_malloc(n);
+  heapCalls++;
+  uint16_t b = (uint8_t *)p - heap;
+  if (sizeOf(b) >= n) return p;
+  uint16_t moved = allocate(n);
+  if (!moved) return NULL;
+  memcpy(heap + moved, p, sizeOf(b));
+  release(b);
+  return heap + moved;
+}
+
+static size_t largestFree(void) {
+  size_t largest = HEAP - heapTop;
+  for (uint16_t b = freeList; b; b = nextOf(b))
+    if (sizeOf(b) > largest) largest = sizeOf(b);
+  return largest;
+}
+
+static size_t totalFree(void) {
+  size_t total = HEAP - heapTop;
+  for (uint16_t b = freeList; b; b = nextOf(b)) total += sizeOf(b);
+  return total;
+}
+
+static int failures;
+
+static void expect(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Hands out a fixed text, for the Stream readers
+class TextStream : public Stream {
+public:
+  const char *text;
+  TextStream() : text("") {}
+  int available() { return *text ? 1 : 0; }
+  int read() { return *text ? *text++ : -1; }
+  int peek() { return *text ? *text : -1; }
+  size_t write(uint8_t) { return 1; }
+};
+
+static void functional(void) {
+  FixedString<5> a;
+  a = F("Init");
+  expect(a == "Init" && a.length() == 4 && !a.getWriteError(), "assign flash string");
+  a = "toolong";
+  expect(a == "toolo" && a.getWriteError(), "cut off and flagged");
+  a.clear();
+  a.print(123);
+  a += '4';
+  a += 5;
+  expect(a == "12345" && !a.getWriteError(), "print and append");
+  a += 'x';
+  expect(a == "12345" && a.getWriteError(), "append past the end");
+
+  FixedString<15> b(a);
+  b += F(" bpm");
+  expect(b == "12345 bpm", "copy from a smaller one");
+  FixedString<5> c = b;
+  expect(c == "12345", "copy from a larger one");
+  b = b;
+  expect(b == "12345 bpm", "assign to itself");
+  b = StringView(b).substring(6);
+  expect(b == "bpm", "assign a view of itself");
+  c = b;
+  expect(c == "bpm", "assign from another size");
+
+  StringView v("hello world");
+  expect(v.indexOf('o') == 4 && v.indexOf('o', 5) == 7 && v.indexOf('z') == -1, "indexOf");
+  expect(v.startsWith("hell") && !v.startsWith("world"), "startsWith");
+  expect(v.substring(6) == "world" && v.substring(3, 1).length() == 0, "substring");
+
+  FixedString<15> d;
+  d.print(3.14159, 3);
+  expect(d == "3.142", "print a double");
+
+  TextStream s;
+  s.setTimeout(0);
+  s.text = "line one\nrest";
+  FixedString<15> line;
+  expect(s.readStringUntil('\n', line) == 8 && line == "line one", "readStringUntil");
+  expect(s.readString(line) == 4 && line == "rest", "readString");
+  s.text = "0123456789ABCDEFGHIJ";
+  expect(s.readString(line) == 15 && line == "0123456789ABCDE", "readString cut off");
+
+  String str("xyz");
+  FixedString<5> e(str);
+  expect(e == "xyz" && e != "xy", "from a String");
+}
+
+// The caption updates of Sketch.cpp's loop(), on either kind of string.
+// The Strings are made once the pixel buffer is allocated, as setup() would
+// first fill them after strip.begin()
+static String *caption1, *caption2, *infoText;
+static FixedString<5> fixedCaption1, fixedCaption2;
+static FixedString<15> fixedInfoText;
+
+static void updateCaptions(bool fixed) {
+  int bpm = 40 + rand() % 200, mode = rand() % 9;
+  switch (rand() % 3) {
+  case 0:
+    if (fixed) {
+      fixedInfoText = F("Line  bpm ");
+      fixedInfoText += bpm;
+    } else {
+      *infoText = F("Line  bpm ");
+      *infoText += bpm;
+    }
+    break;
+  case 1:
+    if (fixed) {
+      fixedCaption1 = F("Mode");
+      fixedCaption2.clear();
+      fixedCaption2 += mode;
+    } else {
+      *caption1 = F("Mode");
+      *caption2 = String(mode);
+    }
+    break;
+  default:
+    if (fixed) {
+      fixedCaption1 = F("Init");
+      fixedCaption2 = F("v1.1");
+    } else {
+      *caption1 = F("Init");
+      *caption2 = F("v1.1");
+    }
+    break;
+  }
+}
+
+// Returns the heap calls the captions made, and how often the big block
+// didn't fit
+static unsigned long stress(bool fixed, unsigned long *bigFailed) {
+  srand(5);
+  void *pixels = malloc(528);
+  if (!fixed) {
+    caption1 = new String();
+    caption2 = new String();
+    infoText = new String();
+  }
+  void *others[8] = {NULL};
+  unsigned long bigTries = 0;
+  *bigFailed = 0;
+  size_t smallestLargest = HEAP;
+  double fragmentation = 0;
+  int samples = 0;
+  unsigned long captionCalls = 0;
+  for (int round = 0; round < ROUNDS; round++) {
+    unsigned long calls = heapCalls;
+    updateCaptions(fixed);
+    captionCalls += heapCalls - calls;
+    int k = rand() % 8;
+    if (others[k]) {
+      free(others[k]);
+      others[k] = NULL;
+    } else {
+      others[k] = malloc(8 + rand() % 40);
+    }
+    if (round % 50 == 0) {
+      void *big = malloc(160);
+      bigTries++;
+      if (big)
+        free(big);
+      else
+        (*bigFailed)++;
+    }
+    if (round > 1000) {
+      size_t largest = largestFree();
+      if (largest < smallestLargest) smallestLargest = largest;
+      fragmentation += 1.0 - (double)largest / totalFree();
+      samples++;
+    }
+  }
+  printf("%-11s %6lu heap calls, 160 byte block failed %3lu/%lu, smallest largest free "
+         "block %3zu bytes, fragmentation %4.1f%%\n",
+         fixed ? "FixedString" : "String", captionCalls, *bigFailed, bigTries,
+         smallestLargest, 100 * fragmentation / samples);
+  for (int k = 0; k < 8; k++) free(others[k]);
+  if (!fixed) {
+    delete caption1;
+    delete caption2;
+    delete infoText;
+  }
+  free(pixels);
+  return captionCalls;
+}
+
+int main() {
+  functional();
+  printf("FixedString and StringView: %s\n", failures ? "FAIL" : "ok");
+  unsigned long stringFailed, fixedFailed;
+  stress(false, &stringFailed);
+  expect(stress(true, &fixedFailed) == 0, "FixedString captions keep off the heap");
+  expect(fixedFailed <= stringFailed, "the big block fits at least as often");
+  printf("%s\n", failures ? "FAIL" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// Telemetry packets, built with the largest payload Telemetry.h allows:
+// every payload size from 0 up to it, with and without 0 bytes in it, is
+// sent, COBS decoded as tools/telemetry.py does, and must come back with
+// its type, sequence number, CRC and payload intact. A packet that doesn't
+// fit the output must be dropped whole.
+// sources: core/Telemetry.cpp core/Print.cpp core/WString.cpp core/FixedString.cpp
+// flags: -DTELEMETRY_MAX_PAYLOAD=250
+#include <Arduino.h>
+#include <Telemetry.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Collects what is written, with room for one packet at most
+class Capture : public Print {
+public:
+  uint8_t data[512];
+  int length;
+  int room;
+  Capture() : length(0), room(sizeof(data)) {}
+  size_t write(uint8_t c) {
+    data[length++] = c;
+    return 1;
+  }
+  int availableForWrite() { return room - length; }
+};
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what, int size) {
+  if (!pass) {
+    printf("FAIL: %s, %d byte payload\n", what, size);
+    ok = false;
+  }
+}
+
+// Decodes the frame between the leading and the trailing 0, returns the
+// decoded length or -1 if the framing is broken
+static int decode(const uint8_t *in, int length, uint8_t *out) {
+  if (length < 2 || in[0] != 0 || in[length - 1] != 0) return -1;
+  int n = 0;
+  for (int i = 1; i < length - 1;) {
+    uint8_t code = in[i++];
+    if (!code || i + code - 1 > length - 1) return -1;
+    for (int k = 1; k < code; k++) {
+      if (!in[i]) return -1;
+      out[n++] = in[i++];
+    }
+    if (code < 0xFF && i < length - 1) out[n++] = 0;
+  }
+  return n;
+}
+
+static uint8_t crc8(const uint8_t *data, int length) {
+  uint8_t crc = 0;
+  for (int i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+int main() {
+  Capture out;
+  Telemetry telemetry(out);
+  uint8_t payload[TELEMETRY_MAX_PAYLOAD + 1], decoded[512];
+  uint8_t seq = 0;
+  srand(7);
+  for (int zeros = 0; zeros < 2; zeros++) {
+    for (int size = 0; size <= TELEMETRY_MAX_PAYLOAD; size++) {
+      for (int i = 0; i < size; i++) payload[i] = zeros ? rand() % 4 : 1 + rand() % 255;
+      out.length = 0;
+      expect(telemetry.send(0x42, payload, size), "send", size);
+      int n = decode(out.data, out.length, decoded);
+      expect(n == size + 3, "framing", size);
+      if (n != size + 3) {
+        seq++;
+        continue;
+      }
+      expect(decoded[0] == 0x42 && decoded[1] == seq, "type and sequence", size);
+      expect(decoded[n - 1] == crc8(decoded, n - 1), "CRC", size);
+      expect(!memcmp(decoded + 2, payload, size), "payload", size);
+      seq++;
+    }
+  }
+
+  out.length = 0;
+  expect(!telemetry.send(0x42, payload, TELEMETRY_MAX_PAYLOAD + 1), "oversized refused",
+         TELEMETRY_MAX_PAYLOAD + 1);
+  out.room = TELEMETRY_MAX_PAYLOAD + 5;
+  expect(!telemetry.send(0x42, payload, TELEMETRY_MAX_PAYLOAD) && out.length == 0 &&
+             telemetry.getDropped() == 1,
+         "dropped whole when the output is full", TELEMETRY_MAX_PAYLOAD);
+  printf("%d byte payloads round trip: %s\n", TELEMETRY_MAX_PAYLOAD, ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
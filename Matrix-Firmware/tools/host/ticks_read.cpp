@@ -0,0 +1,120 @@
+// ticks() and ticks64() without disabling interrupts: runs wiring_ticks.c's
+// read and overflow handler against a model of timer 1 in which every
+// register read is an instruction that moves the clock on by a cycle or
+// three, and an overflow that comes due runs the handler before that read
+// or, at random, right after it. Now and then interrupts stay off for up
+// to 6 ms, as in show() or another ISR, so the overflow waits in TOV1. Of
+// 20M reads each must return the exact count at the moment TCNT1 was
+// read, over the retry and the pending overflow paths alike.
+// sources:
+#include <avr/io.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t cycles;   // since the timer started, 8 to a tick
+static bool pending;      // TOV1
+static bool due;          // pending, the handler runs after this read
+static bool interruptsOn; // the I bit
+static uint64_t sampled;  // true tick count when TCNT1 was last read
+static unsigned long counterReads, pendingReads;
+
+static void TIMER1_OVF(void);
+
+// The clock moves on while interrupts are off, the flag stays set
+static void advance(uint32_t n) {
+  if ((cycles + n) / 8 >> 16 != cycles / 8 >> 16) pending = true;
+  cycles += n;
+}
+
+// One register read; the handler runs at once or, if the overflow just
+// came due, may wait for the read to finish
+static void instruction(void) {
+  advance(1 + rand() % 3);
+  if (!interruptsOn || !pending) return;
+  if (due || rand() % 2) {
+    pending = due = false;
+    TIMER1_OVF();
+  } else {
+    due = true;
+  }
+}
+
+// TCNT1 and TIFR1 as wiring_ticks.c sees them
+static struct {
+  operator unsigned int() {
+    instruction();
+    counterReads++;
+    sampled = cycles / 8;
+    return sampled & 0xFFFF;
+  }
+  void operator=(unsigned int) {}
+} counter;
+
+static struct {
+  operator uint8_t() {
+    instruction();
+    if (pending) pendingReads++;
+    return pending ? _BV(TOV1) : 0;
+  }
+  void operator=(uint8_t flags) {
+    if (flags & _BV(TOV1)) pending = due = false;
+  }
+} flags;
+
+#undef TCNT1
+#undef TIFR1
+#define TCNT1 counter
+#define TIFR1 flags
+#include "../../ArduinoCore/src/core/wiring_ticks.c"
+#undef TCNT1
+#undef TIFR1
+
+static void TIMER1_OVF(void) { TIMER1_OVF_vect(); }
+
+// The program between reads, interrupts on
+static void work(uint32_t n) {
+  for (;;) {
+    if (pending) {
+      pending = due = false;
+      TIMER1_OVF();
+    }
+    if (!n) break;
+    uint32_t step = n < 4096 ? n : 4096;
+    advance(step);
+    n -= step;
+  }
+}
+
+int main() {
+  const long reads = 20000000;
+  long wrong = 0, retried = 0;
+  uint32_t off = 0; // cycles left with interrupts off
+  interruptsOn = true;
+  srand(3);
+  for (long i = 0; i < reads; i++) {
+    if (off) {
+      uint32_t n = 1 + rand() % 2000;
+      n = n < off ? n : off;
+      advance(n);
+      off -= n;
+      if (!off) {
+        interruptsOn = true;
+        work(0);
+      }
+    } else if (!(rand() % 1000)) {
+      interruptsOn = false;
+      off = rand() % 96000;
+    } else {
+      work(rand() % 3000);
+    }
+    unsigned long before = counterReads;
+    uint64_t value = (i & 1) ? ticks64() : ticks();
+    if ((i & 1) ? value != sampled : (uint32_t)value != (uint32_t)sampled) wrong++;
+    if (counterReads - before > 1) retried++;
+  }
+  printf("%ld reads, %ld retried, %lu saw the overflow pending: %ld wrong\n", reads, retried,
+         pendingReads, wrong);
+  bool ok = !wrong && retried && pendingReads;
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
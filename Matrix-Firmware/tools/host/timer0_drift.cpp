@@ -0,0 +1,88 @@
+// millis() drift across show(): runs wiring.c's timer0 overflow handler,
+// millis() and micros() against a cycle by cycle model of timer0, which
+// like the hardware keeps at most one overflow pending while interrupts
+// are off. show() is modelled as its interrupts-off data stream followed by
+// creditTimer0Ticks(), which the AVR show() in Adafruit_NeoPixel.cpp calls.
+// An hour of 33 fps frames with jittered frame work and stream length must
+// leave millis() and micros() within 0.1% of the true time.
+// sources:
+#include <stdio.h>
+#include <stdlib.h>
+
+// wiring.c's versions of these would clash with host.cpp's, and its
+// delayMicroseconds() is AVR assembly that is never called here
+#define millis wiringMillis
+#define micros wiringMicros
+#define delay wiringDelay
+#define delayMicroseconds wiringDelayMicroseconds
+#define init wiringInit
+#define __asm__
+#define __volatile__(...)
+#include "../../ArduinoCore/src/core/wiring.c"
+#undef __asm__
+#undef __volatile__
+
+static uint64_t cycles;
+
+// timer0 ticks every 64 cycles and overflows every 256 ticks
+static void run(uint64_t n) {
+  while (n) {
+    uint64_t toWrap = 16384 - cycles % 16384;
+    uint64_t step = n < toWrap ? n : toWrap;
+    cycles += step;
+    n -= step;
+    TCNT0 = (cycles / 64) & 0xFF;
+    if (step == toWrap) TIFR0 |= _BV(TOV0);
+    if ((SREG & _BV(SREG_I)) && (TIFR0 & _BV(TOV0))) {
+      TIFR0 &= ~_BV(TOV0);
+      TIMER0_OVF_vect();
+    }
+  }
+}
+
+// show() at 800 kHz, 20 cycles a bit, plus the odd cycles between bytes
+static void show(uint16_t numBytes, uint32_t extra, bool credit) {
+  SREG &= ~_BV(SREG_I);
+  uint8_t t0Start = TCNT0;
+  bool t0Pending = (TIFR0 & _BV(TOV0)) && (t0Start < 255);
+  run((uint64_t)numBytes * 8 * 20 + extra);
+  if (credit)
+    creditTimer0Ticks(t0Start, t0Pending, (uint32_t)numBytes * 8 * (F_CPU / 800000UL) / 64);
+  SREG |= _BV(SREG_I);
+  run(0);
+  if (TIFR0 & _BV(TOV0)) {
+    TIFR0 &= ~_BV(TOV0);
+    TIMER0_OVF_vect();
+  }
+}
+
+static bool hour(const char *name, uint16_t numBytes, bool credit) {
+  cycles = 0;
+  TCNT0 = 0;
+  TIFR0 = 0;
+  timer0_millis = timer0_overflow_count = 0;
+  timer0_fract = 0;
+  SREG |= _BV(SREG_I);
+  srand(1);
+  for (long frame = 0; frame < 33L * 3600; frame++) {
+    run(16000UL * 25 + rand() % 20000);         // frame work, interrupts on
+    show(numBytes, 100 + rand() % 4000, credit); // data stream + jitter
+  }
+  double trueMs = cycles / (F_CPU / 1000.0);
+  double millisDrift = 100.0 * (wiringMillis() - trueMs) / trueMs;
+  double microsDrift = 100.0 * (wiringMicros() / 1000.0 - trueMs) / trueMs;
+  printf("%-9s %-24s millis %+8.4f%%, micros %+8.4f%%\n", credit ? "credited" : "stock",
+         name, millisDrift, microsDrift);
+  return fabs(millisDrift) < 0.1 && fabs(microsDrift) < 0.1;
+}
+
+int main() {
+  bool ok = true;
+  hour("176 RGB pixels", 528, false);
+  hour("176 RGBW pixels", 704, false);
+  ok = hour("176 RGB pixels", 528, true) && ok;
+  ok = hour("176 RGBW pixels", 704, true) && ok;
+  ok = hour("60 RGB pixels", 180, true) && ok;
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
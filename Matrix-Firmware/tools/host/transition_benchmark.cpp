@@ -0,0 +1,112 @@
+// Crossfade transitions in WS2812FX: checks that the outgoing mode keeps
+// rendering from its own frames, not from the mix that was shown, and
+// measures the host time per frame with and without a transition running.
+// sources: libraries/WS2812FX/WS2812FX.cpp libraries/WS2812FX/modes.cpp libraries/WS2812FX/modes_2d.cpp libraries/WS2812FX/modes_funcs.cpp libraries/WS2812FX/BeatClock.cpp libraries/adafruit_neopixel/Adafruit_NeoPixel.cpp core/NeoArena.cpp libraries/adafruit_neomatrix/Adafruit_NeoMatrix.cpp libraries/adafruit_gfx_library/Adafruit_GFX.cpp core/Print.cpp core/WString.cpp core/WMath.cpp
+#include <WS2812FX.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MATRIX_TYPE (NEO_MATRIX_TOP + NEO_MATRIX_LEFT + NEO_MATRIX_COLUMNS + NEO_MATRIX_ZIGZAG)
+
+// The comet fades its previous frame, so it drifts off as soon as it reads
+// back anything but its own output. Fading it into a static color must show
+// the reference comet and that color mixed by a single amount.
+static bool outgoingFrameIntact() {
+  uint8_t shown[176 * 3], comet[176 * 3];
+  WS2812FX fx(16, 11, 8, MATRIX_TYPE), ref(16, 11, 8, MATRIX_TYPE), still(16, 11, 8, MATRIX_TYPE);
+  fx.init();
+  ref.init();
+  still.init();
+  fx.setSegment(0, 0, 175, FX_MODE_COMET, RED, 1000, NO_OPTIONS);
+  ref.setSegment(0, 0, 175, FX_MODE_COMET, RED, 1000, NO_OPTIONS);
+  still.setSegment(0, 0, 175, FX_MODE_STATIC, RED, 1000, NO_OPTIONS);
+  fx.start();
+  ref.start();
+  still.start();
+  fx.setTransitionTime(20000);
+
+  for (int frame = 0; frame < 400; frame++) {
+    if (frame == 40) fx.setMode(0, FX_MODE_STATIC);
+    fx.trigger();
+    ref.trigger();
+    still.trigger();
+    fx.service();
+    memcpy(shown, hostShowData, sizeof(shown));
+    ref.service();
+    memcpy(comet, hostShowData, sizeof(comet));
+    still.service();
+    const uint8_t *color = hostShowData;
+
+    // the same mix as WS2812FX::blend()
+    int amt;
+    for (amt = 0; amt < 256; amt++) {
+      uint16_t inv = 256 - amt;
+      int i = 0;
+      while (i < (int)sizeof(shown)) {
+        uint8_t mix = amt == 0 ? comet[i] : amt == 255 ? color[i] :
+          (comet[i] * inv + (uint16_t)color[i] * amt) >> 8;
+        if (shown[i] != mix) break;
+        i++;
+      }
+      if (i == (int)sizeof(shown)) break;
+    }
+    if (amt == 256) {
+      printf("frame %d: the outgoing comet no longer matches the reference\n", frame);
+      return false;
+    }
+    hostAdvance(10000);
+  }
+  return fx.isTransitioning();
+}
+
+// host ns per service() call that renders and shows a frame
+static double frameTime(WS2812FX &fx, int frames) {
+  uint64_t start = hostNanos();
+  for (int i = 0; i < frames; i++) {
+    fx.trigger();
+    fx.service();
+  }
+  return (double)(hostNanos() - start) / frames;
+}
+
+static double steadyTime(int w, int h, uint8_t mode, int frames) {
+  WS2812FX fx(w, h, 8, MATRIX_TYPE);
+  fx.init();
+  fx.setSegment(0, 0, w * h - 1, mode, BLUE, 1000, NO_OPTIONS);
+  fx.start();
+  return frameTime(fx, frames);
+}
+
+// the crossfade overhead is what a fading frame costs on top of rendering
+// both modes
+static void benchmark(int w, int h, uint8_t from, uint8_t to) {
+  const int frames = 2000;
+  double fromTime = steadyTime(w, h, from, frames);
+  double toTime = steadyTime(w, h, to, frames);
+
+  WS2812FX fx(w, h, 8, MATRIX_TYPE);
+  fx.init();
+  fx.setSegment(0, 0, w * h - 1, from, BLUE, 1000, NO_OPTIONS);
+  fx.start();
+  frameTime(fx, frames);
+  // long enough to stay in the transition for the whole measurement
+  fx.setTransitionTime(60000);
+  fx.setMode(0, to);
+  double fading = frameTime(fx, frames);
+  if (!fx.isTransitioning()) printf("transition ended early\n");
+
+  printf("%dx%d %-14s %6.0f ns, %-10s %6.0f ns, fading %6.0f ns/frame (crossfade %5.0f ns)\n",
+         w, h, (const char *)fx.getModeName(from), fromTime,
+         (const char *)fx.getModeName(to), toTime, fading, fading - fromTime - toTime);
+}
+
+int main() {
+  bool ok = outgoingFrameIntact();
+  printf("outgoing frame intact: %s\n", ok ? "ok" : "FAIL");
+
+  benchmark(16, 11, FX_MODE_RAINBOW_CYCLE, FX_MODE_COMET);
+  benchmark(16, 11, FX_MODE_PLASMA, FX_MODE_FIRE_2D);
+  benchmark(16, 16, FX_MODE_RAINBOW_CYCLE, FX_MODE_COMET);
+  benchmark(16, 16, FX_MODE_PLASMA, FX_MODE_FIRE_2D);
+  return ok ? 0 : 1;
+}
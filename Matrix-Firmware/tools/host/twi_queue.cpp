@@ -0,0 +1,278 @@
+// Queued TWI transactions against a model of the TWI peripheral with one
+// I2C device on the bus, a 256 byte register file at address 0x50 whose
+// first written byte sets the register pointer. The model carries out the
+// bus step a TWCR write asks for whenever the host clock moves, sets TWSR
+// and runs the TWI interrupt like the hardware would. Covers write then
+// read, back to back transactions, address NACKs, probes, chaining from
+// onComplete, blocking calls mixed in (a held repeated start included),
+// recovery from a stuck bus, and the Adafruit_I2CDevice queue() facade.
+// sources: core/Print.cpp core/Stream.cpp core/WString.cpp core/FixedString.cpp libraries/Wire/Wire.cpp libraries/adafruit_busio/Adafruit_I2CDevice.cpp
+#include <Adafruit_I2CDevice.h>
+#include <stdio.h>
+
+// twi.c is C, and Wire.cpp expects it that way; declared C first, its
+// definitions keep C linkage when it is built as C++ here
+extern "C" {
+#include <utility/twi.h>
+}
+#include "../../ArduinoCore/src/libraries/Wire/utility/twi.c"
+
+#define DEVICE 0x50
+
+// The peripheral and the device
+static struct {
+  enum { IDLE, ADDRESS, WRITE, READ } phase;
+  bool owned;   // a start went out and no stop yet
+  bool stuck;   // the device holds SCL low, nothing moves
+  bool paused;  // the bus doesn't move until the harness says so
+  bool running; // in bus(), which the interrupt may call back into
+  uint8_t reg[256];
+  uint8_t pointer;
+  bool pointerSet;
+  int starts, repeatedStarts, stops;
+} twi;
+
+static void stop(void) {
+  twi.phase = twi.IDLE;
+  twi.owned = false;
+  twi.stops++;
+  TWCR &= ~(_BV(TWSTO) | _BV(TWINT));
+}
+
+// Called as the clock moves: carries out what TWCR asks for. A TWINT
+// written as 1 starts the next step; the model clears it while the step
+// is done and runs the interrupt after it, if enabled
+static void bus(void) {
+  // the stop goes out even while twi_stop() waits for it in the interrupt
+  if (TWCR & _BV(TWSTO)) stop();
+  if (twi.running || twi.paused) return;
+  twi.running = true;
+  for (;;) {
+    uint8_t control = TWCR;
+    if (control & _BV(TWSTO)) {
+      stop();
+      continue;
+    }
+    if (!(control & _BV(TWINT)) || !(control & _BV(TWEN)) || twi.stuck) break;
+    uint8_t status;
+    if (control & _BV(TWSTA)) {
+      status = twi.owned ? TW_REP_START : TW_START;
+      (twi.owned ? twi.repeatedStarts : twi.starts)++;
+      twi.owned = true;
+      twi.phase = twi.ADDRESS;
+    } else if (twi.phase == twi.ADDRESS) {
+      bool read = TWDR & TW_READ;
+      if ((TWDR >> 1) == DEVICE) {
+        status = read ? TW_MR_SLA_ACK : TW_MT_SLA_ACK;
+        twi.phase = read ? twi.READ : twi.WRITE;
+        twi.pointerSet = false;
+      } else {
+        status = read ? TW_MR_SLA_NACK : TW_MT_SLA_NACK;
+      }
+    } else if (twi.phase == twi.WRITE) {
+      if (twi.pointerSet) {
+        twi.reg[twi.pointer++] = TWDR;
+      } else {
+        twi.pointer = TWDR;
+        twi.pointerSet = true;
+      }
+      status = TW_MT_DATA_ACK;
+    } else if (twi.phase == twi.READ) {
+      TWDR = twi.reg[twi.pointer++];
+      status = (control & _BV(TWEA)) ? TW_MR_DATA_ACK : TW_MR_DATA_NACK;
+    } else {
+      break;
+    }
+    TWSR = status;
+    TWCR = control & ~(_BV(TWINT) | _BV(TWSTA));
+    if (control & _BV(TWIE)) TWI_vect();
+  }
+  twi.running = false;
+}
+
+// Lets the bus run until it has nothing left to do
+static void settle(void) { hostAdvance(100); }
+
+static bool ok = true;
+
+static void expect(bool pass, const char *what) {
+  if (!pass) {
+    printf("FAIL: %s\n", what);
+    ok = false;
+  }
+}
+
+static bool registersFrom(const uint8_t *data, uint8_t first, int n) {
+  for (int i = 0; i < n; i++)
+    if (data[i] != twi.reg[(uint8_t)(first + i)]) return false;
+  return true;
+}
+
+static int completions;
+static twi_transaction_t *lastCompleted;
+
+static void completed(twi_transaction_t *t) {
+  completions++;
+  lastCompleted = t;
+}
+
+// onComplete that queues a register read right away, from the interrupt
+static twi_transaction_t chained;
+static uint8_t chainedRegister = 0x10, chainedData[3];
+
+static void queueNext(twi_transaction_t *t) {
+  (void)t;
+  completions++;
+  chained = twi_transaction_t();
+  chained.address = DEVICE;
+  chained.txData = &chainedRegister;
+  chained.txLength = 1;
+  chained.rxData = chainedData;
+  chained.rxLength = 3;
+  chained.onComplete = completed;
+  expect(twi_queue(&chained) == 0, "queue from onComplete");
+}
+
+static int deviceCalls;
+static void *deviceContext;
+
+static void deviceDone(Adafruit_I2CTransaction *t) {
+  deviceCalls++;
+  deviceContext = t->context;
+}
+
+int main() {
+  hostIdle = bus;
+  twi_init();
+  twi_setTimeoutInMicros(1000, false);
+  for (int i = 0; i < 256; i++) twi.reg[i] = i ^ 0xA5;
+
+  // a register read in one transaction: write the pointer, then read 40
+  // bytes after a repeated start, more than the blocking calls can
+  static twi_transaction_t t;
+  uint8_t pointer = 0x20, in[40];
+  t.address = DEVICE;
+  t.txData = &pointer;
+  t.txLength = 1;
+  t.rxData = in;
+  t.rxLength = 40;
+  t.onComplete = completed;
+  expect(twi_queue(&t) == 0 && t.status == TWI_PENDING, "queue returns at once");
+  expect(twi_queue(&t) == 1, "queueing it again is refused");
+  settle();
+  expect(t.status == 0 && completions == 1 && lastCompleted == &t, "write then read completes");
+  expect(registersFrom(in, 0x20, 40), "write then read data");
+  expect(twi.starts == 1 && twi.repeatedStarts == 1 && twi.stops == 1, "start, repeated start, stop");
+
+  // two queued before the bus moves, write only then read only
+  static twi_transaction_t w, r;
+  uint8_t out[] = {0x80, 1, 2, 3};
+  w.address = r.address = DEVICE;
+  w.txData = out;
+  w.txLength = 4;
+  r.rxData = in;
+  r.rxLength = 2;
+  twi.paused = true;
+  twi_queue(&w);
+  twi_queue(&r);
+  twi.paused = false;
+  expect(w.status == TWI_PENDING && r.status == TWI_PENDING, "both wait for the bus");
+  settle();
+  expect(w.status == 0 && r.status == 0, "back to back complete");
+  expect(twi.reg[0x80] == 1 && twi.reg[0x82] == 3, "write only data");
+  expect(registersFrom(in, 0x83, 2), "read only data");
+
+  // no device at 0x51
+  static twi_transaction_t nackWrite, nackRead;
+  nackWrite.address = nackRead.address = DEVICE + 1;
+  nackWrite.txData = out;
+  nackWrite.txLength = 2;
+  nackRead.rxData = in;
+  nackRead.rxLength = 2;
+  twi_queue(&nackWrite);
+  settle();
+  twi_queue(&nackRead);
+  settle();
+  expect(nackWrite.status == 2 && nackRead.status == 2, "address NACK");
+
+  // nothing to write or read only checks the ack
+  static twi_transaction_t probe;
+  probe.address = DEVICE;
+  twi_queue(&probe);
+  settle();
+  expect(probe.status == 0, "probe");
+
+  static twi_transaction_t first;
+  first.address = DEVICE;
+  first.txData = out;
+  first.txLength = 2;
+  first.onComplete = queueNext;
+  completions = 0;
+  twi_queue(&first);
+  settle();
+  expect(first.status == 0 && chained.status == 0 && completions == 2, "chained from onComplete");
+  expect(registersFrom(chainedData, 0x10, 3), "chained data");
+
+  // the blocking calls still work, and a queued transaction waits while
+  // one holds the bus for a repeated start
+  uint8_t data[3] = {0x90, 7, 8};
+  expect(twi_writeTo(DEVICE, data, 3, 1, 1) == 0 && twi.reg[0x90] == 7 && twi.reg[0x91] == 8,
+         "blocking write");
+  expect(twi_writeTo(DEVICE + 1, data, 3, 1, 1) == 2, "blocking write NACK");
+  uint8_t reg90 = 0x90;
+  twi_writeTo(DEVICE, &reg90, 1, 1, 0);
+  static twi_transaction_t waiting;
+  waiting.address = DEVICE;
+  waiting.txData = data;
+  waiting.txLength = 2;
+  twi_queue(&waiting);
+  settle();
+  expect(waiting.status == TWI_PENDING, "queued waits for a held bus");
+  uint8_t back[2];
+  expect(twi_readFrom(DEVICE, back, 2, 1) == 2 && back[0] == 7 && back[1] == 8,
+         "blocking read after a repeated start");
+  settle();
+  expect(waiting.status == 0, "queued runs after the blocking read");
+
+  // a stuck transaction times out on twi_pollQueue(), which resets the
+  // interface, and the next one runs
+  static twi_transaction_t stuck, next;
+  stuck.address = next.address = DEVICE;
+  stuck.txData = out;
+  stuck.txLength = 2;
+  next.rxData = in;
+  next.rxLength = 1;
+  twi.stuck = true;
+  twi_queue(&stuck);
+  twi_queue(&next);
+  twi_pollQueue();
+  expect(stuck.status == TWI_PENDING, "no timeout too early");
+  hostAdvance(5000);
+  twi_pollQueue();
+  expect(stuck.status == 5 && next.status == TWI_PENDING, "stuck transaction times out");
+  twi.stuck = false;
+  twi.phase = twi.IDLE;
+  twi.owned = false;
+  twi.pointer = 0x42;
+  settle();
+  expect(next.status == 0 && in[0] == twi.reg[0x42], "next runs after the reset");
+  expect(twi_manageTimeoutFlag(true), "timeout flagged");
+
+  // the Adafruit_I2CDevice facade
+  Adafruit_I2CDevice device(DEVICE);
+  static Adafruit_I2CTransaction transfer;
+  uint8_t reg05 = 0x05, three[3];
+  int tag;
+  expect(device.queue(&transfer, &reg05, 1, three, 3, deviceDone, &tag), "device queue");
+  expect(Adafruit_I2CDevice::busy(&transfer), "device transfer busy");
+  expect(!device.queue(&transfer, &reg05, 1, three, 3), "device queue refuses a busy one");
+  settle();
+  expect(!Adafruit_I2CDevice::busy(&transfer) && Adafruit_I2CDevice::succeeded(&transfer),
+         "device transfer succeeded");
+  expect(deviceCalls == 1 && deviceContext == &tag && registersFrom(three, 0x05, 3),
+         "device callback and data");
+  expect(!device.queue(&transfer, &reg05, 300), "device queue refuses 300 bytes");
+
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Decode the matrix firmware's binary telemetry.
+
+The firmware sends COBS encoded packets (see Telemetry.h), framed by 0
+bytes: type, sequence number, payload and a CRC-8 (poly 0x07). The frame
+receiver's "Ada\n" greeting and its 0xAC ACKs share the port; they land
+between packets and are skipped.
+Status reports are logged as CSV, to stdout or a file, and can be
+plotted live. Memory reports (heap, stack and NeoArena high-water marks)
+go to stderr, or to a CSV file of their own.
+
+    telemetry.py /dev/ttyUSB0 [--baud 1000000] [--csv log.csv] [--plot]
+                 [--memory memory.csv]
+
+Needs pyserial, and matplotlib for --plot.
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+TELEMETRY_STATUS = 1
+TELEMETRY_MEMORY = 2
+ACK = 0xAC  # NEO_RX_ACK in NeoPixelReceiver.h
+
+# statusReport_t in Sketch.cpp
+STATUS = struct.Struct('<HhhhhhHBHHH')
+STATUS_FIELDS = ('sample', 'avgAnalog', 'triggerLow', 'triggerHigh',
+                 'avgMin', 'avgMax', 'bpm', 'confidence', 'framePixels',
+                 'showMicros', 'triggerLatencyMicros')
+LEVELS_Q4 = ('avgAnalog', 'triggerLow', 'triggerHigh', 'avgMin', 'avgMax')
+
+# memoryReport_t in Sketch.cpp
+MEMORY = struct.Struct('<9H')
+MEMORY_FIELDS = ('heapUsed', 'heapPeak', 'stackPeak', 'untouched', 'allocs',
+                 'frees', 'failed', 'arenaSize', 'arenaPeak')
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07 if crc & 0x80 else crc << 1) & 0xFF
+    return crc
+
+
+class Decoder:
+    """Splits a byte stream into packets and checks them."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.seq = None
+        self.packets = 0
+        self.bad = 0
+        self.lost = 0
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame.replace(b'Ada\n', b'').strip(bytes([ACK])):
+                packet = self.check(frame)
+                if packet:
+                    yield packet
+
+    def check(self, frame):
+        raw = cobs_decode(frame)
+        if raw is None or len(raw) < 3 or crc8(raw[:-1]) != raw[-1]:
+            self.bad += 1
+            return None
+        ptype, seq, payload = raw[0], raw[1], raw[2:-1]
+        if self.seq is not None:
+            self.lost += (seq - self.seq - 1) & 0xFF
+        self.seq = seq
+        self.packets += 1
+        return ptype, seq, payload
+
+
+def parse_status(payload):
+    if len(payload) != STATUS.size:
+        return None
+    report = dict(zip(STATUS_FIELDS, STATUS.unpack(payload)))
+    for name in LEVELS_Q4:
+        report[name] /= 16.0
+    return report
+
+
+def parse_memory(payload):
+    if len(payload) != MEMORY.size:
+        return None
+    return dict(zip(MEMORY_FIELDS, MEMORY.unpack(payload)))
+
+
+def format_memory(report):
+    return ('heap %(heapUsed)d B (peak %(heapPeak)d), stack peak '
+            '%(stackPeak)d B, %(untouched)d B never used, arena '
+            '%(arenaPeak)d/%(arenaSize)d B, %(allocs)d allocs, '
+            '%(frees)d frees, %(failed)d failed' % report)
+
+
+class Plot:
+    """Scrolling plot of the analog levels and the frame timing."""
+
+    def __init__(self, length=300):
+        import matplotlib.pyplot as plt
+        self.plt = plt
+        self.history = collections.defaultdict(
+            lambda: collections.deque(maxlen=length))
+        self.fig, (self.levels, self.timing) = plt.subplots(2, 1, sharex=True)
+        self.lines = {}
+        for name in ('sample',) + LEVELS_Q4:
+            self.lines[name], = self.levels.plot([], [], label=name)
+        for name in ('showMicros', 'triggerLatencyMicros'):
+            self.lines[name], = self.timing.plot([], [], label=name)
+        self.levels.set_ylabel('ADC')
+        self.timing.set_ylabel('us')
+        self.levels.legend(loc='upper left', fontsize='small')
+        self.timing.legend(loc='upper left', fontsize='small')
+        plt.ion()
+        plt.show()
+
+    def add(self, n, report):
+        self.history['n'].append(n)
+        for name in self.lines:
+            self.history[name].append(report[name])
+
+    def draw(self):
+        for name, line in self.lines.items():
+            line.set_data(self.history['n'], self.history[name])
+        for ax in (self.levels, self.timing):
+            ax.relim()
+            ax.autoscale_view()
+        self.plt.pause(0.001)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('port', help='serial port, or - to read stdin')
+    parser.add_argument('--baud', type=int, default=1000000)
+    parser.add_argument('--csv', help='write the reports to this file')
+    parser.add_argument('--plot', action='store_true',
+                        help='plot the reports as they arrive')
+    parser.add_argument('--memory',
+                        help='write the memory reports to this file')
+    args = parser.parse_args()
+
+    if args.port == '-':
+        source = sys.stdin.buffer
+        read = lambda: source.read1(256)
+    else:
+        import serial
+        source = serial.Serial(args.port, args.baud, timeout=0.1)
+        read = lambda: source.read(max(1, source.in_waiting))
+    out = open(args.csv, 'w') if args.csv else sys.stdout
+    memory = open(args.memory, 'w') if args.memory else None
+    plot = Plot() if args.plot else None
+
+    decoder = Decoder()
+    out.write(','.join(('seq',) + STATUS_FIELDS) + '\n')
+    if memory:
+        memory.write(','.join(('seq',) + MEMORY_FIELDS) + '\n')
+    try:
+        while True:
+            data = read()
+            if not data and args.port == '-':
+                break
+            for ptype, seq, payload in decoder.feed(data):
+                if ptype == TELEMETRY_MEMORY:
+                    report = parse_memory(payload)
+                    if report is None:
+                        continue
+                    if memory:
+                        memory.write(','.join([str(seq)] + [
+                            str(report[name]) for name in MEMORY_FIELDS]) +
+                            '\n')
+                        memory.flush()
+                    else:
+                        sys.stderr.write(format_memory(report) + '\n')
+                    continue
+                report = parse_status(payload) \
+                    if ptype == TELEMETRY_STATUS else None
+                if report is None:
+                    continue
+                out.write(','.join([str(seq)] + [
+                    str(report[name]) for name in STATUS_FIELDS]) + '\n')
+                if plot:
+                    plot.add(decoder.packets, report)
+            if plot and data:
+                plot.draw()
+            out.flush()
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write('%d packets, %d lost, %d bad\n' %
+                     (decoder.packets, decoder.lost, decoder.bad))
+
+
+if __name__ == '__main__':
+    main()